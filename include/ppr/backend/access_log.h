@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "ppr/backend/spsc_ring.h"
+
+namespace ppr::backend {
+
+// OFF ("off"): nothing, ERRORS ("error"): responses with status >= 400,
+// ALL ("info"): all responses (sampled, errors are always logged),
+// VERBOSE ("debug"): ALL + Server-Timing header
+enum class log_level : std::uint8_t { OFF, ERRORS, ALL, VERBOSE };
+
+// throws std::invalid_argument for unknown names
+log_level parse_log_level(std::string_view name);
+
+struct access_log_entry {
+  std::chrono::steady_clock::time_point received_{};
+  std::int64_t timestamp_{};  // unix time in ms
+  std::string method_;
+  std::string target_;
+  unsigned status_{};
+  std::uint64_t response_size_{};  // body bytes
+  double d_total_{};  // ms from request receipt to response
+  double d_queue_{};  // ms waiting for the routing thread pool
+
+  // route requests only
+  bool route_{false};
+  bool cached_{false};
+  double d_routing_{};
+  double d_encoding_{};
+  std::uint64_t labels_created_{};
+  std::uint64_t labels_popped_{};
+
+  std::string server_timing_;  // VERBOSE only
+};
+
+// Access log writing one JSON object per line. Entries are passed to a
+// background writer thread through a lock-free ring buffer, the request
+// thread never blocks on I/O. Entries are dropped if the ring is full.
+struct access_log {
+  // path: file to append to, "-" = stdout
+  access_log(std::string const& path, log_level level, double sample_rate,
+             std::size_t capacity = 8192);
+  ~access_log();
+  access_log(access_log const&) = delete;
+  access_log& operator=(access_log const&) = delete;
+  access_log(access_log&&) = delete;
+  access_log& operator=(access_log&&) = delete;
+
+  log_level level() const { return level_; }
+  bool enabled() const { return level_ != log_level::OFF; }
+
+  // must only be called from a single thread (the io thread)
+  void log(access_log_entry&& e);
+
+  std::uint64_t dropped() const { return dropped_; }
+
+private:
+  bool should_log(unsigned status);
+  void run();
+  void write(access_log_entry const& e);
+
+  log_level level_;
+  double sample_rate_;
+  std::minstd_rand rng_;
+  std::uniform_real_distribution<double> sample_dist_{0.0, 1.0};
+
+  spsc_ring<access_log_entry> ring_;
+  std::atomic<std::uint64_t> dropped_{};
+
+  std::ofstream file_;
+  std::ostream* out_;
+  std::atomic_bool stop_{false};
+  std::thread writer_;
+};
+
+}  // namespace ppr::backend
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ankerl/unordered_dense.h"
+
+#include "ppr/common/location.h"
+#include "ppr/common/packed_rtree.h"
+#include "ppr/common/routing_graph.h"
+
+namespace ppr::backend {
+
+// Approximate area covered by a routing graph: all grid cells containing
+// nodes, grown by one cell so that locations near the border that still
+// snap to the graph are inside.
+struct graph_coverage {
+  static constexpr auto const CELL_SIZE = location::PRECISION / 10;  // 0.1°
+
+  static std::uint64_t cell(location const& loc);
+
+  void add(location const& loc);
+
+  // adds all neighbors of the current cells, call once after add()
+  void grow();
+
+  bool contains(location const& loc) const;
+
+  // number of cells
+  std::size_t size() const { return cells_.size(); }
+
+  packed_rtree_box box_;
+  ankerl::unordered_dense::set<std::uint64_t> cells_;
+};
+
+graph_coverage get_graph_coverage(routing_graph const& rg);
+
+}  // namespace ppr::backend
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ppr/backend/graph_store.h"
+#include "ppr/common/location.h"
+
+namespace ppr::backend {
+
+// "name=file" or "file" (name = file name without extension)
+graph_options parse_graph_arg(std::string const& arg);
+
+// All graphs served by one backend. Requests are dispatched to the graph
+// whose coverage contains all of their locations.
+struct graph_registry {
+  graph_store& add(std::unique_ptr<graph_store> store);
+
+  std::vector<std::unique_ptr<graph_store>> const& graphs() const {
+    return graphs_;
+  }
+
+  graph_store* get(std::string_view name) const;
+
+  // Returns the graph covering all locations, the one with the smallest
+  // coverage if several do (e.g. a city graph inside a country graph).
+  // With only one graph, it is always returned (the routing reports
+  // unmatched locations). nullptr if no graph covers all locations.
+  graph_store* find(std::vector<location> const& locations) const;
+
+private:
+  std::vector<std::unique_ptr<graph_store>> graphs_;
+};
+
+}  // namespace ppr::backend
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ppr/backend/graph_coverage.h"
+#include "ppr/common/routing_graph.h"
+#include "ppr/common/snapping_cache.h"
+
+namespace ppr::backend {
+
+struct graph_options {
+  std::string name_;
+  std::string graph_file_;
+  rtree_options rtree_opt_{rtree_options::DEFAULT};
+  bool snapping_cache_{false};
+  snapping_cache_config snapping_cache_config_;
+  bool verify_{true};
+  bool coverage_{false};  // required for dispatching by location
+};
+
+// Reads the graph file and prepares the graph for routing.
+// Throws std::runtime_error if the graph can't be loaded or is invalid.
+std::shared_ptr<routing_graph const> load_graph(graph_options const& opt,
+                                                std::ostream& out);
+
+// Holds the current routing graph. Requests keep the graph they started with
+// alive through the handle returned by get(). A reload loads and prepares
+// the new graph in the background and then swaps it in, the old graph (and
+// its mmap) is released once the last request using it has finished.
+//
+// New graph files should be moved into place (not overwritten), because the
+// old graph is still memory mapped while requests drain.
+struct graph_store {
+  // loads the initial graph (throws on errors)
+  explicit graph_store(graph_options opt, std::ostream& out);
+  // starts with an already prepared graph, reloads use opt.graph_file_
+  graph_store(graph_options opt, std::shared_ptr<routing_graph const> graph,
+              std::ostream& out);
+  ~graph_store();
+
+  graph_store(graph_store const&) = delete;
+  graph_store& operator=(graph_store const&) = delete;
+  graph_store(graph_store&&) = delete;
+  graph_store& operator=(graph_store&&) = delete;
+
+  std::shared_ptr<routing_graph const> get() const;
+
+  struct snapshot {
+    std::shared_ptr<routing_graph const> graph_;
+    std::uint64_t version_{};
+    std::shared_ptr<graph_coverage const> coverage_;
+  };
+
+  // current graph with its version and coverage (read together)
+  snapshot get_snapshot() const;
+
+  // coverage of the current graph (only if opt.coverage_ is set)
+  std::shared_ptr<graph_coverage const> coverage() const;
+
+  graph_options const& options() const { return opt_; }
+  std::string const& name() const { return opt_.name_; }
+
+  // size of the graph file the current graph was loaded from (mapped)
+  std::uintmax_t file_size() const;
+
+  // incremented every time a new graph is swapped in
+  std::uint64_t version() const { return version_; }
+
+  bool reloading() const { return reloading_; }
+
+  // starts a background reload of the graph file,
+  // returns false if a reload is already running
+  bool reload();
+
+  // polls the graph file and reloads it after it has been replaced
+  // (changed and then unchanged for one interval)
+  void watch(std::chrono::seconds interval);
+
+private:
+  struct file_state {
+    friend bool operator==(file_state const&, file_state const&) = default;
+
+    std::int64_t modified_{};
+    std::uintmax_t size_{};
+  };
+
+  file_state get_file_state() const;
+  void set_graph(std::shared_ptr<routing_graph const> graph,
+                 file_state const& file);
+  void run_reload();
+  void run_watch(std::chrono::seconds interval);
+
+  graph_options opt_;
+  std::ostream& out_;
+
+  mutable std::mutex graph_mutex_;
+  std::shared_ptr<routing_graph const> graph_;
+  std::shared_ptr<graph_coverage const> coverage_;
+  std::atomic<std::uint64_t> version_{0};
+
+  std::mutex reload_mutex_;
+  std::atomic_bool reloading_{false};
+  std::thread reload_thread_;
+  file_state loaded_file_;
+
+  std::mutex watch_mutex_;
+  std::condition_variable watch_cv_;
+  bool stop_{false};
+  std::thread watch_thread_;
+};
+
+}  // namespace ppr::backend
@@ -6,15 +6,16 @@
 #include "boost/asio/io_context.hpp"
 #include "boost/asio/ssl/context.hpp"
 
-#include "ppr/common/routing_graph.h"
+#include "ppr/backend/graph_registry.h"
+#include "ppr/backend/server_settings.h"
 
 namespace ppr::backend {
 
 struct http_server {
   http_server(boost::asio::io_context& ioc,
               boost::asio::io_context& thread_pool,
-              boost::asio::ssl::context& ssl_ctx, routing_graph const& rg,
-              std::string const& static_file_path);
+              boost::asio::ssl::context& ssl_ctx, graph_registry& graphs,
+              server_settings const& settings);
   ~http_server();
   http_server(http_server const&) = delete;
   http_server& operator=(http_server const&) = delete;
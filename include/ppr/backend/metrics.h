@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <string>
+#include <string_view>
+
+#include "ppr/routing/statistics.h"
+
+namespace ppr::backend {
+
+constexpr auto const METRIC_SHARDS = std::size_t{16};
+
+// shard used by the calling thread (assigned round-robin on first use)
+std::size_t metric_shard();
+
+// Monotonic counter. Every thread adds to its own cache line, reads sum up
+// all shards.
+struct sharded_counter {
+  void add(std::uint64_t n = 1);
+  std::uint64_t read() const;
+
+private:
+  struct alignas(64) shard {
+    std::atomic<std::uint64_t> value_{};
+  };
+  std::array<shard, METRIC_SHARDS> shards_{};
+};
+
+// Histogram of durations in ms with fixed buckets, sharded like
+// sharded_counter. Reads are not atomic across buckets, which is fine
+// for scraping.
+struct latency_histogram {
+  // upper bounds in ms, the last (+Inf) bucket is implicit
+  static constexpr auto const BOUNDS = std::array<double, 14>{
+      0.5, 1, 2.5, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000};
+
+  struct snapshot {
+    std::array<std::uint64_t, BOUNDS.size() + 1> buckets_{};  // per bucket
+    std::uint64_t count_{};
+    double sum_{};  // ms
+  };
+
+  void observe(double ms);
+  snapshot read() const;
+
+private:
+  struct alignas(64) shard {
+    std::array<std::atomic<std::uint64_t>, BOUNDS.size() + 1> buckets_{};
+    std::atomic<std::uint64_t> sum_us_{};
+  };
+  std::array<shard, METRIC_SHARDS> shards_{};
+};
+
+// Prometheus text exposition format (version 0.0.4).
+struct prometheus_writer {
+  static constexpr auto const CONTENT_TYPE = "text/plain; version=0.0.4";
+
+  // HELP and TYPE lines, once per metric family before its samples
+  void family(std::string_view name, std::string_view type,
+              std::string_view help);
+
+  // labels: comma separated, e.g. label("graph", name)
+  void sample(std::string_view name, std::string_view labels, double value);
+  void sample(std::string_view name, std::string_view labels,
+              std::uint64_t value);
+
+  // buckets, sum and count in seconds
+  void histogram(std::string_view name, std::string_view labels,
+                 latency_histogram::snapshot const& h);
+
+  std::string const& str() const { return out_; }
+
+  static std::string label(std::string_view key, std::string_view value);
+
+private:
+  void write_name(std::string_view name, std::string_view labels);
+
+  std::string out_;
+};
+
+enum class route_phase : std::uint8_t {
+  START_PTS,
+  DESTINATION_PTS,
+  DIJKSTRA_STARTS,
+  DIJKSTRA_GOALS,
+  AREA_EDGES,
+  SEARCH,
+  LABELS_TO_ROUTE,
+  POSTPROCESSING,
+  ENCODING,
+  TOTAL,
+  NUM_PHASES
+};
+
+// Aggregated routing statistics of all computed routes.
+struct route_metrics {
+  void record(routing::routing_statistics const& stats, double d_encoding);
+  void write(prometheus_writer& w) const;
+
+private:
+  latency_histogram& phase(route_phase const p) {
+    return phases_[static_cast<std::size_t>(p)];
+  }
+
+  std::array<latency_histogram,
+             static_cast<std::size_t>(route_phase::NUM_PHASES)>
+      phases_;
+  sharded_counter routes_;
+  sharded_counter labels_created_;
+  sharded_counter labels_popped_;
+  sharded_counter max_label_quits_;
+  sharded_counter attempts_;
+  sharded_counter pts_extended_;
+  sharded_counter goals_unreached_;
+};
+
+}  // namespace ppr::backend
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -7,9 +8,9 @@
 
 namespace ppr::backend::output {
 
-std::string to_graph_response(
-    std::vector<routing_graph::edge_rtree_value_type> const&,
-    std::vector<routing_graph::area_rtree_value_type> const&,
-    routing_graph const&, bool include_visibility_graphs);
+std::string to_graph_response(std::vector<rg_edge> const&,
+                              std::vector<std::uint32_t> const&,
+                              routing_graph const&,
+                              bool include_visibility_graphs, bool pretty);
 
 }  // namespace ppr::backend::output
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/writer.h"
+
+namespace ppr::backend::output {
+
+// rapidjson output stream that appends to a std::string, so the result can
+// be moved into the response body without copying it out of a buffer.
+struct string_output_stream {
+  using Ch = char;
+
+  explicit string_output_stream(std::string& out) : out_{out} {}
+
+  void Put(Ch const c) { out_.push_back(c); }
+  void Flush() {}
+
+  std::string& out_;
+};
+
+// Calls fn(writer) with a compact (or indented) rapidjson writer and returns
+// the output. size_hint is reserved up front.
+template <typename Fn>
+std::string write_json(bool const pretty, std::size_t const size_hint,
+                       Fn&& fn) {
+  auto out = std::string{};
+  out.reserve(size_hint);
+  auto os = string_output_stream{out};
+  if (pretty) {
+    auto writer = rapidjson::PrettyWriter<string_output_stream>{os};
+    fn(writer);
+  } else {
+    auto writer = rapidjson::Writer<string_output_stream>{os};
+    fn(writer);
+  }
+  return out;
+}
+
+}  // namespace ppr::backend::output
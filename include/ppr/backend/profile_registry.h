@@ -0,0 +1,53 @@
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ankerl/unordered_dense.h"
+
+#include "rapidjson/document.h"
+
+#include "ppr/routing/search_profile.h"
+
+namespace ppr::backend {
+
+// Profiles are parsed once and shared by all requests using them:
+// - named profiles are loaded at startup and referenced by name
+//   ("profile": "wheelchair")
+// - ad-hoc profiles sent with requests are cached by their JSON content
+struct profile_registry {
+  using profile_ptr = std::shared_ptr<routing::search_profile const>;
+
+  static constexpr auto const MAX_CACHED_PROFILES = 1024U;
+
+  profile_registry();
+
+  // loads all *.json files in the directory (name = file name without
+  // extension), returns the number of loaded profiles
+  std::size_t load_directory(std::string const& path, std::ostream& out);
+
+  void add(std::string const& name, routing::search_profile const& profile);
+
+  // nullptr if unknown
+  profile_ptr get(std::string_view name) const;
+
+  // parses the profile json or returns the cached profile
+  profile_ptr get(rapidjson::Value const& json);
+
+  profile_ptr const& default_profile() const { return default_; }
+
+  std::vector<std::string> names() const;
+
+private:
+  profile_ptr default_;
+  ankerl::unordered_dense::map<std::string, profile_ptr> named_;
+
+  std::mutex cache_mutex_;
+  ankerl::unordered_dense::map<std::string, profile_ptr> cache_;
+};
+
+}  // namespace ppr::backend
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ankerl/unordered_dense.h"
+
+namespace ppr::backend {
+
+// Attaches concurrent requests with the same key to one computation.
+// The first request (leader) computes the result, identical requests that
+// arrive until it is done only register a callback and don't block a thread.
+template <typename Result>
+struct request_coalescer {
+  using callback_t = std::function<void(Result&&)>;
+
+  // Returns true if the caller is the leader and has to compute the result
+  // and call finish(key, result). Otherwise, cb is called with the result
+  // of the running computation.
+  bool join(std::string const& key, callback_t cb) {
+    auto const lock = std::lock_guard{mutex_};
+    auto const [it, inserted] = waiting_.try_emplace(key);
+    it->second.emplace_back(std::move(cb));
+    return inserted;
+  }
+
+  // calls the callbacks of the leader and all attached requests,
+  // the last one gets the result moved, all others a copy
+  void finish(std::string const& key, Result result) {
+    auto callbacks = std::vector<callback_t>{};
+    {
+      auto const lock = std::lock_guard{mutex_};
+      auto const it = waiting_.find(key);
+      if (it == end(waiting_)) {
+        return;
+      }
+      callbacks = std::move(it->second);
+      waiting_.erase(it);
+    }
+    for (auto i = 0U; i + 1 < callbacks.size(); ++i) {
+      callbacks[i](Result{result});
+    }
+    if (!callbacks.empty()) {
+      callbacks.back()(std::move(result));
+    }
+  }
+
+  std::size_t in_flight() const {
+    auto const lock = std::lock_guard{mutex_};
+    return waiting_.size();
+  }
+
+private:
+  mutable std::mutex mutex_;
+  ankerl::unordered_dense::map<std::string, std::vector<callback_t>> waiting_;
+};
+
+}  // namespace ppr::backend
@@ -1,3 +1,4 @@
+#include <string>
 #include <string_view>
 
 #include "rapidjson/document.h"
@@ -9,7 +10,7 @@
 
 #include "ppr/routing/input_location.h"
 
-#include "ppr/profiles/parse_search_profile.h"
+#include "ppr/backend/profile_registry.h"
 
 namespace ppr::backend {
 
@@ -85,10 +86,28 @@ inline void get_input_location(ppr::routing::input_location& loc,
   }
 }
 
-inline void get_profile(ppr::routing::search_profile& profile,
+inline void get_string(std::string& field, rapidjson::Value const& doc,
+                       char const* key) {
+  if (doc.HasMember(key)) {
+    auto const& val = doc[key];
+    if (val.IsString()) {
+      field.assign(val.GetString(), val.GetStringLength());
+    }
+  }
+}
+
+// "profile": "<name>" or a profile object (nullptr if the name is unknown)
+inline void get_profile(profile_registry::profile_ptr& profile,
+                        profile_registry& profiles,
                         rapidjson::Value const& doc, char const* key) {
   if (doc.HasMember(key)) {
-    profiles::parse_search_profile(profile, doc[key]);
+    auto const& val = doc[key];
+    if (val.IsString()) {
+      profile = profiles.get(
+          std::string_view{val.GetString(), val.GetStringLength()});
+    } else if (val.IsObject()) {
+      profile = profiles.get(val);
+    }
   }
 }
 
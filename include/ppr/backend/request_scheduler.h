@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "boost/asio/io_context.hpp"
+
+namespace ppr::backend {
+
+enum class request_priority : std::uint8_t { HIGH, NORMAL };
+
+struct request_scheduler_stats {
+  std::size_t queued_{};  // not admitted
+  std::size_t queued_admitted_{};
+  std::uint64_t rejected_{};
+  std::uint64_t expired_{};
+};
+
+// Bounded priority queue in front of the routing thread pool.
+// Every queued task posts one job to the pool, each job runs the task with
+// the highest priority that is waiting at that time.
+struct request_scheduler {
+  using clock = std::chrono::steady_clock;
+
+  // expired = the task has waited longer than the timeout and should
+  // only report an error
+  using task_t = std::function<void(clock::duration wait, bool expired)>;
+
+  // max_queued = 0: unbounded, timeout = 0: no deadline
+  request_scheduler(boost::asio::io_context& pool, std::size_t max_queued,
+                    std::chrono::milliseconds timeout);
+
+  // returns false (and drops the task) if the queue is full.
+  // admitted = part of a request that has already passed the queue limit
+  // (route batch items): always queued and not counted against the limit.
+  bool post(request_priority priority, task_t task, bool admitted = false);
+
+  request_scheduler_stats stats() const;
+
+private:
+  struct entry {
+    task_t task_;
+    clock::time_point enqueued_;
+    bool admitted_{false};
+  };
+
+  void run_next();
+
+  boost::asio::io_context& pool_;
+  std::size_t max_queued_;
+  std::chrono::milliseconds timeout_;
+
+  mutable std::mutex mutex_;
+  std::array<std::deque<entry>, 2> queues_;  // by priority
+  std::size_t queued_{};  // not admitted
+  std::size_t queued_admitted_{};
+
+  std::atomic<std::uint64_t> rejected_{};
+  std::atomic<std::uint64_t> expired_{};
+};
+
+}  // namespace ppr::backend
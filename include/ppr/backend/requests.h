@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "ppr/common/location.h"
@@ -12,7 +14,9 @@ namespace ppr::backend {
 struct route_request {
   ppr::routing::input_location start_;
   ppr::routing::input_location destination_;
-  ppr::routing::search_profile profile_;
+  // shared with other requests using the same profile
+  std::shared_ptr<ppr::routing::search_profile const> profile_;
+  std::string graph_;  // empty = select by start/destination
 
   routing::routing_options options_;
 
@@ -22,12 +26,15 @@ struct route_request {
   bool include_steps_path_{};
   bool include_edges_{};
   bool include_statistics_{};
+  bool pretty_{};  // indented JSON
 };
 
 struct graph_request {
   std::vector<location> waypoints_;
+  std::string graph_;  // empty = select by waypoints
   bool include_areas_{};
   bool include_visibility_graphs_{};
+  bool pretty_{};  // indented JSON
 };
 
 }  // namespace ppr::backend
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "rapidjson/document.h"
+
+#include "ppr/backend/requests.h"
+
+namespace ppr::backend {
+
+// Requests and results of a /api/route/batch request. Items that can't be
+// parsed get an error result right away, the others are handed out with
+// next() and answered with set_result() (both thread safe).
+struct route_batch {
+  using parse_fn_t = std::function<route_request(rapidjson::Value const&)>;
+
+  // items = JSON array, parse throws on invalid requests
+  route_batch(rapidjson::Value const& items, parse_fn_t const& parse);
+
+  route_batch(route_batch const&) = delete;
+  route_batch& operator=(route_batch const&) = delete;
+  route_batch(route_batch&&) = delete;
+  route_batch& operator=(route_batch&&) = delete;
+
+  std::size_t size() const { return results_.size(); }
+
+  // index of the next request to compute, size() if all have been handed out
+  std::size_t next();
+
+  route_request const& request(std::size_t const i) const {
+    return requests_[i];
+  }
+
+  // returns true for the last missing result (the batch is done)
+  bool set_result(std::size_t i, std::string result);
+
+  bool done() const { return remaining_ == 0; }
+
+  // JSON array with one result per item, in request order
+  std::string response() const;
+
+private:
+  std::vector<route_request> requests_;
+  std::vector<std::string> results_;
+  std::vector<std::size_t> pending_;  // items without parse errors
+  std::atomic_size_t next_{};
+  std::atomic_size_t remaining_{};
+};
+
+}  // namespace ppr::backend
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "ankerl/unordered_dense.h"
+
+#include "ppr/routing/search_profile.h"
+
+namespace ppr::backend {
+
+struct route_cache_stats {
+  std::uint64_t hits_{};
+  std::uint64_t misses_{};
+  std::uint64_t evictions_{};
+  std::size_t entries_{};
+  std::size_t memory_{};  // bytes
+};
+
+// Bounded LRU cache of encoded route responses, keyed by make_route_key
+// (includes the graph version, so reloads invalidate all entries).
+struct route_cache {
+  // max_memory = 0: disabled
+  explicit route_cache(std::size_t max_memory);
+
+  bool enabled() const { return max_memory_ != 0; }
+
+  std::optional<std::string> get(std::string const& key);
+
+  // the profile is kept alive with the entry, the key refers to its address
+  void put(std::string key, std::string response,
+           std::shared_ptr<routing::search_profile const> profile);
+
+  route_cache_stats stats() const;
+
+private:
+  struct entry {
+    std::string key_;
+    std::string response_;
+    std::shared_ptr<routing::search_profile const> profile_;
+  };
+
+  static std::size_t entry_size(entry const& e);
+
+  std::size_t max_memory_;
+
+  mutable std::mutex mutex_;
+  std::list<entry> lru_;  // most recently used first
+  ankerl::unordered_dense::map<std::string_view, std::list<entry>::iterator>
+      index_;  // keys point into lru_ entries
+  std::size_t memory_{};
+
+  std::atomic<std::uint64_t> hits_{};
+  std::atomic<std::uint64_t> misses_{};
+  std::atomic<std::uint64_t> evictions_{};
+};
+
+}  // namespace ppr::backend
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "ppr/backend/requests.h"
+
+namespace ppr::backend {
+
+// Normalized identity of a route request: graph name and version, profile
+// instance (by address), input locations, routing options and output flags.
+// Requests with the same key produce the same response.
+std::string make_route_key(std::string_view graph, std::uint64_t version,
+                           route_request const& r);
+
+}  // namespace ppr::backend
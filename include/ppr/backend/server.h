@@ -1,15 +1,10 @@
 #pragma once
 
-#include <string>
-
-#include "ppr/common/routing_graph.h"
+#include "ppr/backend/graph_registry.h"
+#include "ppr/backend/server_settings.h"
 
 namespace ppr::backend {
 
-void ppr_server(routing_graph const& rg, std::string const& http_host,
-                std::string const& http_port, int num_threads,
-                std::string const& static_file_path,
-                std::string const& cert_path, std::string const& priv_key_path,
-                std::string const& dh_path);
+void ppr_server(graph_registry& graphs, server_settings const& settings);
 
 }  // namespace ppr::backend
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <chrono>
+#include <string>
+
+#include "ppr/backend/access_log.h"
+
+namespace ppr::backend {
+
+struct server_settings {
+  std::string http_host_{"0.0.0.0"};
+  std::string http_port_{"8000"};
+  int num_threads_{1};
+  std::string static_file_path_;
+  std::string profile_path_;  // directory with named profiles (*.json)
+  std::string cert_path_{"::dev::"};
+  std::string priv_key_path_{"::dev::"};
+  std::string dh_path_{"::dev::"};
+
+  // requests waiting for the routing thread pool (0 = unbounded),
+  // more are rejected with 503
+  std::size_t max_queued_requests_{1000};
+
+  // max. time a request may wait in the queue (0 = unlimited)
+  std::chrono::milliseconds queue_timeout_{0};
+
+  // max. number of route requests per /api/route/batch request
+  std::size_t max_batch_size_{100};
+
+  // memory budget of the route response cache in bytes (0 = disabled)
+  std::size_t route_cache_size_{0};
+
+  // JSON lines access log ("-" = stdout), entries below 400 are sampled
+  std::string access_log_path_{"-"};
+  log_level access_log_level_{log_level::ALL};
+  double access_log_sample_rate_{1.0};
+
+  // required as bearer token for /api/admin/* (disabled if empty)
+  std::string admin_token_;
+};
+
+}  // namespace ppr::backend
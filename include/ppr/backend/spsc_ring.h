@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace ppr::backend {
+
+// Lock-free bounded queue for exactly one producer and one consumer thread.
+template <typename T>
+struct spsc_ring {
+  // capacity is rounded up to a power of two
+  explicit spsc_ring(std::size_t const capacity)
+      : slots_(std::bit_ceil(std::max(capacity, std::size_t{2}))),
+        mask_{slots_.size() - 1} {}
+
+  // producer: returns false if the ring is full
+  bool push(T&& val) {
+    auto const head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == slots_.size()) {
+      return false;
+    }
+    slots_[head & mask_] = std::move(val);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer
+  std::optional<T> pop() {
+    auto const tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+    auto val = std::move(slots_[tail & mask_]);
+    tail_.store(tail + 1, std::memory_order_release);
+    return val;
+  }
+
+  std::size_t capacity() const { return slots_.size(); }
+
+private:
+  std::vector<T> slots_;
+  std::size_t mask_;
+  alignas(64) std::atomic_size_t head_{0};  // next slot to write
+  alignas(64) std::atomic_size_t tail_{0};  // next slot to read
+};
+
+}  // namespace ppr::backend
@@ -1,18 +1,26 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "boost/program_options.hpp"
 
 #include "conf/configuration.h"
 
+#include "ppr/backend/graph_registry.h"
+#include "ppr/backend/server_settings.h"
+#include "ppr/common/snapping_cache.h"
+
 namespace ppr::backend {
 
 class prog_options : public conf::configuration {
 public:
   explicit prog_options() : configuration("Options") {
-    param(graph_file_, "graph,g", "Routing graph file");
+    param(graph_files_, "graph,g",
+          "Routing graph files ([name=]file), requests are dispatched by "
+          "location if multiple graphs are loaded");
     param(http_host_, "host", "HTTP host");
     param(http_port_, "port", "HTTP port");
     param(cert_path_, "cert",
@@ -22,29 +30,116 @@ public:
     param(dh_path_, "dhparam",
           "path to dh parameters file or ::dev:: for hardcoded");
     param(static_file_path_, "static", "Path to static files (ui/web)");
+    param(profile_path_, "profiles",
+          "Directory with named profiles (*.json), referenced in requests "
+          "as \"profile\": \"<name>\"");
     param(threads_, "routing-threads", "Number of routing threads");
-    param(edge_rtree_max_size_, "edge-rtree-max-size",
-          "Maximum size for edge r-tree file");
-    param(area_rtree_max_size_, "area-rtree-max-size",
-          "Maximum size for area r-tree file");
     param(lock_rtrees_, "lock-rtrees", "Prefetch and lock r-trees in memory");
     param(prefetch_rtrees_, "prefetch-rtrees", "Prefetch r-trees");
     param(verify_graph_, "verify-graph", "Verify routing graph file");
+    param(snapping_cache_size_, "snapping-cache",
+          "Snapping cache size in MB (0 = disabled)");
+    param(snapping_cache_cell_size_, "snapping-cache-cell-size",
+          "Snapping cache grid cell size in meters");
+    param(max_queued_requests_, "max-queued-requests",
+          "Max. number of requests waiting for a routing thread (0 = "
+          "unbounded), more are rejected with 503");
+    param(queue_timeout_, "queue-timeout",
+          "Max. time in ms a request may wait for a routing thread (0 = "
+          "unlimited)");
+    param(max_batch_size_, "max-batch-size",
+          "Max. number of route requests per /api/route/batch request");
+    param(route_cache_size_, "route-cache",
+          "Route response cache size in MB (0 = disabled)");
+    param(watch_graph_, "watch-graph",
+          "Reload the routing graph file when it is replaced, check interval "
+          "in seconds (0 = disabled)");
+    param(access_log_path_, "access-log",
+          "Access log file (JSON lines), - = stdout");
+    param(access_log_level_, "access-log-level",
+          "Access log level: off, error, info (all requests) or debug "
+          "(+ Server-Timing)");
+    param(access_log_sample_rate_, "access-log-sample",
+          "Fraction of successful requests to log (errors are always "
+          "logged)");
+    param(admin_token_, "admin-token",
+          "Bearer token for /api/admin/reload (empty = disabled)");
+  }
+
+  std::vector<graph_options> get_graphs() const {
+    auto graphs = std::vector<graph_options>{};
+    for (auto const& arg : graph_files_.empty()
+                               ? std::vector<std::string>{"routing-graph.ppr"}
+                               : graph_files_) {
+      graphs.emplace_back(get_graph_options(parse_graph_arg(arg)));
+      graphs.back().coverage_ = graph_files_.size() > 1;
+    }
+    return graphs;
+  }
+
+  graph_options get_graph_options(graph_options go = {}) const {
+    go.rtree_opt_ = lock_rtrees_ ? rtree_options::LOCK
+                                 : (prefetch_rtrees_ ? rtree_options::PREFETCH
+                                                     : rtree_options::DEFAULT);
+    go.snapping_cache_ = snapping_cache_size_ != 0;
+    go.snapping_cache_config_ = get_snapping_cache_config();
+    go.verify_ = verify_graph_;
+    return go;
+  }
+
+  server_settings get_server_settings() const {
+    auto s = server_settings{};
+    s.http_host_ = http_host_;
+    s.http_port_ = http_port_;
+    s.num_threads_ = threads_;
+    s.static_file_path_ = static_file_path_;
+    s.profile_path_ = profile_path_;
+    s.cert_path_ = cert_path_;
+    s.priv_key_path_ = priv_key_path_;
+    s.dh_path_ = dh_path_;
+    s.max_queued_requests_ = max_queued_requests_;
+    s.queue_timeout_ = std::chrono::milliseconds{queue_timeout_};
+    s.max_batch_size_ = max_batch_size_;
+    s.route_cache_size_ =
+        static_cast<std::size_t>(route_cache_size_) * 1024 * 1024;
+    s.access_log_path_ = access_log_path_;
+    s.access_log_level_ = parse_log_level(access_log_level_);
+    s.access_log_sample_rate_ = access_log_sample_rate_;
+    s.admin_token_ = admin_token_;
+    return s;
+  }
+
+  snapping_cache_config get_snapping_cache_config() const {
+    auto config = snapping_cache_config{};
+    config.max_memory_ =
+        static_cast<std::size_t>(snapping_cache_size_) * 1024 * 1024;
+    config.cell_size_ = snapping_cache_cell_size_;
+    return config;
   }
 
-  std::string graph_file_{"routing-graph.ppr"};
+  std::vector<std::string> graph_files_;
   std::string http_host_{"0.0.0.0"};
   std::string http_port_{"8000"};
   std::string cert_path_{"::dev::"};
   std::string priv_key_path_{"::dev::"};
   std::string dh_path_{"::dev::"};
   std::string static_file_path_;
+  std::string profile_path_;
   int threads_{static_cast<int>(std::thread::hardware_concurrency())};
-  std::size_t edge_rtree_max_size_{1024UL * 1024 * 1024 * 3};
-  std::size_t area_rtree_max_size_{1024UL * 1024 * 1024};
   bool lock_rtrees_{false};
   bool prefetch_rtrees_{false};
   bool verify_graph_{true};
+  unsigned snapping_cache_size_{0};
+  double snapping_cache_cell_size_{100};
+  std::size_t max_queued_requests_{1000};
+  unsigned queue_timeout_{0};
+  std::size_t max_batch_size_{100};
+  unsigned route_cache_size_{0};
+  unsigned watch_graph_{0};
+  std::string access_log_path_{"-"};
+  std::string access_log_level_{"info"};
+  double access_log_sample_rate_{1.0};
+  std::string admin_token_;
 };
 
 }  // namespace ppr::backend
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "boost/program_options.hpp"
+
+#include "conf/configuration.h"
+
+namespace ppr::dem_pack {
+
+class prog_options : public conf::configuration {
+public:
+  explicit prog_options() : configuration("DEM Pack Options") {
+    param(dem_files_, "dem", "DEM (elevation) files/directories (EHdr/BIL)");
+    param(output_file_, "out,o", "output file (.pprdem)");
+    param(tile_size_, "tile-size", "Tile size (pixels)");
+  }
+
+  std::vector<std::string> dem_files_;
+  std::string output_file_{"elevation.pprdem"};
+  unsigned tile_size_{256};
+};
+
+}  // namespace ppr::dem_pack
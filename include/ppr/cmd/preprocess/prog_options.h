@@ -21,15 +21,28 @@ public:
     param(dem_files_, "dem", "DEM (elevation) files");
     param(elevation_sampling_interval_, "dem-interval",
           "Elevation sampling interval (meters, 0 to disable)");
+    param(dem_tile_cache_size_, "dem-cache",
+          "Memory limit for decoded DEM pack tiles (MiB)");
     param(crossing_detours_limit_, "detours-limit",
           "Limit for unmarked crossing detours (meters)");
+    param(base_graph_file_, "update",
+          "Existing routing graph to update (incremental update)");
+    param(changes_file_, "changes",
+          "OSM changes for --update (.osc, .osc.gz or the old .pbf file)");
+    param(update_halo_, "update-halo",
+          "Area rebuilt around the changes (meters)");
+    param(partition_size_, "partition-size",
+          "Build in partitions of this size (degrees, 0 = disabled)");
+    param(partition_halo_, "partition-halo",
+          "Overlap between partitions (meters)");
+    param(partition_jobs_, "partition-jobs",
+          "Number of partitions built concurrently");
+    param(partitions_, "partitions",
+          "Only build these partitions (col_row), merge them with --merge");
+    param(partition_files_, "merge", "Merge these partition files");
+    param(keep_partition_files_, "keep-partitions", "Keep partition files");
     param(print_warnings_, "warnings", "Print warnings");
     param(move_crossings_, "move-crossings", "Move nodes away from junctions");
-    param(create_rtrees_, "create-rtrees", "Create r-tree files");
-    param(edge_rtree_max_size_, "edge-rtree-max-size",
-          "Maximum size for edge r-tree file");
-    param(area_rtree_max_size_, "area-rtree-max-size",
-          "Maximum size for area r-tree file");
     param(verify_graph_, "verify-graph", "Verify generated graph file");
     param(print_timing_overview_, "timings", "Print timing overview");
     param(print_memory_usage_, "mem", "Print memory usage");
@@ -42,12 +55,20 @@ public:
     opt.graph_file_ = graph_file_;
     opt.elevation_sampling_interval_ =
         static_cast<double>(elevation_sampling_interval_);
+    opt.dem_tile_cache_size_ =
+        static_cast<std::size_t>(dem_tile_cache_size_) * 1024 * 1024;
     opt.crossing_detours_limit_ = static_cast<double>(crossing_detours_limit_);
+    opt.base_graph_file_ = base_graph_file_;
+    opt.changes_file_ = changes_file_;
+    opt.update_halo_ = static_cast<double>(update_halo_);
+    opt.partition_size_ = partition_size_;
+    opt.partition_halo_ = static_cast<double>(partition_halo_);
+    opt.partition_jobs_ = partition_jobs_;
+    opt.partitions_ = partitions_;
+    opt.partition_files_ = partition_files_;
+    opt.keep_partition_files_ = keep_partition_files_;
     opt.print_warnings_ = print_warnings_;
     opt.move_crossings_ = move_crossings_;
-    opt.create_rtrees_ = create_rtrees_;
-    opt.edge_rtree_max_size_ = edge_rtree_max_size_;
-    opt.area_rtree_max_size_ = area_rtree_max_size_;
     return opt;
   }
 
@@ -55,15 +76,22 @@ public:
   std::string graph_file_{"routing-graph.ppr"};
   std::vector<std::string> dem_files_;
   int elevation_sampling_interval_{30};
+  unsigned dem_tile_cache_size_{512};
   int crossing_detours_limit_{600};
+  std::string base_graph_file_;
+  std::string changes_file_;
+  int update_halo_{1000};
+  double partition_size_{0};
+  int partition_halo_{2000};
+  unsigned partition_jobs_{1};
+  std::vector<std::string> partitions_;
+  std::vector<std::string> partition_files_;
+  bool keep_partition_files_{false};
   bool print_warnings_{false};
   bool move_crossings_{false};
-  bool create_rtrees_{true};
   bool verify_graph_{false};
   bool print_timing_overview_{false};
   bool print_memory_usage_{false};
-  std::size_t edge_rtree_max_size_{1024UL * 1024 * 1024 * 3};
-  std::size_t area_rtree_max_size_{1024UL * 1024 * 1024};
 };
 
 }  // namespace ppr::preprocessing
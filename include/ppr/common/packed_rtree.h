@@ -0,0 +1,324 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "ppr/common/data.h"
+#include "ppr/common/location.h"
+#include "ppr/common/math.h"
+#include "ppr/common/parallel.h"
+
+namespace ppr {
+
+// bounding box in fixed point coordinates (see location)
+struct packed_rtree_box {
+  inline bool intersects(packed_rtree_box const& o) const {
+    return min_x_ <= o.max_x_ && max_x_ >= o.min_x_ && min_y_ <= o.max_y_ &&
+           max_y_ >= o.min_y_;
+  }
+
+  inline void extend(packed_rtree_box const& o) {
+    min_x_ = std::min(min_x_, o.min_x_);
+    min_y_ = std::min(min_y_, o.min_y_);
+    max_x_ = std::max(max_x_, o.max_x_);
+    max_y_ = std::max(max_y_, o.max_y_);
+  }
+
+  inline void extend(location const& loc) {
+    min_x_ = std::min(min_x_, loc.x());
+    min_y_ = std::min(min_y_, loc.y());
+    max_x_ = std::max(max_x_, loc.x());
+    max_y_ = std::max(max_y_, loc.y());
+  }
+
+  std::int32_t min_x_{std::numeric_limits<std::int32_t>::max()};
+  std::int32_t min_y_{std::numeric_limits<std::int32_t>::max()};
+  std::int32_t max_x_{std::numeric_limits<std::int32_t>::min()};
+  std::int32_t max_y_{std::numeric_limits<std::int32_t>::min()};
+};
+
+inline packed_rtree_box make_packed_rtree_box(location const& loc) {
+  return {loc.x(), loc.y(), loc.x(), loc.y()};
+}
+
+template <typename Locations>
+inline packed_rtree_box make_packed_rtree_box(Locations const& locations) {
+  auto box = packed_rtree_box{};
+  for (auto const& loc : locations) {
+    box.extend(loc);
+  }
+  return box;
+}
+
+// Squared distance between loc and the box in fixed point units, with the
+// x axis scaled by scale_x (cos(lat) of loc). Zero if loc is inside the box.
+inline double box_dist_sq(location const& loc, packed_rtree_box const& b,
+                          double const scale_x) {
+  auto const dx =
+      loc.x() < b.min_x_
+          ? static_cast<double>(b.min_x_) - loc.x()
+          : (loc.x() > b.max_x_ ? static_cast<double>(loc.x()) - b.max_x_
+                                : 0.0);
+  auto const dy =
+      loc.y() < b.min_y_
+          ? static_cast<double>(b.min_y_) - loc.y()
+          : (loc.y() > b.max_y_ ? static_cast<double>(loc.y()) - b.max_y_
+                                : 0.0);
+  return dx * dx * scale_x * scale_x + dy * dy;
+}
+
+// Position of (x, y) on a hilbert curve over a 2^16 x 2^16 grid.
+// Based on "Fast Hilbert curve generation, sorting, and range queries"
+// (rawrunprotected.org), as used by flatbush.
+inline std::uint32_t hilbert_index(std::uint32_t x, std::uint32_t y) {
+  auto a = x ^ y;
+  auto b = 0xFFFFU ^ a;
+  auto c = 0xFFFFU ^ (x | y);
+  auto d = x & (y ^ 0xFFFFU);
+
+  auto aa = a | (b >> 1U);
+  auto bb = (a >> 1U) ^ a;
+  auto cc = ((c >> 1U) ^ (b & (d >> 1U))) ^ c;
+  auto dd = ((a & (c >> 1U)) ^ (d >> 1U)) ^ d;
+
+  a = aa;
+  b = bb;
+  c = cc;
+  d = dd;
+  aa = ((a & (a >> 2U)) ^ (b & (b >> 2U)));
+  bb = ((a & (b >> 2U)) ^ (b & ((a ^ b) >> 2U)));
+  cc ^= ((a & (c >> 2U)) ^ (b & (d >> 2U)));
+  dd ^= ((b & (c >> 2U)) ^ ((a ^ b) & (d >> 2U)));
+
+  a = aa;
+  b = bb;
+  c = cc;
+  d = dd;
+  aa = ((a & (a >> 4U)) ^ (b & (b >> 4U)));
+  bb = ((a & (b >> 4U)) ^ (b & ((a ^ b) >> 4U)));
+  cc ^= ((a & (c >> 4U)) ^ (b & (d >> 4U)));
+  dd ^= ((b & (c >> 4U)) ^ ((a ^ b) & (d >> 4U)));
+
+  a = aa;
+  b = bb;
+  c = cc;
+  d = dd;
+  cc ^= ((a & (c >> 8U)) ^ (b & (d >> 8U)));
+  dd ^= ((b & (c >> 8U)) ^ ((a ^ b) & (d >> 8U)));
+
+  a = cc ^ (cc >> 1U);
+  b = dd ^ (dd >> 1U);
+
+  auto i0 = x ^ y;
+  auto i1 = b | (0xFFFFU ^ (i0 | a));
+
+  i0 = (i0 | (i0 << 8U)) & 0x00FF00FFU;
+  i0 = (i0 | (i0 << 4U)) & 0x0F0F0F0FU;
+  i0 = (i0 | (i0 << 2U)) & 0x33333333U;
+  i0 = (i0 | (i0 << 1U)) & 0x55555555U;
+
+  i1 = (i1 | (i1 << 8U)) & 0x00FF00FFU;
+  i1 = (i1 | (i1 << 4U)) & 0x0F0F0F0FU;
+  i1 = (i1 | (i1 << 2U)) & 0x33333333U;
+  i1 = (i1 | (i1 << 1U)) & 0x55555555U;
+
+  return (i1 << 1U) | i0;
+}
+
+// Static packed r-tree (hilbert sorted, flatbush-style).
+// Only plain arrays are stored, so the tree can be serialized together
+// with the routing graph and queried directly from the memory mapped file.
+template <typename T>
+struct packed_rtree {
+  static constexpr auto const NODE_SIZE = 16U;
+
+  inline bool empty() const { return values_.empty(); }
+  inline std::size_t size() const { return values_.size(); }
+
+  // calls fn(value) for all entries whose bounding box intersects query
+  template <typename Fn>
+  void search(packed_rtree_box const& query, Fn&& fn) const {
+    search_entries(query, [&](packed_rtree_box const&, T const& value) {
+      fn(value);
+    });
+  }
+
+  // calls fn(box, value) for all entries whose bounding box intersects query
+  template <typename Fn>
+  void search_entries(packed_rtree_box const& query, Fn&& fn) const {
+    if (empty()) {
+      return;
+    }
+    auto stack = std::vector<std::pair<std::uint32_t, std::uint32_t>>{};
+    stack.emplace_back(root(), root_level());
+    while (!stack.empty()) {
+      auto const [pos, level] = stack.back();
+      stack.pop_back();
+      if (!boxes_[pos].intersects(query)) {
+        continue;
+      }
+      if (level == 0) {
+        fn(boxes_[pos], values_[pos]);
+        continue;
+      }
+      auto const [first, last] = children(pos, level);
+      for (auto i = first; i < last; ++i) {
+        stack.emplace_back(i, level - 1);
+      }
+    }
+  }
+
+  // calls fn(value) for the (at most) max_count entries with the nearest
+  // bounding boxes, in order of increasing distance
+  template <typename Fn>
+  void nearest(location const& loc, std::size_t const max_count,
+               Fn&& fn) const {
+    if (empty() || max_count == 0) {
+      return;
+    }
+
+    struct queue_entry {
+      bool operator>(queue_entry const& o) const { return dist_ > o.dist_; }
+      double dist_;
+      std::uint32_t pos_;
+      std::uint32_t level_;
+    };
+
+    auto const scale_x = std::cos(to_rad(loc.lat()));
+    auto const dist = [&](packed_rtree_box const& b) {
+      return box_dist_sq(loc, b, scale_x);
+    };
+
+    auto pq = std::priority_queue<queue_entry, std::vector<queue_entry>,
+                                  std::greater<>>{};
+    pq.push({dist(boxes_[root()]), root(), root_level()});
+    auto found = std::size_t{0};
+    while (!pq.empty() && found < max_count) {
+      auto const e = pq.top();
+      pq.pop();
+      if (e.level_ == 0) {
+        fn(values_[e.pos_]);
+        ++found;
+        continue;
+      }
+      auto const [first, last] = children(e.pos_, e.level_);
+      for (auto i = first; i < last; ++i) {
+        pq.push({dist(boxes_[i]), i, e.level_ - 1});
+      }
+    }
+  }
+
+  inline std::uint32_t root() const {
+    return static_cast<std::uint32_t>(boxes_.size() - 1);
+  }
+
+  inline std::uint32_t root_level() const {
+    return static_cast<std::uint32_t>(level_bounds_.size() - 1);
+  }
+
+  inline std::uint32_t level_start(std::uint32_t const level) const {
+    return level == 0 ? 0U : level_bounds_[level - 1];
+  }
+
+  inline std::pair<std::uint32_t, std::uint32_t> children(
+      std::uint32_t const pos, std::uint32_t const level) const {
+    auto const first =
+        level_start(level - 1) + (pos - level_start(level)) * NODE_SIZE;
+    auto const last = std::min(first + NODE_SIZE, level_bounds_[level - 1]);
+    return {first, last};
+  }
+
+  std::size_t memory_size() const {
+    return boxes_.size() * sizeof(packed_rtree_box) +
+           values_.size() * sizeof(T) +
+           level_bounds_.size() * sizeof(std::uint32_t);
+  }
+
+  // level 0 (leaves) first, followed by the upper levels, root is last
+  data::vector<packed_rtree_box> boxes_;
+  // values_[i] is the value for the leaf box boxes_[i]
+  data::vector<T> values_;
+  // level_bounds_[l] = end of level l in boxes_
+  data::vector<std::uint32_t> level_bounds_;
+};
+
+// Entries are sorted by the hilbert index of their centers and packed
+// bottom-up. Hilbert indices, sorting and packing run on all cores.
+template <typename T>
+packed_rtree<T> build_packed_rtree(
+    std::vector<std::pair<packed_rtree_box, T>> const& entries) {
+  constexpr auto const NODE_SIZE = packed_rtree<T>::NODE_SIZE;
+
+  auto rtree = packed_rtree<T>{};
+  if (entries.empty()) {
+    return rtree;
+  }
+
+  auto total = packed_rtree_box{};
+  for (auto const& e : entries) {
+    total.extend(e.first);
+  }
+
+  auto const width = std::max(
+      static_cast<double>(total.max_x_) - static_cast<double>(total.min_x_),
+      1.0);
+  auto const height = std::max(
+      static_cast<double>(total.max_y_) - static_cast<double>(total.min_y_),
+      1.0);
+  auto const hilbert_max = static_cast<double>((1U << 16U) - 1);
+
+  auto const n = static_cast<std::uint32_t>(entries.size());
+  auto order = std::vector<std::pair<std::uint32_t, std::uint32_t>>(n);
+  parallel_for_chunks(n, [&](std::size_t const i) {
+    auto const& b = entries[i].first;
+    auto const cx =
+        (static_cast<double>(b.min_x_) + static_cast<double>(b.max_x_)) / 2.0;
+    auto const cy =
+        (static_cast<double>(b.min_y_) + static_cast<double>(b.max_y_)) / 2.0;
+    auto const hx =
+        static_cast<std::uint32_t>(hilbert_max * (cx - total.min_x_) / width);
+    auto const hy =
+        static_cast<std::uint32_t>(hilbert_max * (cy - total.min_y_) / height);
+    order[i] = {hilbert_index(hx, hy), static_cast<std::uint32_t>(i)};
+  });
+  parallel_sort(order);
+
+  auto level_end = n;
+  rtree.level_bounds_.push_back(level_end);
+  for (auto level_size = n; level_size > 1;) {
+    level_size = (level_size + NODE_SIZE - 1) / NODE_SIZE;
+    level_end += level_size;
+    rtree.level_bounds_.push_back(level_end);
+  }
+
+  rtree.boxes_.resize(level_end);
+  rtree.values_.resize(n);
+  parallel_for_chunks(n, [&](std::size_t const i) {
+    auto const& e = entries[order[i].second];
+    rtree.boxes_[i] = e.first;
+    rtree.values_[i] = e.second;
+  });
+
+  for (auto level = 1U; level < rtree.level_bounds_.size(); ++level) {
+    auto const first = rtree.level_start(level);
+    auto const last = rtree.level_bounds_[level];
+    parallel_for_chunks(last - first, [&](std::size_t const i) {
+      auto const pos = static_cast<std::uint32_t>(first + i);
+      auto const [child_first, child_last] = rtree.children(pos, level);
+      auto box = packed_rtree_box{};
+      for (auto c = child_first; c < child_last; ++c) {
+        box.extend(rtree.boxes_[c]);
+      }
+      rtree.boxes_[pos] = box;
+    });
+  }
+
+  return rtree;
+}
+
+}  // namespace ppr
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "utl/parallel_for.h"
+
+namespace ppr {
+
+// 0 = all cores
+inline std::atomic<std::size_t>& thread_limit() {
+  static auto limit = std::atomic<std::size_t>{0};
+  return limit;
+}
+
+// limits the threads used by the functions below (0 = all cores)
+inline void set_thread_count(std::size_t const n) { thread_limit() = n; }
+
+inline std::size_t thread_count() {
+  auto const limit = thread_limit().load();
+  return limit != 0 ? limit
+                    : std::max(1U, std::thread::hardware_concurrency());
+}
+
+// calls fn(worker, i) for all i in [0, n) on up to thread_count() threads,
+// worker in [0, thread_count()) is the index of the calling thread (e.g. for
+// per-thread buffers). the first exception thrown by fn is rethrown.
+template <typename Fn>
+void parallel_for_workers(std::size_t const n, Fn&& fn) {
+  auto const workers = std::min(thread_count(), n);
+  if (workers <= 1) {
+    for (auto i = std::size_t{0}; i < n; ++i) {
+      fn(std::size_t{0}, i);
+    }
+    return;
+  }
+
+  auto next = std::atomic<std::size_t>{0};
+  auto error = std::exception_ptr{};
+  auto error_mutex = std::mutex{};
+  auto const run = [&](std::size_t const worker) {
+    try {
+      for (auto i = next++; i < n; i = next++) {
+        fn(worker, i);
+      }
+    } catch (...) {
+      auto const lock = std::lock_guard{error_mutex};
+      if (!error) {
+        error = std::current_exception();
+      }
+      next = n;
+    }
+  };
+
+  auto threads = std::vector<std::thread>{};
+  threads.reserve(workers - 1);
+  for (auto w = std::size_t{1}; w < workers; ++w) {
+    threads.emplace_back(run, w);
+  }
+  run(0);
+  for (auto& t : threads) {
+    t.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+// calls fn(i) for all i in [0, n), distributed over all cores in chunks
+template <typename Fn>
+void parallel_for_chunks(std::size_t const n, Fn&& fn,
+                         std::size_t const chunk_size = 16384) {
+  if (n <= chunk_size) {
+    for (auto i = std::size_t{0}; i < n; ++i) {
+      fn(i);
+    }
+    return;
+  }
+  parallel_for_workers((n + chunk_size - 1) / chunk_size,
+                       [&](std::size_t, std::size_t const chunk) {
+                         auto const first = chunk * chunk_size;
+                         auto const last = std::min(n, first + chunk_size);
+                         for (auto i = first; i < last; ++i) {
+                           fn(i);
+                         }
+                       });
+}
+
+// sorts chunks in parallel, then merges them pairwise in parallel rounds
+// (v: contiguous container, e.g. std::vector)
+template <typename Container, typename Cmp = std::less<>>
+void parallel_sort(Container& v, Cmp const& cmp = Cmp{}) {
+  constexpr auto const MIN_CHUNK_SIZE = std::size_t{1U << 16U};
+  auto const n = v.size();
+  auto const chunk_count = std::min(thread_count(), n / MIN_CHUNK_SIZE);
+  if (chunk_count < 2) {
+    std::sort(v.begin(), v.end(), cmp);
+    return;
+  }
+
+  auto bounds = std::vector<std::size_t>(chunk_count + 1);
+  for (auto i = std::size_t{0}; i <= chunk_count; ++i) {
+    bounds[i] = i * n / chunk_count;
+  }
+  auto const it = [&](std::size_t const chunk) {
+    return v.begin() + static_cast<std::ptrdiff_t>(bounds[chunk]);
+  };
+
+  parallel_for_workers(chunk_count, [&](std::size_t, std::size_t const chunk) {
+    std::sort(it(chunk), it(chunk + 1), cmp);
+  });
+
+  for (auto width = std::size_t{1}; width < chunk_count; width *= 2) {
+    auto const merges = (chunk_count + 2 * width - 1) / (2 * width);
+    parallel_for_workers(merges, [&](std::size_t, std::size_t const m) {
+      auto const lo = m * 2 * width;
+      auto const mid = std::min(lo + width, chunk_count);
+      auto const hi = std::min(lo + 2 * width, chunk_count);
+      if (mid < hi) {
+        std::inplace_merge(it(lo), it(mid), it(hi), cmp);
+      }
+    });
+  }
+}
+
+}  // namespace ppr
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "ankerl/unordered_dense.h"
+
+#include "ppr/common/location.h"
+#include "ppr/common/math.h"
+#include "ppr/common/packed_rtree.h"
+#include "ppr/common/routing_graph.h"
+
+namespace ppr {
+
+struct snapping_cache_config {
+  // upper bound for the memory used by all cached cells
+  std::size_t max_memory_{64 * 1024 * 1024};
+  // edge length of a grid cell in meters (north-south)
+  double cell_size_{100};
+  // queries with a max distance up to this value (meters) are answered from
+  // the cache, larger ones fall back to the r-trees
+  double max_distance_{300};
+};
+
+// Uniform grid over the edge and area r-trees. Each cell stores all r-tree
+// entries within max_distance of the cell, so that nearest / containment
+// queries for locations inside the cell return the same results as the
+// r-trees. Cells are filled lazily and evicted in LRU order.
+struct snapping_cache {
+  struct cell {
+    std::size_t memory_size() const {
+      return sizeof(cell) + edges_.size() * sizeof(edges_[0]) +
+             areas_.size() * sizeof(areas_[0]);
+    }
+
+    std::vector<std::pair<packed_rtree_box, rg_edge>> edges_;
+    std::vector<std::pair<packed_rtree_box, std::uint32_t>> areas_;
+  };
+
+  struct lookup_result {
+    std::shared_ptr<cell const> cell_;
+    bool hit_{false};
+  };
+
+  snapping_cache(routing_graph_data const& rg, snapping_cache_config config);
+
+  inline bool covers(double const max_dist) const {
+    return search_radius(max_dist) <= config_.max_distance_;
+  }
+
+  // radius (meters) in which candidates for max_dist are searched, slightly
+  // larger because area distances are spherical, not equirectangular
+  static inline double search_radius(double const max_dist) {
+    return max_dist * 1.05 + 1.0;
+  }
+
+  // meters per fixed point unit in north-south direction
+  static constexpr double meters_per_unit() {
+    return to_rad(1.0) * AVG_EARTH_RADIUS / location::PRECISION;
+  }
+
+  // returns the cell containing loc, computing it if necessary
+  lookup_result get(location const& loc);
+
+  std::size_t memory_size() const;
+  std::size_t cell_count() const;
+
+  inline std::size_t hits() const { return hits_.load(); }
+  inline std::size_t misses() const { return misses_.load(); }
+
+private:
+  static constexpr auto const SHARD_COUNT = 16U;
+
+  struct shard {
+    std::mutex mutex_;
+    std::list<std::uint64_t> lru_;  // most recently used first
+    ankerl::unordered_dense::map<
+        std::uint64_t, std::pair<std::shared_ptr<cell const>,
+                                 std::list<std::uint64_t>::iterator>>
+        cells_;
+    std::size_t memory_{0};
+  };
+
+  std::uint64_t cell_key(location const& loc) const;
+  std::shared_ptr<cell const> create_cell(std::uint64_t key) const;
+  shard& get_shard(std::uint64_t key);
+
+  routing_graph_data const& rg_;
+  snapping_cache_config config_;
+  std::int64_t cell_size_fixed_;
+  mutable std::array<shard, SHARD_COUNT> shards_;
+  std::atomic<std::size_t> hits_{0};
+  std::atomic<std::size_t> misses_{0};
+};
+
+void enable_snapping_cache(routing_graph& rg,
+                           snapping_cache_config const& config);
+
+}  // namespace ppr
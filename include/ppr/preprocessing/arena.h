@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ppr::preprocessing {
+
+// Append-only storage for graph nodes and edges.
+// Elements are stored in large contiguous blocks (instead of one heap
+// allocation per element) and are never moved, i.e. pointers to elements
+// remain valid while new elements are added. Elements are addressed by
+// their insertion index.
+template <typename T, std::size_t BlockSize = 8192>
+struct arena {
+  template <bool Const>
+  struct iterator_base {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, T const*, T*>;
+    using reference = std::conditional_t<Const, T const&, T&>;
+    using arena_ptr = std::conditional_t<Const, arena const*, arena*>;
+
+    reference operator*() const { return (*arena_)[idx_]; }
+    pointer operator->() const { return &(*arena_)[idx_]; }
+
+    iterator_base& operator++() {
+      ++idx_;
+      return *this;
+    }
+
+    iterator_base operator++(int) {
+      auto const tmp = *this;
+      ++idx_;
+      return tmp;
+    }
+
+    bool operator==(iterator_base const& o) const { return idx_ == o.idx_; }
+    bool operator!=(iterator_base const& o) const { return idx_ != o.idx_; }
+
+    arena_ptr arena_{};
+    std::size_t idx_{};
+  };
+
+  using iterator = iterator_base<false>;
+  using const_iterator = iterator_base<true>;
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    if (blocks_.empty() || blocks_.back().size() == BlockSize) {
+      blocks_.emplace_back().reserve(BlockSize);
+    }
+    ++size_;
+    // never reallocates: the block was reserved for BlockSize elements
+    return blocks_.back().emplace_back(std::forward<Args>(args)...);
+  }
+
+  T& operator[](std::size_t const idx) {
+    return blocks_[idx / BlockSize][idx % BlockSize];
+  }
+
+  T const& operator[](std::size_t const idx) const {
+    return blocks_[idx / BlockSize][idx % BlockSize];
+  }
+
+  T& back() { return blocks_.back().back(); }
+  T const& back() const { return blocks_.back().back(); }
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  void reserve(std::size_t const n) {
+    blocks_.reserve((n + BlockSize - 1) / BlockSize);
+  }
+
+  void clear() {
+    blocks_.clear();
+    size_ = 0;
+  }
+
+  std::size_t memory_size() const {
+    return blocks_.size() * BlockSize * sizeof(T);
+  }
+
+  iterator begin() { return {this, 0}; }
+  iterator end() { return {this, size_}; }
+  const_iterator begin() const { return {this, 0}; }
+  const_iterator end() const { return {this, size_}; }
+
+  std::vector<std::vector<T>> blocks_;
+  std::size_t size_{};
+};
+
+}  // namespace ppr::preprocessing
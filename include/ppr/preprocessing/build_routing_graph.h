@@ -9,7 +9,13 @@
 
 namespace ppr::preprocessing {
 
+struct int_graph;
+
 routing_graph build_routing_graph(options const& opt, logging& log,
                                   statistics& stats);
 
+// the int graph is modified
+routing_graph build_routing_graph(int_graph& ig, options const& opt,
+                                  logging& log, statistics& stats);
+
 }  // namespace ppr::preprocessing
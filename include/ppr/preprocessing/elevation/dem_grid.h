@@ -16,6 +16,26 @@ union pixel_value {
   float float32_;
 };
 
+// degrees
+struct dem_bounds {
+  double min_lon_;
+  double min_lat_;
+  double max_lon_;
+  double max_lat_;
+};
+
+// pixel grid: pixel (col, row) covers
+// [ulx_ + col * xdim_, ulx_ + (col + 1) * xdim_] x
+// [uly_ - (row + 1) * ydim_, uly_ - row * ydim_]
+struct dem_raster {
+  unsigned rows_;
+  unsigned cols_;
+  double ulx_;  // upper left lon
+  double uly_;  // upper left lat
+  double xdim_;  // x pixel dimension, degrees
+  double ydim_;  // y pixel dimension, degrees
+};
+
 struct dem_grid {
   explicit dem_grid(std::string const& filename);
   ~dem_grid();
@@ -25,11 +45,16 @@ struct dem_grid {
   dem_grid& operator=(dem_grid&& grid) = delete;
 
   elevation_t get(location const& loc) const;
+  elevation_t get_pixel(unsigned col, unsigned row) const;
 
   pixel_value get_raw(location const& loc) const;
   pixel_type get_pixel_type() const;
+  dem_bounds bounds() const;
+  dem_raster raster() const;
 
 private:
+  elevation_t to_elevation(pixel_value val) const;
+
   struct impl;
   std::unique_ptr<impl> impl_;
 };
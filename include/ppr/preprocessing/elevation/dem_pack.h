@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <iosfwd>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ankerl/unordered_dense.h"
+
+#include "ppr/common/elevation.h"
+#include "ppr/common/location.h"
+#include "ppr/preprocessing/elevation/dem_grid.h"
+
+namespace ppr::preprocessing::elevation {
+
+// Tiled, compressed DEM cache (created by ppr-dem-pack from EHdr/BIL grids).
+//
+// File layout (little endian):
+//   dem_pack_header
+//   dem_pack_grid[grid_count_]
+//   dem_pack_tile[total tile count] (tile directory, row major per grid)
+//   compressed tile data
+//
+// A tile contains up to tile_size_ x tile_size_ elevations (tiles at the
+// right / bottom border of a grid are clipped), see encode_dem_tile.
+// Tiles without any elevation data are not stored (size_ = 0).
+constexpr auto const DEM_PACK_MAGIC =
+    std::array<char, 8>{'P', 'P', 'R', 'D', 'E', 'M', 'P', 'K'};
+constexpr auto const DEM_PACK_VERSION = std::uint32_t{1};
+constexpr auto const DEM_PACK_EXTENSION = ".pprdem";
+
+struct dem_pack_header {
+  std::array<char, 8> magic_{DEM_PACK_MAGIC};
+  std::uint32_t version_{DEM_PACK_VERSION};
+  std::uint32_t tile_size_{};
+  std::uint32_t grid_count_{};
+  std::uint32_t padding_{};
+};
+
+struct dem_pack_grid {
+  inline std::uint32_t tile_cols(std::uint32_t const tile_size) const {
+    return (raster_.cols_ + tile_size - 1) / tile_size;
+  }
+
+  inline std::uint32_t tile_rows(std::uint32_t const tile_size) const {
+    return (raster_.rows_ + tile_size - 1) / tile_size;
+  }
+
+  dem_raster raster_{};
+  std::uint64_t first_tile_{};  // index into the tile directory
+};
+
+struct dem_pack_tile {
+  std::uint64_t offset_{};  // file offset
+  std::uint32_t size_{};  // compressed size in bytes
+  std::uint32_t padding_{};
+};
+
+// Elevations are stored row by row as zigzag encoded differences to the
+// previous value in the row (the first value of a row: to the first value
+// of the previous row). The low bytes of all values are followed by the
+// high bytes, which are mostly zero. The result is compressed with zlib.
+std::vector<std::uint8_t> encode_dem_tile(
+    std::vector<elevation_t> const& values, unsigned width);
+
+// values: width * height elevations
+void decode_dem_tile(std::uint8_t const* data, std::size_t size,
+                     unsigned width, std::vector<elevation_t>& values);
+
+// LRU cache of decoded tiles, shared by all dem packs of a dem_source.
+// Thread safe.
+struct dem_tile_cache {
+  using tile = std::vector<elevation_t>;
+
+  explicit dem_tile_cache(std::size_t max_memory) : max_memory_{max_memory} {}
+
+  // returns the cached tile or calls decode() and caches the result
+  template <typename Fn>
+  std::shared_ptr<tile const> get(std::uint64_t const key, Fn&& decode) {
+    auto& s = get_shard(key);
+    {
+      auto const lock = std::scoped_lock{s.mutex_};
+      if (auto it = s.tiles_.find(key); it != end(s.tiles_)) {
+        s.lru_.splice(begin(s.lru_), s.lru_, it->second.second);
+        return it->second.first;
+      }
+    }
+
+    // decoded without holding the lock
+    ++decoded_;
+    auto const t = std::make_shared<tile const>(decode());
+    auto const size = memory_size(*t);
+    auto const max_shard_memory = max_memory_ / SHARD_COUNT;
+    if (size > max_shard_memory) {
+      return t;
+    }
+
+    auto const lock = std::scoped_lock{s.mutex_};
+    if (auto it = s.tiles_.find(key); it != end(s.tiles_)) {
+      return it->second.first;
+    }
+    while (!s.lru_.empty() && s.memory_ + size > max_shard_memory) {
+      auto const evict_it = s.tiles_.find(s.lru_.back());
+      s.memory_ -= memory_size(*evict_it->second.first);
+      s.tiles_.erase(evict_it);
+      s.lru_.pop_back();
+    }
+    s.lru_.push_front(key);
+    s.tiles_.emplace(key, std::pair{t, begin(s.lru_)});
+    s.memory_ += size;
+    return t;
+  }
+
+  // each dem pack uses its own key range
+  inline std::uint64_t next_key_base() {
+    return static_cast<std::uint64_t>(next_source_++) << 40U;
+  }
+
+  inline std::size_t decoded_tiles() const { return decoded_.load(); }
+
+private:
+  static constexpr auto const SHARD_COUNT = 16U;
+
+  struct shard {
+    std::mutex mutex_;
+    std::list<std::uint64_t> lru_;  // most recently used first
+    ankerl::unordered_dense::map<
+        std::uint64_t, std::pair<std::shared_ptr<tile const>,
+                                 std::list<std::uint64_t>::iterator>>
+        tiles_;
+    std::size_t memory_{0};
+  };
+
+  static inline std::size_t memory_size(tile const& t) {
+    return sizeof(tile) + t.size() * sizeof(elevation_t);
+  }
+
+  inline shard& get_shard(std::uint64_t const key) {
+    return shards_[ankerl::unordered_dense::hash<std::uint64_t>{}(key) %
+                   SHARD_COUNT];
+  }
+
+  std::size_t max_memory_;
+  std::array<shard, SHARD_COUNT> shards_;
+  std::atomic<std::uint32_t> next_source_{0};
+  std::atomic<std::size_t> decoded_{0};
+};
+
+// Read access to a dem pack file. Tiles are decoded on demand and kept in
+// the (shared) tile cache.
+struct dem_pack {
+  dem_pack(std::string const& filename, dem_tile_cache& cache);
+  ~dem_pack();
+  dem_pack(dem_pack const&) = delete;
+  dem_pack& operator=(dem_pack const&) = delete;
+  dem_pack(dem_pack&&) = delete;
+  dem_pack& operator=(dem_pack&&) = delete;
+
+  std::size_t grid_count() const;
+  dem_bounds bounds(std::size_t grid_idx) const;
+  elevation_t get(std::size_t grid_idx, location const& loc) const;
+
+private:
+  struct impl;
+  std::unique_ptr<impl> impl_;
+};
+
+// Converts EHdr/BIL grids (files or directories) into a dem pack file.
+// Grids keep their order, i.e. the first grid with data for a location wins.
+void write_dem_pack(std::vector<std::string> const& input_files,
+                    std::string const& output_file, unsigned tile_size,
+                    std::ostream& log);
+
+}  // namespace ppr::preprocessing::elevation
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "ppr/common/elevation.h"
 #include "ppr/common/location.h"
@@ -10,7 +12,8 @@
 namespace ppr::preprocessing::elevation {
 
 struct dem_source {
-  dem_source();
+  // max_tile_cache_memory: upper bound for decoded dem pack tiles
+  explicit dem_source(std::size_t max_tile_cache_memory = 512 * 1024 * 1024);
   ~dem_source();
   dem_source(dem_source const&) = delete;
   dem_source& operator=(dem_source const&) = delete;
@@ -21,6 +24,10 @@ struct dem_source {
 
   elevation_t get(location const& loc) const;
 
+  // batched lookup: locations are grouped by DEM cells and queried in
+  // parallel, result[i] is the elevation at locs[i]
+  std::vector<elevation_t> get(std::vector<location> const& locs) const;
+
 private:
   struct impl;
   std::unique_ptr<impl> impl_;
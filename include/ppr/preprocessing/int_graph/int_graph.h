@@ -6,6 +6,7 @@
 #include "ppr/common/level.h"
 #include "ppr/common/routing_graph.h"
 
+#include "ppr/preprocessing/arena.h"
 #include "ppr/preprocessing/int_graph/int_area.h"
 #include "ppr/preprocessing/int_graph/int_edge.h"
 #include "ppr/preprocessing/int_graph/int_node.h"
@@ -18,35 +19,44 @@ namespace ppr::preprocessing {
 
 struct int_graph {
   void create_in_edges() {
-    for (auto const& node : nodes_) {
-      for (auto& edge : node->out_edges_) {
-        edge->to_->in_edges_.emplace_back(edge.get());
+    for (auto& node : nodes_) {
+      for (auto* edge : node.out_edges_) {
+        edge->to_->in_edges_.emplace_back(edge);
       }
     }
   }
 
   void count_edges() {
-    for (auto const& node : nodes_) {
-      for (auto const& edge : node->out_edges_) {
+    for (auto& node : nodes_) {
+      for (auto const* edge : node.out_edges_) {
         auto const type = edge->info(*this)->type_;
         if (type == edge_type::STREET) {
-          node->street_edges_++;
+          node.street_edges_++;
         } else if (type == edge_type::FOOTWAY || type == edge_type::CROSSING) {
-          node->footway_edges_++;
+          node.footway_edges_++;
         }
       }
-      for (auto const* edge : node->in_edges_) {
+      for (auto const* edge : node.in_edges_) {
         auto const type = edge->info(*this)->type_;
         if (type == edge_type::STREET) {
-          node->street_edges_++;
+          node.street_edges_++;
         } else if (type == edge_type::FOOTWAY || type == edge_type::CROSSING) {
-          node->footway_edges_++;
+          node.footway_edges_++;
         }
       }
     }
   }
 
-  std::vector<std::unique_ptr<int_node>> nodes_;
+  // creates a new edge and adds it to the out edges of its from node
+  template <typename... Args>
+  int_edge* add_edge(Args&&... args) {
+    auto& e = edges_.emplace_back(std::forward<Args>(args)...);
+    e.from_->out_edges_.emplace_back(&e);
+    return &e;
+  }
+
+  arena<int_node> nodes_;
+  arena<int_edge> edges_;
   data::vector_map<edge_info_idx_t, edge_info> edge_infos_;
   names_vector_t names_;
   names_map_t names_map_;
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
+
 #include "ppr/common/geometry/merc.h"
 #include "ppr/common/level.h"
 #include "ppr/common/routing_graph.h"
@@ -9,6 +12,9 @@ namespace ppr::preprocessing {
 struct int_edge;
 struct int_area_point;
 
+constexpr auto const NO_JUNCTION_ROUND =
+    std::numeric_limits<std::uint32_t>::max();
+
 struct int_node {
   int_node(std::int64_t osm_id, merc const& loc, crossing_type const crossing)
       : osm_id_(osm_id), location_(loc), crossing_(crossing) {}
@@ -18,12 +24,6 @@ struct int_node {
                     end(in_edges_));
   }
 
-  template <typename... Args>
-  void emplace_out_edge(Args&&... args) {
-    out_edges_.emplace_back(
-        std::make_unique<int_edge>(std::forward<Args>(args)...));
-  }
-
   inline bool is_special_node() const {
     return elevator_ || entrance_ || cycle_barrier_;
   }
@@ -51,8 +51,9 @@ struct int_node {
   edge_info_idx_t crossing_edge_info_{NO_EDGE_INFO};
 
   node* rg_foot_node_{};
+  std::uint32_t junction_round_{NO_JUNCTION_ROUND};
 
-  std::vector<std::unique_ptr<int_edge>> out_edges_;
+  std::vector<int_edge*> out_edges_;  // owned by int_graph::edges_
   std::vector<int_edge*> in_edges_;
 };
 
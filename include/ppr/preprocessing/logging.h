@@ -13,7 +13,12 @@
 namespace ppr::preprocessing {
 
 enum class pp_step {
+  UPDATE_CHANGES,
+  UPDATE_REGION,
+  PARTITION_SCAN,
+  OSM_EXTRACT_REGION,
   OSM_EXTRACT_RELATIONS,
+  OSM_EXTRACT_WAY_NODES,
   OSM_EXTRACT_MAIN,
   OSM_EXTRACT_AREAS,
   OSM_DEM,
@@ -26,9 +31,12 @@ enum class pp_step {
   RG_EDGES,
   RG_AREAS,
   RG_CROSSING_DETOURS,
+  UPDATE_SPLICE,
+  UPDATE_CROSSING_DETOURS,
+  PARTITION_MERGE,
   POST_GRAPH_VERIFICATION,
-  POST_SERIALIZATION,
-  POST_RTREES
+  POST_RTREES,
+  POST_SERIALIZATION
 };
 
 struct step_progress_data {
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
 
 namespace ppr::preprocessing {
 
+struct update_region;
+
 struct options {
   std::string osm_file_;
   std::vector<std::string> dem_files_;
@@ -13,13 +17,29 @@ struct options {
   std::string graph_file_;
 
   double elevation_sampling_interval_{30};  // meters
+  std::size_t dem_tile_cache_size_{512 * 1024 * 1024};  // bytes
   double crossing_detours_limit_{600};  // meters
 
   bool print_warnings_{true};
   bool move_crossings_{false};
-  bool create_rtrees_{true};
-  std::size_t edge_rtree_max_size_{1024UL * 1024 * 1024 * 3};
-  std::size_t area_rtree_max_size_{1024UL * 1024 * 1024};
+
+  // incremental update: existing graph + osm change file (osm_file_ is the
+  // updated osm data)
+  std::string base_graph_file_;
+  std::string changes_file_;
+  double update_halo_{1000};  // meters
+
+  // partitioned preprocessing (partition_size_ = cell size in degrees,
+  // 0 = disabled), see partition/partitions.h
+  double partition_size_{0};
+  double partition_halo_{2000};  // meters
+  unsigned partition_jobs_{1};  // partitions built concurrently
+  std::vector<std::string> partitions_;  // only build these ("col_row")
+  std::vector<std::string> partition_files_;  // only merge these
+  bool keep_partition_files_{false};
+
+  // set during incremental updates: only this region is extracted
+  std::shared_ptr<update_region const> extract_region_;
 };
 
 }  // namespace ppr::preprocessing
@@ -1,11 +1,24 @@
 #pragma once
 
+#include <cstdint>
+
+#include "cista/containers/vector.h"
+
 #include "osmium/osm/tag.hpp"
 
 #include "ppr/common/level.h"
 
 namespace ppr::preprocessing::osm {
 
+// returns the index of the given list of levels in levels_vec, the list is
+// added if it doesn't exist yet
+levels get_multiple_levels(cista::raw::vector<std::int16_t> const& lvls,
+                           levels_vector_t& levels_vec);
+
+// returns lvl (from levels_vec from) for use with levels_vec to
+levels copy_levels(levels const& lvl, levels_vector_t const& from,
+                   levels_vector_t& to);
+
 levels get_levels(char const* level_tag, levels_vector_t& levels_vec);
 levels get_levels(osmium::TagList const& tags, levels_vector_t& levels_vec);
 
@@ -8,6 +8,10 @@
 
 namespace ppr::preprocessing {
 
-osm_graph extract(std::string const& osm_file, logging& log, statistics& stats);
+struct update_region;
+
+// region: if set, only objects in the region are extracted
+osm_graph extract(std::string const& osm_file, logging& log, statistics& stats,
+                  update_region const* region = nullptr);
 
 }  // namespace ppr::preprocessing
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+
+#include "osmium/index/detail/mmap_vector_anon.hpp"
+#include "osmium/index/map.hpp"
+#include "osmium/osm/location.hpp"
+#include "osmium/osm/types.hpp"
+
+namespace ppr::preprocessing {
+
+using node_id_set =
+    osmium::detail::mmap_vector_anon<osmium::unsigned_object_id_type>;
+
+// sorts the collected node ids and removes duplicates
+void finish_node_id_set(node_id_set& ids);
+
+// Node location index for a fixed set of node ids (the nodes referenced by
+// relevant ways). Ids and locations are stored in two dense, anonymous
+// memory mapped arrays, locations for all other nodes are discarded.
+// set() is linear for ascending ids (the usual order in .osm.pbf files).
+class node_location_index
+    : public osmium::index::map::Map<osmium::unsigned_object_id_type,
+                                     osmium::Location> {
+public:
+  explicit node_location_index(node_id_set&& ids);
+
+  void set(osmium::unsigned_object_id_type id,
+           osmium::Location value) final;
+
+  osmium::Location get(osmium::unsigned_object_id_type id) const final;
+
+  osmium::Location get_noexcept(
+      osmium::unsigned_object_id_type id) const noexcept final;
+
+  std::size_t size() const final;
+  std::size_t used_memory() const final;
+  void clear() final;
+
+private:
+  node_id_set ids_;
+  osmium::detail::mmap_vector_anon<osmium::Location> locations_;
+  std::size_t cursor_{0};
+  osmium::unsigned_object_id_type last_id_{0};
+};
+
+}  // namespace ppr::preprocessing
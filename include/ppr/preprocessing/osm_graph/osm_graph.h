@@ -6,6 +6,7 @@
 #include "ppr/common/geometry/merc.h"
 #include "ppr/common/level.h"
 
+#include "ppr/preprocessing/arena.h"
 #include "ppr/preprocessing/names.h"
 #include "ppr/preprocessing/osm_graph/osm_area.h"
 #include "ppr/preprocessing/osm_graph/osm_edge.h"
@@ -25,8 +26,8 @@ struct osm_graph {
   }
 
   void create_in_edges() {
-    for (auto const& node : nodes_) {
-      for (auto& edge : node->out_edges_) {
+    for (auto& node : nodes_) {
+      for (auto& edge : node.out_edges_) {
         edge.to_->in_edges_.emplace_back(&edge);
       }
     }
@@ -34,26 +35,26 @@ struct osm_graph {
 
   void count_edges() {
     for (auto& node : nodes_) {
-      for (auto& edge : node->out_edges_) {
+      for (auto& edge : node.out_edges_) {
         auto const type = edge.info(*this)->type_;
         if (type == edge_type::STREET) {
-          node->street_edges_++;
+          node.street_edges_++;
         } else if (type == edge_type::FOOTWAY || type == edge_type::CROSSING) {
-          node->footway_edges_++;
+          node.footway_edges_++;
         }
       }
-      for (auto* edge : node->in_edges_) {
+      for (auto* edge : node.in_edges_) {
         auto const type = edge->info(*this)->type_;
         if (type == edge_type::STREET) {
-          node->street_edges_++;
+          node.street_edges_++;
         } else if (type == edge_type::FOOTWAY || type == edge_type::CROSSING) {
-          node->footway_edges_++;
+          node.footway_edges_++;
         }
       }
     }
   }
 
-  std::vector<std::unique_ptr<osm_node>> nodes_;
+  arena<osm_node> nodes_;
   data::vector_map<edge_info_idx_t, edge_info> edge_infos_;
   std::vector<std::unique_ptr<osm_area>> areas_;
   names_vector_t names_;
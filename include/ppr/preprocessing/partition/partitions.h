@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <compare>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ppr/common/location.h"
+#include "ppr/common/routing_graph.h"
+#include "ppr/preprocessing/logging.h"
+#include "ppr/preprocessing/options.h"
+#include "ppr/preprocessing/statistics.h"
+#include "ppr/preprocessing/update/update_region.h"
+
+namespace ppr::preprocessing {
+
+// Partitioned preprocessing: the input is split into square cells of
+// opt.partition_size_ degrees. Each cell is extracted with a halo and built
+// separately, the partition graphs are written to files and merged at the
+// cell boundaries afterwards.
+struct partition {
+  friend bool operator==(partition const&, partition const&) = default;
+  friend auto operator<=>(partition const&, partition const&) = default;
+
+  std::int32_t col_{};
+  std::int32_t row_{};
+};
+
+partition get_partition(options const& opt, location const& loc);
+
+// "col_row"
+std::string to_string(partition const& p);
+partition parse_partition(std::string const& str);
+
+// <graph file>.<col>_<row>.part
+std::string get_partition_file(options const& opt, partition const& p);
+partition get_partition_from_file(std::string const& filename);
+
+// core = all tiles of the cell, region = core + halo
+std::shared_ptr<update_region> get_partition_region(options const& opt,
+                                                    partition const& p);
+
+// opt.partitions_ or all cells containing nodes
+std::vector<partition> get_partitions(options const& opt, logging& log);
+
+// builds the given partitions and writes them to their partition files,
+// returns the file names
+std::vector<std::string> build_partitions(
+    options const& opt, std::vector<partition> const& partitions,
+    logging& log, statistics& stats);
+
+routing_graph merge_partitions(options const& opt,
+                               std::vector<std::string> const& files,
+                               logging& log, statistics& stats);
+
+// build_partitions + merge_partitions (for all partitions)
+routing_graph build_partitioned_routing_graph(options const& opt,
+                                              logging& log,
+                                              statistics& stats);
+
+}  // namespace ppr::preprocessing
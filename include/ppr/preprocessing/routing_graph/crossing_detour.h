@@ -1,15 +1,138 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
 #include "ppr/preprocessing/logging.h"
 #include "ppr/preprocessing/options.h"
 
 namespace ppr {
 
 struct routing_graph;
+struct routing_graph_data;
+struct node;
+struct edge;
 
 namespace preprocessing {
 
+using detour_dist_t = std::pair<double, int>;  // distance, marked crossings
+
+// Search state that is reused by all searches of a thread: an open
+// addressing table for the node distances that is reset by incrementing
+// a timestamp, and the heap storage of the priority queue.
+struct detour_workspace {
+  struct entry {
+    node const* node_{};
+    std::uint32_t stamp_{};
+    detour_dist_t dist_{};
+  };
+
+  using queue_entry = std::pair<detour_dist_t, node const*>;
+
+  // first_stamp must not be 0, other values than 1 are only useful to test
+  // the timestamp wrap-around
+  explicit detour_workspace(std::uint32_t const first_stamp = 1)
+      : stamp_{first_stamp} {}
+
+  void reset() {
+    if (++stamp_ == 0) {
+      for (auto& e : entries_) {
+        e.stamp_ = 0;
+      }
+      stamp_ = 1;
+    }
+    size_ = 0;
+    queue_.clear();
+  }
+
+  detour_dist_t const* find(node const* n) const {
+    for (auto i = slot(n);; i = (i + 1) & mask_) {
+      auto const& e = entries_[i];
+      if (e.stamp_ != stamp_) {
+        return nullptr;
+      } else if (e.node_ == n) {
+        return &e.dist_;
+      }
+    }
+  }
+
+  detour_dist_t& get(node const* n) {
+    if ((size_ + 1) * 2 > entries_.size()) {
+      grow();
+    }
+    for (auto i = slot(n);; i = (i + 1) & mask_) {
+      auto& e = entries_[i];
+      if (e.stamp_ != stamp_) {
+        e = {n, stamp_, {std::numeric_limits<double>::max(), 0}};
+        ++size_;
+        return e.dist_;
+      } else if (e.node_ == n) {
+        return e.dist_;
+      }
+    }
+  }
+
+  void push(detour_dist_t const& dist, node const* n) {
+    queue_.emplace_back(dist, n);
+    std::push_heap(begin(queue_), end(queue_), std::greater<>{});
+  }
+
+  queue_entry pop() {
+    std::pop_heap(begin(queue_), end(queue_), std::greater<>{});
+    auto const e = queue_.back();
+    queue_.pop_back();
+    return e;
+  }
+
+  bool empty() const { return queue_.empty(); }
+
+private:
+  std::size_t slot(node const* n) const {
+    auto h = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(n));
+    h ^= h >> 33U;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33U;
+    return static_cast<std::size_t>(h) & mask_;
+  }
+
+  void grow() {
+    auto old = std::move(entries_);
+    entries_ = std::vector<entry>(std::max(std::size_t{1024}, old.size() * 2));
+    mask_ = entries_.size() - 1;
+    size_ = 0;
+    for (auto const& e : old) {
+      if (e.stamp_ == stamp_) {
+        get(e.node_) = e.dist_;
+      }
+    }
+  }
+
+  std::vector<entry> entries_;
+  std::size_t mask_{};
+  std::size_t size_{};
+  std::uint32_t stamp_;
+  std::vector<queue_entry> queue_;
+};
+
+// Distance from the start to the end node of an unmarked crossing without
+// using unmarked crossings of the same or a bigger street type, if the
+// shortest such path uses a marked crossing (0 otherwise).
+double distance_with_marked_crossings(routing_graph_data const& rg,
+                                      edge const& crossing_edge,
+                                      double distance_limit,
+                                      detour_workspace& ws);
+
 void calc_crossing_detours(routing_graph&, options const&, logging&);
 
+// only for crossings starting at nodes for which filter(node) is true
+void calc_crossing_detours(routing_graph&, options const&, logging&,
+                           pp_step step,
+                           std::function<bool(node const&)> const& filter);
+
 }  // namespace preprocessing
 }  // namespace ppr
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "ppr/preprocessing/statistics.h"
+
+namespace ppr {
+
+struct routing_graph;
+
+namespace preprocessing {
+
+void create_rtrees(routing_graph&, rtree_statistics&);
+
+}  // namespace preprocessing
+}  // namespace ppr
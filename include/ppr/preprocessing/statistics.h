@@ -26,10 +26,19 @@ struct osm_graph_statistics {
   timing_t d_total_ = 0;
 
   struct {
+    timing_t d_region_pass_ = 0;  // only for region extracts
     timing_t d_relations_pass_ = 0;
+    timing_t d_way_nodes_pass_ = 0;
     timing_t d_main_pass_ = 0;
+    timing_t d_locations_ = 0;  // main pass: node location index
+    timing_t d_classify_ = 0;  // main pass: parallel tag classification
+    timing_t d_merge_ = 0;  // main pass: graph construction
     timing_t d_areas_ = 0;
     timing_t d_total_ = 0;
+
+    std::size_t n_region_ways_ = 0;  // ways touching the region
+    std::size_t n_way_nodes_ = 0;  // nodes in the location index
+    std::size_t location_index_size_ = 0;  // bytes
   } extract_;
 
   graph_statistics graph_;
@@ -103,6 +112,49 @@ struct routing_graph_statistics {
   std::size_t n_crossings_signals_ = 0;
 };
 
+struct rtree_statistics {
+  timing_t d_edge_entries_ = 0;
+  timing_t d_edge_rtree_ = 0;
+  timing_t d_area_entries_ = 0;
+  timing_t d_area_rtree_ = 0;
+  timing_t d_total_ = 0;
+
+  std::size_t n_edge_entries_ = 0;
+  std::size_t n_area_entries_ = 0;
+  std::size_t edge_rtree_size_ = 0;  // bytes
+  std::size_t area_rtree_size_ = 0;  // bytes
+};
+
+struct update_statistics {
+  timing_t d_changes_ = 0;
+  timing_t d_region_ = 0;
+  timing_t d_splice_ = 0;
+  timing_t d_crossing_detours_ = 0;
+
+  std::size_t n_changed_nodes_ = 0;
+  std::size_t n_changed_ways_ = 0;
+  std::size_t n_changed_relations_ = 0;
+  std::size_t n_core_tiles_ = 0;
+  std::size_t n_region_tiles_ = 0;
+  std::size_t n_base_nodes_ = 0;  // nodes kept from the existing graph
+  std::size_t n_update_nodes_ = 0;  // nodes taken from the rebuilt region
+  std::size_t n_base_areas_ = 0;
+  std::size_t n_update_areas_ = 0;
+  std::size_t n_unmatched_edges_ = 0;
+  std::size_t n_unmatched_area_nodes_ = 0;
+  std::size_t n_ambiguous_nodes_ = 0;
+};
+
+struct partition_statistics {
+  timing_t d_build_ = 0;
+  timing_t d_merge_ = 0;
+
+  std::size_t n_partitions_ = 0;
+  std::size_t n_unmatched_edges_ = 0;
+  std::size_t n_unmatched_area_nodes_ = 0;
+  std::size_t n_ambiguous_nodes_ = 0;
+};
+
 struct statistics {
   timing_t d_total_pp_ = 0;
   timing_t d_verification_ = 0;
@@ -116,6 +168,9 @@ struct statistics {
   elevation_statistics elevation_;
   int_graph_statistics int_;
   routing_graph_statistics routing_;
+  rtree_statistics rtrees_;
+  update_statistics update_;
+  partition_statistics partition_;
 };
 
 struct osm_graph;
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ankerl/unordered_dense.h"
+
+#include "ppr/common/location.h"
+#include "ppr/common/packed_rtree.h"
+
+namespace ppr::preprocessing {
+
+// Ids of all created, modified and deleted objects.
+struct osm_changes {
+  ankerl::unordered_dense::set<std::int64_t> nodes_;
+  // includes the member ways of changed relations
+  ankerl::unordered_dense::set<std::int64_t> ways_;
+  ankerl::unordered_dense::set<std::int64_t> relations_;
+  // old and new locations of changed nodes (if known)
+  std::vector<location> node_locations_;
+};
+
+// Reads an OSM change file (.osc or .osc.gz) or, for .pbf files, the
+// differences between this (old) file and the (new) osm_file.
+osm_changes read_osm_changes(std::string const& changes_file,
+                             std::string const& osm_file);
+
+// Bounding boxes of the changed ways in osm_file (the updated data).
+std::vector<packed_rtree_box> get_changed_way_boxes(
+    std::string const& osm_file, osm_changes const& changes);
+
+}  // namespace ppr::preprocessing
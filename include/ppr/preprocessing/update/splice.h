@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "ppr/common/routing_graph.h"
+#include "ppr/preprocessing/statistics.h"
+#include "ppr/preprocessing/update/update_region.h"
+
+namespace ppr::preprocessing {
+
+// One of the graphs combined by routing_graph_splicer.
+struct splice_input {
+  routing_graph_data const* rg_{};
+  // nodes and areas taken from this graph (each node and area should be
+  // taken from exactly one input)
+  std::function<bool(node const&)> take_node_;
+  std::function<bool(area const&)> take_area_;
+  // otherwise new ids are assigned
+  bool keep_node_ids_{false};
+
+  std::size_t n_nodes_{};
+  std::size_t n_areas_{};
+};
+
+struct splice_result {
+  routing_graph rg_;
+  std::size_t n_unmatched_edges_{};
+  std::size_t n_unmatched_area_nodes_{};
+  // references matching more than one node (counted as unmatched as well)
+  std::size_t n_ambiguous_nodes_{};
+};
+
+// Combines the selected nodes (with their out edges) and areas of several
+// graphs that are added one at a time, an input graph is no longer needed
+// after it has been added. Edges and area exit nodes pointing to nodes taken
+// from another input are connected by matching nodes with the same location
+// and osm id in finish(), unmatched edges are dropped (and counted). If
+// several nodes match, none of them is used.
+// In edges, r-trees and crossing detours are not created.
+struct routing_graph_splicer {
+  routing_graph_splicer();
+  ~routing_graph_splicer();
+  routing_graph_splicer(routing_graph_splicer const&) = delete;
+  routing_graph_splicer& operator=(routing_graph_splicer const&) = delete;
+
+  // inputs with keep_node_ids_ must be added before all other inputs
+  void add(splice_input& in);
+  splice_result finish();
+
+private:
+  struct impl;
+  std::unique_ptr<impl> impl_;
+};
+
+// routing_graph_splicer for inputs that are all in memory
+splice_result splice_routing_graphs(std::vector<splice_input>& inputs);
+
+// Combines the nodes and areas of base outside of the region core with the
+// nodes and areas of update (rebuilt for the region) inside of the core.
+routing_graph splice_routing_graph(routing_graph_data const& base,
+                                   routing_graph_data const& update,
+                                   update_region const& region,
+                                   update_statistics& stats);
+
+packed_rtree_box get_area_box(area const& a);
+
+}  // namespace ppr::preprocessing
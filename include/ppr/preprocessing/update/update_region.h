@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ankerl/unordered_dense.h"
+
+#include "ppr/common/location.h"
+#include "ppr/common/packed_rtree.h"
+
+namespace ppr::preprocessing {
+
+// Part of the graph affected by an incremental update, as a set of grid
+// tiles. The core contains all changed objects, the region additionally
+// contains a halo around the core. The region is extracted and rebuilt,
+// only the core of the rebuilt graph replaces the existing graph.
+struct update_region {
+  // tile edge length in fixed point units (0.01 degrees)
+  static constexpr auto const TILE_SIZE = std::int64_t{100000};
+
+  // (col << 32) | row
+  using tile_t = std::uint64_t;
+
+  static inline tile_t make_tile(std::int64_t const col,
+                                 std::int64_t const row) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(col))
+            << 32U) |
+           static_cast<std::uint32_t>(row);
+  }
+
+  static inline std::int32_t tile_col(tile_t const t) {
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(t >> 32U));
+  }
+
+  static inline std::int32_t tile_row(tile_t const t) {
+    return static_cast<std::int32_t>(static_cast<std::uint32_t>(t));
+  }
+
+  static tile_t tile(location const& loc);
+
+  void add(location const& loc);
+  void add(packed_rtree_box const& box);
+
+  // adds all tiles within halo meters of the core to the region
+  void expand(double halo);
+
+  bool in_core(location const& loc) const;
+  bool in_region(location const& loc) const;
+  bool intersects_core(packed_rtree_box const& box) const;
+  bool intersects_region(packed_rtree_box const& box) const;
+
+  inline bool empty() const { return core_.empty(); }
+  inline std::size_t core_size() const { return core_.size(); }
+  inline std::size_t region_size() const { return region_.size(); }
+
+  ankerl::unordered_dense::set<tile_t> core_;
+  ankerl::unordered_dense::set<tile_t> region_;  // core + halo
+};
+
+}  // namespace ppr::preprocessing
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "ppr/common/routing_graph.h"
+#include "ppr/preprocessing/logging.h"
+#include "ppr/preprocessing/options.h"
+#include "ppr/preprocessing/statistics.h"
+
+namespace ppr::preprocessing {
+
+// Updates the routing graph in opt.base_graph_file_ with the changes in
+// opt.changes_file_. opt.osm_file_ must contain the updated osm data.
+// Only the affected region (plus a halo) is extracted and rebuilt.
+// Throws std::runtime_error if the rebuilt region can't be connected to the
+// existing graph (a full rebuild is required in that case).
+routing_graph update_routing_graph(options const& opt, logging& log,
+                                   statistics& stats);
+
+}  // namespace ppr::preprocessing
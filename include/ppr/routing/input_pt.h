@@ -3,6 +3,7 @@
 #include "ppr/common/routing_graph.h"
 #include "ppr/routing/input_location.h"
 #include "ppr/routing/routing_options.h"
+#include "ppr/routing/statistics.h"
 
 namespace ppr::routing {
 
@@ -46,7 +47,8 @@ struct input_pt {
 std::vector<input_pt> resolve_input_location(routing_graph const& g,
                                              input_location const& il,
                                              routing_options const& opt,
-                                             bool expanded);
+                                             bool expanded,
+                                             routing_statistics& stats);
 
 bool has_nearest_edge(routing_graph const& g, input_location const& il,
                       routing_options const& opt, bool expanded);
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "ppr/common/data.h"
+#include "ppr/common/location.h"
+#include "ppr/common/math.h"
+
+namespace ppr::routing {
+
+// Equirectangular projection centered at the query location.
+// Within the few hundred meters considered for snapping, this matches a
+// local mercator projection (scaled to meters) and is linear in lon/lat,
+// so no trigonometry is required per point.
+struct local_projection {
+  explicit local_projection(location const& origin)
+      : origin_{origin},
+        scale_x_{to_rad(1.0) * AVG_EARTH_RADIUS *
+                 std::cos(to_rad(origin.lat())) / location::PRECISION},
+        scale_y_{to_rad(1.0) * AVG_EARTH_RADIUS / location::PRECISION} {}
+
+  inline double x(location const& loc) const {
+    return static_cast<double>(static_cast<std::int64_t>(loc.x()) -
+                               origin_.x()) *
+           scale_x_;
+  }
+
+  inline double y(location const& loc) const {
+    return static_cast<double>(static_cast<std::int64_t>(loc.y()) -
+                               origin_.y()) *
+           scale_y_;
+  }
+
+  location origin_;
+  double scale_x_;
+  double scale_y_;
+};
+
+struct segment_match {
+  // index of the nearest segment (from = path[segment_], to = segment_ + 1)
+  std::uint32_t segment_{0};
+  // position of the nearest point on the segment, 0 = from, 1 = to
+  double t_{0};
+  // squared distance in meters
+  double dist_sq_{std::numeric_limits<double>::max()};
+};
+
+// Computes the nearest point on a batch of paths to a single location.
+// Segments of all paths are stored as structure of arrays (in meters,
+// relative to the query location) and processed in SIMD batches.
+struct snapping_kernel {
+  explicit snapping_kernel(location const& loc) : proj_{loc} {}
+
+  template <typename Path>
+  std::size_t add_path(Path const& path) {
+    auto const path_idx = path_offsets_.size() - 1;
+    if (path.size() == 1) {
+      add_segment(path[0], path[0]);
+    } else {
+      for (auto i = 1U; i < path.size(); ++i) {
+        add_segment(path[i - 1], path[i]);
+      }
+    }
+    path_offsets_.push_back(static_cast<std::uint32_t>(from_x_.size()));
+    return path_idx;
+  }
+
+  template <typename Ring>
+  std::size_t add_ring(Ring const& ring) {
+    auto const path_idx = path_offsets_.size() - 1;
+    for (auto i = 1U; i < ring.size(); ++i) {
+      add_segment(ring[i - 1].location_, ring[i].location_);
+    }
+    path_offsets_.push_back(static_cast<std::uint32_t>(from_x_.size()));
+    return path_idx;
+  }
+
+  void reserve(std::size_t segment_count);
+
+  void compute();
+
+  segment_match nearest(std::size_t path_idx) const;
+  segment_match nearest() const;
+
+  std::size_t path_count() const { return path_offsets_.size() - 1; }
+  std::size_t segment_count() const { return from_x_.size(); }
+
+private:
+  void add_segment(location const& from, location const& to) {
+    auto const from_x = proj_.x(from);
+    auto const from_y = proj_.y(from);
+    from_x_.push_back(static_cast<float>(from_x));
+    from_y_.push_back(static_cast<float>(from_y));
+    dir_x_.push_back(static_cast<float>(proj_.x(to) - from_x));
+    dir_y_.push_back(static_cast<float>(proj_.y(to) - from_y));
+  }
+
+  segment_match nearest(std::uint32_t first, std::uint32_t last) const;
+
+  local_projection proj_;
+  std::vector<std::uint32_t> path_offsets_{0};
+  std::vector<float> from_x_, from_y_, dir_x_, dir_y_;
+  std::vector<float> t_, dist_sq_;
+};
+
+inline location interpolate(location const& from, location const& to,
+                            double const t) {
+  return make_location(
+      static_cast<std::int32_t>(std::lround(
+          from.x() + t * (static_cast<double>(to.x()) - from.x()))),
+      static_cast<std::int32_t>(std::lround(
+          from.y() + t * (static_cast<double>(to.y()) - from.y()))));
+}
+
+}  // namespace ppr::routing
@@ -36,6 +36,8 @@ struct routing_statistics {
   double d_destination_pts_extended_ = 0;
   double d_postprocessing_ = 0;
   double d_total_ = 0;
+  int snapping_cache_hits_ = 0;
+  int snapping_cache_misses_ = 0;
   std::vector<dijkstra_statistics> dijkstra_statistics_;
 };
 
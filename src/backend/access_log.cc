@@ -0,0 +1,134 @@
+#include "ppr/backend/access_log.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace ppr::backend {
+
+log_level parse_log_level(std::string_view const name) {
+  if (name == "off") {
+    return log_level::OFF;
+  } else if (name == "error") {
+    return log_level::ERRORS;
+  } else if (name == "info") {
+    return log_level::ALL;
+  } else if (name == "debug") {
+    return log_level::VERBOSE;
+  }
+  throw std::invalid_argument{"invalid log level: " + std::string{name} +
+                              " (expected off, error, info or debug)"};
+}
+
+access_log::access_log(std::string const& path, log_level const level,
+                       double const sample_rate, std::size_t const capacity)
+    : level_{level},
+      sample_rate_{sample_rate},
+      ring_{level == log_level::OFF ? 2 : capacity},
+      out_{&std::cout} {
+  if (level_ == log_level::OFF) {
+    return;
+  }
+  if (path != "-") {
+    file_.open(path, std::ios::app);
+    if (!file_) {
+      std::cerr << "Could not open access log " << path
+                << ", logging to stdout" << std::endl;
+    } else {
+      out_ = &file_;
+    }
+  }
+  writer_ = std::thread{[this]() { run(); }};
+}
+
+access_log::~access_log() {
+  stop_ = true;
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+}
+
+bool access_log::should_log(unsigned const status) {
+  if (status >= 400) {
+    return level_ != log_level::OFF;
+  }
+  return level_ >= log_level::ALL &&
+         (sample_rate_ >= 1.0 || sample_dist_(rng_) < sample_rate_);
+}
+
+void access_log::log(access_log_entry&& e) {
+  if (!should_log(e.status_)) {
+    return;
+  }
+  if (level_ != log_level::VERBOSE) {
+    e.server_timing_.clear();
+  }
+  if (!ring_.push(std::move(e))) {
+    ++dropped_;
+  }
+}
+
+void access_log::run() {
+  auto done = false;
+  while (!done) {
+    done = stop_;  // drain once more after stop
+    auto written = false;
+    while (auto e = ring_.pop()) {
+      write(*e);
+      written = true;
+    }
+    if (written) {
+      out_->flush();
+    } else if (!done) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+  }
+}
+
+void access_log::write(access_log_entry const& e) {
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> w(sb);
+  auto const str = [&](char const* key, std::string const& val) {
+    w.Key(key);
+    w.String(val.data(), static_cast<rapidjson::SizeType>(val.size()));
+  };
+
+  w.StartObject();
+  w.Key("ts");
+  w.Int64(e.timestamp_);
+  str("method", e.method_);
+  str("target", e.target_);
+  w.Key("status");
+  w.Uint(e.status_);
+  w.Key("bytes");
+  w.Uint64(e.response_size_);
+  w.Key("dur");
+  w.Double(e.d_total_);
+  w.Key("queue");
+  w.Double(e.d_queue_);
+  if (e.route_) {
+    w.Key("cached");
+    w.Bool(e.cached_);
+    if (!e.cached_) {
+      w.Key("routing");
+      w.Double(e.d_routing_);
+      w.Key("enc");
+      w.Double(e.d_encoding_);
+      w.Key("labels_created");
+      w.Uint64(e.labels_created_);
+      w.Key("labels_popped");
+      w.Uint64(e.labels_popped_);
+    }
+  }
+  if (!e.server_timing_.empty()) {
+    str("timing", e.server_timing_);
+  }
+  w.EndObject();
+
+  *out_ << sb.GetString() << '\n';
+}
+
+}  // namespace ppr::backend
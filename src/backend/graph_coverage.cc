@@ -0,0 +1,75 @@
+#include "ppr/backend/graph_coverage.h"
+
+#include <vector>
+
+namespace ppr::backend {
+
+namespace {
+
+inline std::int64_t floor_div(std::int64_t const a, std::int64_t const b) {
+  auto const q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+inline std::uint64_t make_cell(std::int64_t const col, std::int64_t const row) {
+  return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(col)) << 32U) |
+         static_cast<std::uint32_t>(row);
+}
+
+inline std::int32_t cell_col(std::uint64_t const cell) {
+  return static_cast<std::int32_t>(static_cast<std::uint32_t>(cell >> 32U));
+}
+
+inline std::int32_t cell_row(std::uint64_t const cell) {
+  return static_cast<std::int32_t>(static_cast<std::uint32_t>(cell));
+}
+
+}  // namespace
+
+std::uint64_t graph_coverage::cell(location const& loc) {
+  return make_cell(floor_div(loc.x(), CELL_SIZE),
+                   floor_div(loc.y(), CELL_SIZE));
+}
+
+void graph_coverage::add(location const& loc) {
+  cells_.insert(cell(loc));
+  box_.extend(loc);
+}
+
+void graph_coverage::grow() {
+  auto const core = std::vector<std::uint64_t>(begin(cells_), end(cells_));
+  for (auto const c : core) {
+    auto const col = cell_col(c);
+    auto const row = cell_row(c);
+    for (auto dc = -1; dc <= 1; ++dc) {
+      for (auto dr = -1; dr <= 1; ++dr) {
+        cells_.insert(make_cell(col + dc, row + dr));
+      }
+    }
+  }
+  box_ = {};
+  for (auto const c : cells_) {
+    box_.extend(packed_rtree_box{cell_col(c) * CELL_SIZE,
+                                 cell_row(c) * CELL_SIZE,
+                                 (cell_col(c) + 1) * CELL_SIZE - 1,
+                                 (cell_row(c) + 1) * CELL_SIZE - 1});
+  }
+}
+
+bool graph_coverage::contains(location const& loc) const {
+  return box_.intersects(make_packed_rtree_box(loc)) &&
+         cells_.find(cell(loc)) != end(cells_);
+}
+
+graph_coverage get_graph_coverage(routing_graph const& rg) {
+  auto coverage = graph_coverage{};
+  for (auto const& n : rg.data_->nodes_) {
+    if (n->location_.valid()) {
+      coverage.add(n->location_);
+    }
+  }
+  coverage.grow();
+  return coverage;
+}
+
+}  // namespace ppr::backend
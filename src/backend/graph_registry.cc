@@ -0,0 +1,67 @@
+#include "ppr/backend/graph_registry.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "boost/filesystem.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace ppr::backend {
+
+graph_options parse_graph_arg(std::string const& arg) {
+  auto opt = graph_options{};
+  auto const sep = arg.find('=');
+  if (sep != std::string::npos) {
+    opt.name_ = arg.substr(0, sep);
+    opt.graph_file_ = arg.substr(sep + 1);
+  } else {
+    opt.graph_file_ = arg;
+    opt.name_ = fs::path{arg}.stem().string();
+  }
+  if (opt.name_.empty() || opt.graph_file_.empty()) {
+    throw std::runtime_error{"invalid graph: " + arg};
+  }
+  return opt;
+}
+
+graph_store& graph_registry::add(std::unique_ptr<graph_store> store) {
+  if (get(store->name()) != nullptr) {
+    throw std::runtime_error{"duplicate graph name: " + store->name()};
+  }
+  return *graphs_.emplace_back(std::move(store));
+}
+
+graph_store* graph_registry::get(std::string_view const name) const {
+  auto const it =
+      std::find_if(begin(graphs_), end(graphs_),
+                   [&](auto const& g) { return g->name() == name; });
+  return it != end(graphs_) ? it->get() : nullptr;
+}
+
+graph_store* graph_registry::find(
+    std::vector<location> const& locations) const {
+  if (graphs_.size() == 1) {
+    return graphs_.front().get();
+  }
+  auto best = static_cast<graph_store*>(nullptr);
+  auto best_size = std::numeric_limits<std::size_t>::max();
+  for (auto const& g : graphs_) {
+    auto const coverage = g->coverage();
+    if (!coverage || locations.empty() || coverage->size() >= best_size) {
+      continue;
+    }
+    if (std::all_of(begin(locations), end(locations),
+                    [&](location const& loc) {
+                      return coverage->contains(loc);
+                    })) {
+      best = g.get();
+      best_size = coverage->size();
+    }
+  }
+  return best;
+}
+
+}  // namespace ppr::backend
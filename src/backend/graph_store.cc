@@ -0,0 +1,180 @@
+#include "ppr/backend/graph_store.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "boost/filesystem.hpp"
+
+#include "ppr/common/timing.h"
+#include "ppr/common/verify.h"
+#include "ppr/serialization/reader.h"
+
+namespace fs = boost::filesystem;
+
+namespace ppr::backend {
+
+std::shared_ptr<routing_graph const> load_graph(graph_options const& opt,
+                                                std::ostream& out) {
+  if (!fs::exists(opt.graph_file_)) {
+    throw std::runtime_error{"file not found: " + opt.graph_file_};
+  }
+
+  out << "Loading routing graph " << opt.graph_file_ << "..." << std::endl;
+  auto const t_deserialize_start = timing_now();
+  auto rg = std::make_shared<routing_graph>();
+  serialization::read_routing_graph(*rg, opt.graph_file_);
+  out << "Deserialization: " << ms_since(t_deserialize_start) << "ms"
+      << std::endl;
+
+  out << "Routing graph: " << rg->data_->nodes_.size() << " nodes, "
+      << rg->data_->areas_.size() << " areas" << std::endl;
+
+  out << "Preparing indices..." << std::endl;
+  auto const t_rtrees_start = timing_now();
+  rg->prepare_for_routing(opt.rtree_opt_);
+  if (opt.snapping_cache_) {
+    enable_snapping_cache(*rg, opt.snapping_cache_config_);
+  }
+  out << "Indices: " << ms_since(t_rtrees_start) << "ms" << std::endl;
+
+  if (opt.verify_) {
+    out << "Verifying routing graph file..." << std::endl;
+    if (!verify_graph(*rg, out)) {
+      throw std::runtime_error{"routing graph file is invalid"};
+    }
+    out << "Routing graph file appears to be valid." << std::endl;
+  }
+
+  return rg;
+}
+
+graph_store::graph_store(graph_options opt, std::ostream& out)
+    : opt_{std::move(opt)}, out_{out} {
+  auto const file = get_file_state();
+  set_graph(load_graph(opt_, out_), file);
+}
+
+graph_store::graph_store(graph_options opt,
+                         std::shared_ptr<routing_graph const> graph,
+                         std::ostream& out)
+    : opt_{std::move(opt)}, out_{out} {
+  set_graph(std::move(graph), get_file_state());
+}
+
+graph_store::~graph_store() {
+  {
+    auto const lock = std::lock_guard{watch_mutex_};
+    stop_ = true;
+  }
+  watch_cv_.notify_all();
+  if (watch_thread_.joinable()) {
+    watch_thread_.join();
+  }
+  auto const lock = std::lock_guard{reload_mutex_};
+  if (reload_thread_.joinable()) {
+    reload_thread_.join();
+  }
+}
+
+std::shared_ptr<routing_graph const> graph_store::get() const {
+  auto const lock = std::lock_guard{graph_mutex_};
+  return graph_;
+}
+
+graph_store::snapshot graph_store::get_snapshot() const {
+  auto const lock = std::lock_guard{graph_mutex_};
+  return {graph_, version_, coverage_};
+}
+
+std::shared_ptr<graph_coverage const> graph_store::coverage() const {
+  auto const lock = std::lock_guard{graph_mutex_};
+  return coverage_;
+}
+
+std::uintmax_t graph_store::file_size() const {
+  auto const lock = std::lock_guard{graph_mutex_};
+  return loaded_file_.size_;
+}
+
+void graph_store::set_graph(std::shared_ptr<routing_graph const> graph,
+                            file_state const& file) {
+  auto coverage = std::shared_ptr<graph_coverage const>{};
+  if (opt_.coverage_) {
+    coverage =
+        std::make_shared<graph_coverage const>(get_graph_coverage(*graph));
+  }
+  auto old = std::shared_ptr<routing_graph const>{};
+  {
+    auto const lock = std::lock_guard{graph_mutex_};
+    old = std::exchange(graph_, std::move(graph));
+    coverage_ = std::move(coverage);
+    loaded_file_ = file;
+    ++version_;
+  }
+  // the old graph is released here unless requests still use it
+}
+
+bool graph_store::reload() {
+  auto const lock = std::lock_guard{reload_mutex_};
+  if (reloading_.exchange(true)) {
+    return false;
+  }
+  if (reload_thread_.joinable()) {
+    reload_thread_.join();  // previous reload, already finished
+  }
+  reload_thread_ = std::thread{[this]() { run_reload(); }};
+  return true;
+}
+
+void graph_store::run_reload() {
+  try {
+    auto const file = get_file_state();
+    set_graph(load_graph(opt_, out_), file);
+    out_ << "Routing graph " << opt_.name_ << " reloaded (version "
+         << version_ << ")" << std::endl;
+  } catch (std::exception const& e) {
+    out_ << "Routing graph reload failed: " << e.what() << std::endl;
+  }
+  reloading_ = false;
+}
+
+graph_store::file_state graph_store::get_file_state() const {
+  auto ec = boost::system::error_code{};
+  auto const modified = fs::last_write_time(opt_.graph_file_, ec);
+  if (ec) {
+    return {};
+  }
+  auto const size = fs::file_size(opt_.graph_file_, ec);
+  return {static_cast<std::int64_t>(modified), ec ? 0 : size};
+}
+
+void graph_store::watch(std::chrono::seconds const interval) {
+  if (watch_thread_.joinable() || interval.count() <= 0) {
+    return;
+  }
+  out_ << "Watching " << opt_.graph_file_ << " for changes (every "
+       << interval.count() << "s)" << std::endl;
+  watch_thread_ = std::thread{[this, interval]() { run_watch(interval); }};
+}
+
+void graph_store::run_watch(std::chrono::seconds const interval) {
+  auto previous = file_state{};
+  auto attempted = file_state{};  // failed reloads are not retried
+  auto lock = std::unique_lock{watch_mutex_};
+  while (!watch_cv_.wait_for(lock, interval, [&]() { return stop_; })) {
+    auto const current = get_file_state();
+    auto const loaded = [&]() {
+      auto const graph_lock = std::lock_guard{graph_mutex_};
+      return loaded_file_;
+    }();
+    // wait until the file is no longer being written
+    if (current != file_state{} && current != loaded &&
+        current != attempted && current == previous && reload()) {
+      attempted = current;
+    }
+    previous = current;
+  }
+}
+
+}  // namespace ppr::backend
@@ -1,5 +1,13 @@
 #include "ppr/backend/http_server.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <variant>
+#include <vector>
+
 #include "boost/algorithm/string.hpp"
 #include "boost/asio/post.hpp"
 #include "boost/beast/version.hpp"
@@ -8,16 +16,27 @@
 
 #include "fmt/core.h"
 
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
 #include "utl/enumerate.h"
 
 #include "net/web_server/responses.h"
 #include "net/web_server/serve_static.h"
 #include "net/web_server/web_server.h"
 
+#include "ppr/backend/access_log.h"
+#include "ppr/backend/metrics.h"
 #include "ppr/backend/output/graph_response.h"
 #include "ppr/backend/output/route_response.h"
+#include "ppr/backend/request_coalescer.h"
 #include "ppr/backend/request_parser.h"
+#include "ppr/backend/request_scheduler.h"
 #include "ppr/backend/requests.h"
+#include "ppr/backend/route_batch.h"
+#include "ppr/backend/route_cache.h"
+#include "ppr/backend/route_key.h"
+#include "ppr/common/memory_usage.h"
 #include "ppr/common/timing.h"
 #include "ppr/profiles/json.h"
 #include "ppr/routing/search.h"
@@ -29,7 +48,6 @@ using namespace net;
 using net::web_server;
 
 namespace http = boost::beast::http;
-namespace bgi = boost::geometry::index;
 namespace fs = boost::filesystem;
 
 namespace ppr::backend {
@@ -44,10 +62,16 @@ void set_cors_headers(http::response<Body>& res) {
   res.set(field::access_control_max_age, "3600");
 }
 
+// the content is moved into the body (responses can be megabytes)
 web_server::string_res_t json_response(
-    web_server::http_req_t const& req, std::string const& content,
+    web_server::http_req_t const& req, std::string content,
     http::status const status = http::status::ok) {
-  auto res = net::string_response(req, content, status, "application/json");
+  auto res = web_server::string_res_t{status, req.version()};
+  res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+  res.set(http::field::content_type, "application/json");
+  res.keep_alive(req.keep_alive());
+  res.body() = std::move(content);
+  res.prepare_payload();
   set_cors_headers(res);
   return res;
 }
@@ -61,13 +85,25 @@ rapidjson::Document parse_json(std::string const& s) {
   return doc;
 }
 
-route_request parse_route_request(web_server::http_req_t const& req) {
+std::string json_error(std::string const& msg) {
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  writer.StartObject();
+  writer.String("error");
+  writer.String(msg.data(), static_cast<rapidjson::SizeType>(msg.size()));
+  writer.EndObject();
+  return sb.GetString();
+}
+
+route_request parse_route_request(rapidjson::Value const& doc,
+                                  profile_registry& profiles) {
   route_request r{};
-  auto doc = parse_json(req.body());
+  r.profile_ = profiles.default_profile();
 
   get_input_location(r.start_, doc, "start");
   get_input_location(r.destination_, doc, "destination");
-  get_profile(r.profile_, doc, "profile");
+  get_profile(r.profile_, profiles, doc, "profile");
+  get_string(r.graph_, doc, "graph");
 
   get_bool(r.options_.force_level_match_, doc, "force_level_match");
   get_bool(r.options_.allow_match_with_no_level_, doc,
@@ -85,28 +121,46 @@ route_request parse_route_request(web_server::http_req_t const& req) {
   get_bool(r.include_steps_path_, doc, "include_steps_path");
   get_bool(r.include_edges_, doc, "include_edges");
   get_bool(r.include_statistics_, doc, "include_statistics");
+  get_bool(r.pretty_, doc, "pretty");
 
   return r;
 }
 
+route_request parse_route_request(web_server::http_req_t const& req,
+                                  profile_registry& profiles) {
+  auto const doc = parse_json(req.body());
+  return parse_route_request(doc, profiles);
+}
+
 graph_request parse_graph_request(web_server::http_req_t const& req) {
   graph_request r{};
   auto doc = parse_json(req.body());
   get_waypoints(r.waypoints_, doc, "waypoints");
+  get_string(r.graph_, doc, "graph");
   get_bool(r.include_areas_, doc, "include_areas");
   get_bool(r.include_visibility_graphs_, doc, "include_visibility_graphs");
+  get_bool(r.pretty_, doc, "pretty");
   return r;
 }
 
 struct http_server::impl {
   impl(boost::asio::io_context& ios, boost::asio::io_context& thread_pool,
-       boost::asio::ssl::context& ssl_ctx, routing_graph const& g,
-       std::string const& static_file_path)
+       boost::asio::ssl::context& ssl_ctx, graph_registry& graphs,
+       server_settings const& settings)
       : ioc_(ios),
-        thread_pool_(thread_pool),
         ssl_ctx_(ssl_ctx),
-        graph_(g),
+        graphs_(graphs),
+        admin_token_(settings.admin_token_),
+        max_batch_size_(settings.max_batch_size_),
+        batch_window_(static_cast<std::size_t>(
+            std::max(1, settings.num_threads_))),
+        route_cache_(settings.route_cache_size_),
+        scheduler_(thread_pool, settings.max_queued_requests_,
+                   settings.queue_timeout_),
+        access_log_(settings.access_log_path_, settings.access_log_level_,
+                    settings.access_log_sample_rate_),
         server_(ioc_, ssl_ctx_) {
+    auto const& static_file_path = settings.static_file_path_;
     try {
       if (!static_file_path.empty() && fs::is_directory(static_file_path)) {
         static_file_path_ = fs::canonical(static_file_path).string();
@@ -115,6 +169,16 @@ struct http_server::impl {
     } catch (fs::filesystem_error const& e) {
       std::cerr << "Static file directory not found: " << e.what() << std::endl;
     }
+    if (!settings.profile_path_.empty()) {
+      try {
+        auto const n =
+            profiles_.load_directory(settings.profile_path_, std::cout);
+        std::cout << "Loaded " << n << " profiles from "
+                  << settings.profile_path_ << std::endl;
+      } catch (fs::filesystem_error const& e) {
+        std::cerr << "Profile directory not found: " << e.what() << std::endl;
+      }
+    }
     if (serve_static_files_) {
       std::cout << "Serving static files from " << static_file_path_
                 << std::endl;
@@ -123,33 +187,172 @@ struct http_server::impl {
     }
   }
 
-  void handle_route(web_server::http_req_t const& req,
-                    web_server::http_res_cb_t const& cb) {
-    auto const r = parse_route_request(req);
+  graph_store* find_graph(std::string const& name,
+                          std::vector<location> const& locations) const {
+    return name.empty() ? graphs_.find(locations) : graphs_.get(name);
+  }
+
+  graph_store* find_route_graph(route_request const& r) const {
+    auto locations = std::vector<location>{};
+    for (auto const& il : {r.start_, r.destination_}) {
+      if (il.location_) {
+        locations.emplace_back(*il.location_);
+      }
+    }
+    return find_graph(r.graph_, locations);
+  }
+
+  using log_entry_ptr = std::shared_ptr<access_log_entry>;
+
+  struct route_result {
+    http::status status_{http::status::ok};
+    std::string content_;
+    routing_statistics stats_{};
+    double d_encoding_{};
+    bool cached_{false};
+  };
+
+  // Calls done with the result, either directly or - if an identical
+  // request is already running - once that request has finished.
+  void compute_route(route_request const& r,
+                     request_coalescer<route_result>::callback_t done,
+                     bool const check_cache = true) {
+    auto const bad_request = [&](char const* msg) {
+      done({.status_ = http::status::bad_request, .content_ = json_error(msg)});
+    };
     if (!r.start_.valid() || !r.destination_.valid()) {
-      return cb(json_response(
-          req, R"({"error": "Missing or invalid start/destination locations"})",
-          http::status::bad_request));
+      return bad_request("Missing or invalid start/destination locations");
+    }
+    if (!r.profile_) {
+      return bad_request("Unknown profile");
     }
 
-    auto const rq =
-        ppr::routing::routing_query{.start_ = r.start_,
-                                    .destinations_ = {r.destination_},
-                                    .profile_ = r.profile_,
-                                    .opt_ = r.options_};
-    auto const result = find_routes_v2(graph_, rq);
-    auto const& stats = result.stats_;
+    auto const* store = find_route_graph(r);
+    if (store == nullptr) {
+      return bad_request("No routing graph covers start and destination");
+    }
+    // keeps the graph alive if it is replaced during the request
+    auto const [graph, version, coverage] = store->get_snapshot();
+
+    auto key = make_route_key(store->name(), version, r);
+    if (check_cache && route_cache_.enabled()) {
+      if (auto cached = route_cache_.get(key); cached.has_value()) {
+        return done({.content_ = std::move(*cached), .cached_ = true});
+      }
+    }
+    if (!in_flight_.join(key, std::move(done))) {
+      return;  // attached to a running identical request
+    }
+
+    auto result = route_result{};
+    try {
+      auto const rq =
+          ppr::routing::routing_query{.start_ = r.start_,
+                                      .destinations_ = {r.destination_},
+                                      .profile_ = *r.profile_,
+                                      .opt_ = r.options_};
+      auto const search_result = find_routes_v2(*graph, rq);
+
+      auto const t_before_encoding = timing_now();
+      result.content_ =
+          routes_to_route_response(*graph->data_, search_result, r);
+      result.stats_ = search_result.stats_;
+      result.d_encoding_ = ms_since(t_before_encoding);
+      route_metrics_.record(result.stats_, result.d_encoding_);
+      if (route_cache_.enabled()) {
+        route_cache_.put(key, result.content_, r.profile_);
+      }
+    } catch (std::exception const& e) {
+      result = {.status_ = http::status::internal_server_error,
+                .content_ = json_error(e.what())};
+    }
+    in_flight_.finish(key, std::move(result));
+  }
+
+  void handle_route(web_server::http_req_t const& req,
+                    route_request const& r, bool const check_cache,
+                    web_server::http_res_cb_t const& cb,
+                    log_entry_ptr const& entry) {
+    compute_route(
+        r,
+        [req, cb, entry](route_result&& result) {
+          set_route_log(*entry, result);
+          auto res =
+              json_response(req, std::move(result.content_), result.status_);
+          if (result.status_ == http::status::ok) {
+            res.set("Server-Timing", get_server_timing(result));
+          }
+          cb(res);
+        },
+        check_cache);
+  }
+
+  // Cached routes are answered directly on the io thread, all others are
+  // queued for the routing thread pool.
+  void schedule_route(web_server::http_req_t const& req,
+                      web_server::http_res_cb_t const& cb,
+                      log_entry_ptr const& entry) {
+    entry->route_ = true;
+    if (!route_cache_.enabled()) {
+      return run_parallel(
+          request_priority::NORMAL,
+          [this, entry](web_server::http_req_t const& req1,
+                        web_server::http_res_cb_t const& cb1) {
+            handle_route(req1, parse_route_request(req1, profiles_), true,
+                         cb1, entry);
+          },
+          req, cb, entry);
+    }
+
+    auto r = std::shared_ptr<route_request const>{};
+    try {
+      r = std::make_shared<route_request const>(
+          parse_route_request(req, profiles_));
+    } catch (std::exception const& e) {
+      return cb(json_response(req, json_error(e.what()),
+                              http::status::bad_request));
+    }
+    if (auto const* store = find_route_graph(*r);
+        store != nullptr && r->profile_) {
+      auto cached =
+          route_cache_.get(make_route_key(store->name(), store->version(), *r));
+      if (cached.has_value()) {
+        auto res = json_response(req, std::move(*cached));
+        res.set("Server-Timing", "cache;desc=hit");
+        entry->cached_ = true;
+        return cb(res);
+      }
+    }
+    run_parallel(
+        request_priority::NORMAL,
+        [this, r, entry](web_server::http_req_t const& req1,
+                         web_server::http_res_cb_t const& cb1) {
+          handle_route(req1, *r, false, cb1, entry);
+        },
+        req, cb, entry);
+  }
 
-    auto const t_before_encoding = timing_now();
-    auto res =
-        json_response(req, routes_to_route_response(*graph_.data_, result, r));
-    auto const d_encoding = ms_since(t_before_encoding);
+  static void set_route_log(access_log_entry& entry,
+                            route_result const& result) {
+    entry.cached_ = result.cached_;
+    entry.d_routing_ = result.stats_.d_total_;
+    entry.d_encoding_ = result.d_encoding_;
+    for (auto const& ds : result.stats_.dijkstra_statistics_) {
+      entry.labels_created_ += ds.labels_created_;
+      entry.labels_popped_ += ds.labels_popped_;
+    }
+  }
 
-    // https://web.dev/custom-metrics/#server-timing-api
-    // https://w3c.github.io/server-timing/
+  // https://web.dev/custom-metrics/#server-timing-api
+  // https://w3c.github.io/server-timing/
+  static std::string get_server_timing(route_result const& result) {
+    if (result.cached_) {
+      return "cache;desc=hit";
+    }
+    auto const& stats = result.stats_;
     auto server_timing = fmt::format(
         "total;dur={}, enc;dur={}, start;dur={}, dest;dur={}", stats.d_total_,
-        d_encoding, stats.d_start_pts_, stats.d_destination_pts_);
+        result.d_encoding_, stats.d_start_pts_, stats.d_destination_pts_);
     if (stats.start_pts_extended_ > 0) {
       server_timing +=
           fmt::format(", start_ext;dur={}", stats.d_start_pts_extended_);
@@ -162,9 +365,85 @@ struct http_server::impl {
       server_timing +=
           fmt::format(", dijkstra_{};dur={}", idx + 1, ds.d_total_);
     }
-    res.set("Server-Timing", server_timing);
+    return server_timing;
+  }
+
+  struct batch_state {
+    batch_state(rapidjson::Value const& items,
+                route_batch::parse_fn_t const& parse,
+                web_server::http_req_t req, web_server::http_res_cb_t cb)
+        : batch_{items, parse}, req_{std::move(req)}, cb_{std::move(cb)} {}
+
+    route_batch batch_;
+    web_server::http_req_t req_;
+    web_server::http_res_cb_t cb_;
+  };
+
+  // Runs a JSON array of route requests in parallel on the routing thread
+  // pool. The response contains one entry per request, in request order:
+  // the normal route response or {"error": ...}.
+  void handle_route_batch(web_server::http_req_t const& req,
+                          web_server::http_res_cb_t const& cb) {
+    auto const doc = parse_json(req.body());
+    if (!doc.IsArray()) {
+      return cb(json_response(
+          req, R"({"error": "Expected an array of route requests"})",
+          http::status::bad_request));
+    }
+    if (doc.Size() > max_batch_size_) {
+      return cb(json_response(
+          req,
+          json_error(fmt::format("Too many requests in batch (max {})",
+                                 max_batch_size_)),
+          http::status::payload_too_large));
+    }
 
-    return cb(res);
+    auto const b = std::make_shared<batch_state>(
+        doc,
+        [this](rapidjson::Value const& item) {
+          return parse_route_request(item, profiles_);
+        },
+        req, cb);
+    if (b->batch_.done()) {  // empty or only invalid requests
+      return cb(json_response(req, b->batch_.response()));
+    }
+
+    // the batch has passed the queue limit as a whole, its items are queued
+    // without limit but only batch_window_ at a time, so that a large batch
+    // neither fills the queue nor delays other requests for long
+    for (auto i = std::size_t{0}; i < batch_window_; ++i) {
+      if (!schedule_batch_item(b)) {
+        break;
+      }
+    }
+  }
+
+  // queues the next request of the batch, returns false if there is none
+  bool schedule_batch_item(std::shared_ptr<batch_state> const& b) {
+    auto const i = b->batch_.next();
+    if (i == b->batch_.size()) {
+      return false;
+    }
+    scheduler_.post(
+        request_priority::NORMAL,
+        [this, b, i](request_scheduler::clock::duration, bool const expired) {
+          auto const item_done = [this, b, i](std::string&& result) {
+            if (b->batch_.set_result(i, std::move(result))) {
+              b->cb_(json_response(b->req_, b->batch_.response()));
+            } else {
+              schedule_batch_item(b);
+            }
+          };
+          if (expired) {
+            return item_done(json_error("Request timed out in queue"));
+          }
+          compute_route(b->batch_.request(i),
+                        [item_done](route_result&& result) {
+                          item_done(std::move(result.content_));
+                        });
+        },
+        true);
+    return true;
   }
 
   void handle_graph(web_server::http_req_t const& req,
@@ -175,22 +454,131 @@ struct http_server::impl {
                               http::status::bad_request));
     }
 
-    auto query_box =
-        boost::geometry::return_envelope<routing_graph::rtree_box_type>(
-            r.waypoints_);
+    auto const query_box = make_packed_rtree_box(r.waypoints_);
+    auto const* store = find_graph(
+        r.graph_,
+        {make_location(std::midpoint(query_box.min_x_, query_box.max_x_),
+                       std::midpoint(query_box.min_y_, query_box.max_y_))});
+    if (store == nullptr) {
+      return cb(json_response(req, R"({"error": "No routing graph found"})",
+                              http::status::bad_request));
+    }
+    auto const graph = store->get();
 
-    std::vector<routing_graph::edge_rtree_value_type> edge_results;
-    graph_.edge_rtree_->query(bgi::intersects(query_box),
-                              std::back_inserter(edge_results));
+    std::vector<rg_edge> edge_results;
+    graph->data_->edge_rtree_.search(
+        query_box, [&](rg_edge const& e) { edge_results.push_back(e); });
 
-    std::vector<routing_graph::area_rtree_value_type> area_results;
+    std::vector<std::uint32_t> area_results;
     if (r.include_areas_) {
-      graph_.area_rtree_->query(bgi::intersects(query_box),
-                                std::back_inserter(area_results));
+      graph->data_->area_rtree_.search(query_box, [&](std::uint32_t const a) {
+        area_results.push_back(a);
+      });
     }
 
-    cb(json_response(req, to_graph_response(edge_results, area_results, graph_,
-                                            r.include_visibility_graphs_)));
+    cb(json_response(req, to_graph_response(edge_results, area_results, *graph,
+                                            r.include_visibility_graphs_,
+                                            r.pretty_)));
+  }
+
+  void handle_reload(web_server::http_req_t const& req,
+                     web_server::http_res_cb_t const& cb) {
+    if (admin_token_.empty()) {
+      return cb(json_response(req, R"({"error": "Not found"})",
+                              http::status::not_found));
+    }
+    if (req[http::field::authorization] != "Bearer " + admin_token_) {
+      return cb(json_response(req, R"({"error": "Unauthorized"})",
+                              http::status::unauthorized));
+    }
+    auto any_started = false;
+    auto content = std::string{R"({"graphs": [)"};
+    for (auto const& [idx, g] : utl::enumerate(graphs_.graphs())) {
+      auto const started = g->reload();
+      any_started = any_started || started;
+      content += fmt::format(
+          R"({}{{"name": "{}", "status": "{}", "version": {}}})",
+          idx == 0 ? "" : ", ", g->name(),
+          started ? "reloading" : "already reloading", g->version());
+    }
+    content += "]}";
+    cb(json_response(
+        req, content,
+        any_started ? http::status::accepted : http::status::conflict));
+  }
+
+  void handle_metrics(web_server::http_req_t const& req,
+                      web_server::http_res_cb_t const& cb) {
+    auto w = prometheus_writer{};
+
+    w.family("ppr_request_duration_seconds", "histogram",
+             "Time from request receipt to response");
+    w.histogram("ppr_request_duration_seconds", {}, request_duration_.read());
+    w.family("ppr_responses_total", "counter", "Responses by status class");
+    for (auto i = 0U; i < responses_.size(); ++i) {
+      w.sample("ppr_responses_total",
+               prometheus_writer::label("code", fmt::format("{}xx", i + 1)),
+               responses_[i].read());
+    }
+    w.family("ppr_queue_wait_seconds", "histogram",
+             "Time requests waited for a routing thread");
+    w.histogram("ppr_queue_wait_seconds", {}, queue_wait_.read());
+
+    auto const queue = scheduler_.stats();
+    w.family("ppr_queue_depth", "gauge", "Requests waiting for a thread");
+    w.sample("ppr_queue_depth", {}, std::uint64_t{queue.queued_});
+    w.family("ppr_queue_rejected_total", "counter",
+             "Requests rejected because the queue was full");
+    w.sample("ppr_queue_rejected_total", {}, queue.rejected_);
+    w.family("ppr_queue_expired_total", "counter",
+             "Requests that timed out in the queue");
+    w.sample("ppr_queue_expired_total", {}, queue.expired_);
+    w.family("ppr_routes_in_flight", "gauge",
+             "Distinct route computations running (coalesced)");
+    w.sample("ppr_routes_in_flight", {}, std::uint64_t{in_flight_.in_flight()});
+
+    route_metrics_.write(w);
+
+    if (route_cache_.enabled()) {
+      auto const cache = route_cache_.stats();
+      w.family("ppr_route_cache_hits_total", "counter", "Route cache hits");
+      w.sample("ppr_route_cache_hits_total", {}, cache.hits_);
+      w.family("ppr_route_cache_misses_total", "counter",
+               "Route cache misses");
+      w.sample("ppr_route_cache_misses_total", {}, cache.misses_);
+      w.family("ppr_route_cache_evictions_total", "counter",
+               "Route cache evictions");
+      w.sample("ppr_route_cache_evictions_total", {}, cache.evictions_);
+      w.family("ppr_route_cache_entries", "gauge", "Route cache entries");
+      w.sample("ppr_route_cache_entries", {}, std::uint64_t{cache.entries_});
+      w.family("ppr_route_cache_bytes", "gauge", "Route cache memory usage");
+      w.sample("ppr_route_cache_bytes", {}, std::uint64_t{cache.memory_});
+    }
+
+    w.family("ppr_graph_file_bytes", "gauge",
+             "Size of the memory mapped routing graph file");
+    for (auto const& g : graphs_.graphs()) {
+      w.sample("ppr_graph_file_bytes",
+               prometheus_writer::label("graph", g->name()),
+               std::uint64_t{g->file_size()});
+    }
+    w.family("ppr_graph_version", "gauge", "Routing graph reload counter");
+    for (auto const& g : graphs_.graphs()) {
+      w.sample("ppr_graph_version",
+               prometheus_writer::label("graph", g->name()), g->version());
+    }
+    auto const mem = get_memory_usage();
+    w.family("ppr_resident_memory_bytes", "gauge",
+             "Resident set size of the process");
+    w.sample("ppr_resident_memory_bytes", {}, mem.current_rss_);
+
+    w.family("ppr_access_log_dropped_total", "counter",
+             "Access log entries dropped because the writer was too slow");
+    w.sample("ppr_access_log_dropped_total", {}, access_log_.dropped());
+
+    auto res = net::string_response(req, w.str(), http::status::ok,
+                                    prometheus_writer::CONTENT_TYPE);
+    cb(res);
   }
 
   void handle_static(web_server::http_req_t&& req,
@@ -203,26 +591,44 @@ struct http_server::impl {
 
   void handle_request(web_server::http_req_t&& req,
                       web_server::http_res_cb_t&& cb) {
-    std::cout << "[" << req.method_string() << "] " << req.target()
-              << std::endl;
+    auto const entry = std::make_shared<access_log_entry>();
+    entry->received_ = std::chrono::steady_clock::now();
+    entry->timestamp_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+    entry->method_ = std::string{req.method_string()};
+    entry->target_ = std::string{req.target()};
+    cb = [this, entry, next = std::move(cb)](web_server::http_res_t&& res) {
+      record_response(*entry, res);
+      if (access_log_.enabled()) {
+        access_log_.log(std::move(*entry));
+      }
+      next(std::move(res));
+    };
     switch (req.method()) {
       case http::verb::options: return cb(json_response(req, {}));
       case http::verb::post: {
         auto const& target = req.target();
-        if (boost::algorithm::starts_with(target, "/api/route")) {
+        if (target == "/api/route/batch") {
           return run_parallel(
+              request_priority::NORMAL,
               [this](web_server::http_req_t const& req1,
                      web_server::http_res_cb_t const& cb1) {
-                handle_route(req1, cb1);
+                handle_route_batch(req1, cb1);
               },
-              req, cb);
+              req, cb, entry);
+        } else if (boost::algorithm::starts_with(target, "/api/route")) {
+          return schedule_route(req, cb, entry);
+        } else if (target == "/api/admin/reload") {
+          return handle_reload(req, cb);
         } else if (boost::algorithm::starts_with(target, "/api/graph")) {
           return run_parallel(
+              request_priority::HIGH,
               [this](web_server::http_req_t const& req1,
                      web_server::http_res_cb_t const& cb1) {
                 handle_graph(req1, cb1);
               },
-              req, cb);
+              req, cb, entry);
         } else {
           return cb(json_response(req, R"({"error": "Not found"})",
                                   http::status::not_found));
@@ -230,6 +636,9 @@ struct http_server::impl {
       }
       case http::verb::get:
       case http::verb::head:
+        if (req.target() == "/metrics") {
+          return handle_metrics(req, cb);
+        }
         return handle_static(std::move(req), std::move(cb));
       default:
         return cb(json_response(req,
@@ -238,15 +647,70 @@ struct http_server::impl {
     }
   }
 
+  // Called on the io thread with every response (access log and metrics).
+  void record_response(access_log_entry& entry,
+                       web_server::http_res_t const& res) {
+    std::visit(
+        [&](auto const& r) {
+          entry.status_ = r.result_int();
+          entry.response_size_ = r.payload_size().value_or(0);
+          if (access_log_.level() == log_level::VERBOSE) {
+            entry.server_timing_ = std::string{r["Server-Timing"]};
+          }
+        },
+        res);
+    entry.d_total_ = std::chrono::duration<double, std::milli>{
+        std::chrono::steady_clock::now() - entry.received_}
+                         .count();
+    request_duration_.observe(entry.d_total_);
+    if (auto const status_class = entry.status_ / 100;
+        status_class >= 1 && status_class <= responses_.size()) {
+      responses_[status_class - 1].add();
+    }
+  }
+
+
+  // Queues the handler for the routing thread pool. Requests are rejected
+  // with 503 if the queue is full or if they waited longer than the timeout.
   template <typename Fn>
-  void run_parallel(Fn handler, web_server::http_req_t const& req,
-                    web_server::http_res_cb_t const& cb) {
-    boost::asio::post(thread_pool_, [req, cb, handler, this]() {
-      handler(req, [req, cb, this](web_server::http_res_t&& res) {
-        boost::asio::post(
-            ioc_, [cb, res{std::move(res)}]() mutable { cb(std::move(res)); });
-      });
-    });
+  void run_parallel(request_priority const priority, Fn handler,
+                    web_server::http_req_t const& req,
+                    web_server::http_res_cb_t const& cb,
+                    log_entry_ptr const& entry) {
+    auto const queued = scheduler_.post(
+        priority, [req, cb, handler, entry, this](
+                      request_scheduler::clock::duration const wait,
+                      bool const expired) {
+          auto const wait_ms =
+              std::chrono::duration<double, std::milli>{wait}.count();
+          entry->d_queue_ = wait_ms;
+          queue_wait_.observe(wait_ms);
+          auto const reply = [cb, wait_ms, this](web_server::http_res_t&& res) {
+            std::visit(
+                [&](auto& r) {
+                  auto timing = std::string{r["Server-Timing"]};
+                  timing += fmt::format("{}queue;dur={}",
+                                        timing.empty() ? "" : ", ", wait_ms);
+                  r.set("Server-Timing", timing);
+                },
+                res);
+            boost::asio::post(ioc_, [cb, res{std::move(res)}]() mutable {
+              cb(std::move(res));
+            });
+          };
+          if (expired) {
+            return reply(json_response(
+                req, R"({"error": "Request timed out in queue"})",
+                http::status::service_unavailable));
+          }
+          handler(req, reply);
+        });
+    if (!queued) {
+      auto res = json_response(req, R"({"error": "Server overloaded"})",
+                               http::status::service_unavailable);
+      res.set(http::field::retry_after, "1");
+      cb(res);
+    }
   }
 
   void listen(std::string const& host, std::string const& port) {
@@ -273,9 +737,20 @@ struct http_server::impl {
 
 private:
   boost::asio::io_context& ioc_;
-  boost::asio::io_context& thread_pool_;
   boost::asio::ssl::context& ssl_ctx_;
-  routing_graph const& graph_;
+  graph_registry& graphs_;
+  std::string admin_token_;
+  std::size_t max_batch_size_;
+  std::size_t batch_window_;  // queued items per batch
+  profile_registry profiles_;
+  route_cache route_cache_;
+  request_coalescer<route_result> in_flight_;
+  request_scheduler scheduler_;
+  access_log access_log_;
+  route_metrics route_metrics_;
+  latency_histogram request_duration_;
+  latency_histogram queue_wait_;
+  std::array<sharded_counter, 5> responses_;  // by status class
   web_server server_;
   bool serve_static_files_{false};
   std::string static_file_path_;
@@ -284,9 +759,9 @@ private:
 http_server::http_server(boost::asio::io_context& ioc,
                          boost::asio::io_context& thread_pool,
                          boost::asio::ssl::context& ssl_ctx,
-                         routing_graph const& g,
-                         std::string const& static_file_path)
-    : impl_(new impl(ioc, thread_pool, ssl_ctx, g, static_file_path)) {}
+                         graph_registry& graphs,
+                         server_settings const& settings)
+    : impl_(new impl(ioc, thread_pool, ssl_ctx, graphs, settings)) {}
 
 http_server::~http_server() = default;
 
@@ -0,0 +1,213 @@
+#include "ppr/backend/metrics.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+
+using namespace ppr::routing;
+
+namespace ppr::backend {
+
+namespace {
+
+constexpr auto const PHASE_NAMES =
+    std::array<char const*, static_cast<std::size_t>(route_phase::NUM_PHASES)>{
+        "start_pts",       "destination_pts", "dijkstra_starts",
+        "dijkstra_goals",  "area_edges",      "search",
+        "labels_to_route", "postprocessing",  "encoding",
+        "total"};
+
+template <typename T>
+void append_number(std::string& out, T const value) {
+  auto buf = std::array<char, 32>{};
+  auto const [end, ec] =
+      std::to_chars(buf.data(), buf.data() + buf.size(), value);
+  out.append(buf.data(), ec == std::errc{} ? end : buf.data());
+}
+
+}  // namespace
+
+std::size_t metric_shard() {
+  static std::atomic_size_t next{0};
+  thread_local auto const shard = next++ % METRIC_SHARDS;
+  return shard;
+}
+
+void sharded_counter::add(std::uint64_t const n) {
+  shards_[metric_shard()].value_.fetch_add(n, std::memory_order_relaxed);
+}
+
+std::uint64_t sharded_counter::read() const {
+  auto sum = std::uint64_t{0};
+  for (auto const& s : shards_) {
+    sum += s.value_.load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+void latency_histogram::observe(double const ms) {
+  auto const bucket = static_cast<std::size_t>(
+      std::lower_bound(begin(BOUNDS), end(BOUNDS), ms) - begin(BOUNDS));
+  auto& s = shards_[metric_shard()];
+  s.buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+  s.sum_us_.fetch_add(static_cast<std::uint64_t>(std::max(0.0, ms) * 1000),
+                      std::memory_order_relaxed);
+}
+
+latency_histogram::snapshot latency_histogram::read() const {
+  auto h = snapshot{};
+  auto sum_us = std::uint64_t{0};
+  for (auto const& s : shards_) {
+    for (auto i = 0U; i < h.buckets_.size(); ++i) {
+      auto const n = s.buckets_[i].load(std::memory_order_relaxed);
+      h.buckets_[i] += n;
+      h.count_ += n;
+    }
+    sum_us += s.sum_us_.load(std::memory_order_relaxed);
+  }
+  h.sum_ = static_cast<double>(sum_us) / 1000.0;
+  return h;
+}
+
+void prometheus_writer::family(std::string_view const name,
+                               std::string_view const type,
+                               std::string_view const help) {
+  out_.append("# HELP ").append(name).append(" ").append(help).append("\n");
+  out_.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+}
+
+void prometheus_writer::write_name(std::string_view const name,
+                                   std::string_view const labels) {
+  out_.append(name);
+  if (!labels.empty()) {
+    out_.append("{").append(labels).append("}");
+  }
+  out_.append(" ");
+}
+
+void prometheus_writer::sample(std::string_view const name,
+                               std::string_view const labels,
+                               double const value) {
+  write_name(name, labels);
+  append_number(out_, value);
+  out_.append("\n");
+}
+
+void prometheus_writer::sample(std::string_view const name,
+                               std::string_view const labels,
+                               std::uint64_t const value) {
+  write_name(name, labels);
+  append_number(out_, value);
+  out_.append("\n");
+}
+
+void prometheus_writer::histogram(std::string_view const name,
+                                  std::string_view const labels,
+                                  latency_histogram::snapshot const& h) {
+  auto const base = std::string{name};
+  auto const prefix =
+      labels.empty() ? std::string{} : std::string{labels} + ",";
+  auto cumulative = std::uint64_t{0};
+  for (auto i = 0U; i < h.buckets_.size(); ++i) {
+    cumulative += h.buckets_[i];
+    auto le = std::string{};
+    if (i < latency_histogram::BOUNDS.size()) {
+      append_number(le, latency_histogram::BOUNDS[i] / 1000.0);
+    } else {
+      le = "+Inf";
+    }
+    sample(base + "_bucket", prefix + label("le", le), cumulative);
+  }
+  sample(base + "_sum", labels, h.sum_ / 1000.0);
+  sample(base + "_count", labels, h.count_);
+}
+
+std::string prometheus_writer::label(std::string_view const key,
+                                     std::string_view const value) {
+  auto s = std::string{key};
+  s += "=\"";
+  for (auto const c : value) {
+    switch (c) {
+      case '\\': s += "\\\\"; break;
+      case '"': s += "\\\""; break;
+      case '\n': s += "\\n"; break;
+      default: s += c;
+    }
+  }
+  s += "\"";
+  return s;
+}
+
+void route_metrics::record(routing_statistics const& stats,
+                           double const d_encoding) {
+  auto ds_sum = dijkstra_statistics{};
+  auto goals_unreached = std::size_t{0};
+  auto max_label_quits = std::uint64_t{0};
+  for (auto const& ds : stats.dijkstra_statistics_) {
+    ds_sum.labels_created_ += ds.labels_created_;
+    ds_sum.labels_popped_ += ds.labels_popped_;
+    ds_sum.d_starts_ += ds.d_starts_;
+    ds_sum.d_goals_ += ds.d_goals_;
+    ds_sum.d_area_edges_ += ds.d_area_edges_;
+    ds_sum.d_search_ += ds.d_search_;
+    ds_sum.d_labels_to_route_ += ds.d_labels_to_route_;
+    goals_unreached += ds.goals_ - std::min(ds.goals_, ds.goals_reached_);
+    max_label_quits += ds.max_label_quit_ ? 1 : 0;
+  }
+
+  phase(route_phase::START_PTS)
+      .observe(stats.d_start_pts_ + stats.d_start_pts_extended_);
+  phase(route_phase::DESTINATION_PTS)
+      .observe(stats.d_destination_pts_ + stats.d_destination_pts_extended_);
+  phase(route_phase::DIJKSTRA_STARTS).observe(ds_sum.d_starts_);
+  phase(route_phase::DIJKSTRA_GOALS).observe(ds_sum.d_goals_);
+  phase(route_phase::AREA_EDGES).observe(ds_sum.d_area_edges_);
+  phase(route_phase::SEARCH).observe(ds_sum.d_search_);
+  phase(route_phase::LABELS_TO_ROUTE).observe(ds_sum.d_labels_to_route_);
+  phase(route_phase::POSTPROCESSING).observe(stats.d_postprocessing_);
+  phase(route_phase::ENCODING).observe(d_encoding);
+  phase(route_phase::TOTAL).observe(stats.d_total_ + d_encoding);
+
+  routes_.add();
+  labels_created_.add(ds_sum.labels_created_);
+  labels_popped_.add(ds_sum.labels_popped_);
+  max_label_quits_.add(max_label_quits);
+  attempts_.add(static_cast<std::uint64_t>(std::max(0, stats.attempts_)));
+  pts_extended_.add(static_cast<std::uint64_t>(
+      std::max(0, stats.start_pts_extended_ +
+                      stats.destination_pts_extended_)));
+  goals_unreached_.add(goals_unreached);
+}
+
+void route_metrics::write(prometheus_writer& w) const {
+  w.family("ppr_route_phase_duration_seconds", "histogram",
+           "Time spent per routing phase (per route, summed over attempts)");
+  for (auto i = 0U; i < phases_.size(); ++i) {
+    w.histogram("ppr_route_phase_duration_seconds",
+                prometheus_writer::label("phase", PHASE_NAMES[i]),
+                phases_[i].read());
+  }
+
+  auto const counter = [&](char const* name, char const* help,
+                           sharded_counter const& c) {
+    w.family(name, "counter", help);
+    w.sample(name, {}, c.read());
+  };
+  counter("ppr_routes_total", "Computed routes (excluding cache hits)",
+          routes_);
+  counter("ppr_labels_created_total", "Labels created by the search",
+          labels_created_);
+  counter("ppr_labels_popped_total", "Labels popped by the search",
+          labels_popped_);
+  counter("ppr_max_label_aborts_total",
+          "Searches aborted because of the label limit", max_label_quits_);
+  counter("ppr_routing_attempts_total",
+          "Search attempts (including attempts with expanded points)",
+          attempts_);
+  counter("ppr_point_expansions_total",
+          "Start/destination point set expansions", pts_extended_);
+  counter("ppr_goals_unreached_total", "Destinations not reached by a search",
+          goals_unreached_);
+}
+
+}  // namespace ppr::backend
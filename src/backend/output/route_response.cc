@@ -2,13 +2,11 @@
 
 #include <stdexcept>
 
+#include "ppr/backend/output/json_writer.h"
 #include "ppr/output/json.h"
 
 #include "ppr/routing/route_steps.h"
 
-#include "rapidjson/prettywriter.h"
-#include "rapidjson/stringbuffer.h"
-
 using namespace ppr;
 using namespace ppr::routing;
 using namespace ppr::output;
@@ -465,6 +463,10 @@ void write_routing_statistics(Writer& writer, routing_statistics const& s) {
   writer.Double(s.d_postprocessing_);
   writer.String("d_total");
   writer.Double(s.d_total_);
+  writer.String("snapping_cache_hits");
+  writer.Int(s.snapping_cache_hits_);
+  writer.String("snapping_cache_misses");
+  writer.Int(s.snapping_cache_misses_);
 
   writer.String("dijkstra");
   writer.StartArray();
@@ -476,37 +478,56 @@ void write_routing_statistics(Writer& writer, routing_statistics const& s) {
   writer.EndObject();
 }
 
-std::string routes_to_route_response(routing_graph_data const& rg,
-                                     search_result const& result,
-                                     route_request const& req) {
-  rapidjson::StringBuffer sb;
-  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(sb);
-
-  writer.StartObject();
-  if (result.routes_.empty()) {
-    writer.String("error");
-    writer.String("No route found.");
-    writer.EndObject();
-    return sb.GetString();
-  }
-
-  writer.String("routes");
-  writer.StartArray();
+namespace {
 
+std::size_t estimate_route_response_size(search_result const& result,
+                                         route_request const& req) {
+  auto size = std::size_t{1024};  // statistics
   for (auto const& rs : result.routes_) {
     for (auto const& r : rs) {
-      write_route(writer, rg, r, req);
+      auto const edges = r.edges_.size();
+      size += req.include_infos_ ? 512 : 16;
+      size += req.include_full_path_ ? edges * 48 : 0;
+      size += req.include_steps_ ? edges * 96 : 0;
+      size += req.include_steps_path_ ? edges * 48 : 0;
+      size += req.include_edges_ ? edges * 512 : 0;
     }
   }
+  return size;
+}
 
-  writer.EndArray();  // routes
-
-  writer.String("statistics");
-  write_routing_statistics(writer, result.stats_);
-
-  writer.EndObject();
+}  // namespace
 
-  return sb.GetString();
+std::string routes_to_route_response(routing_graph_data const& rg,
+                                     search_result const& result,
+                                     route_request const& req) {
+  return write_json(
+      req.pretty_, estimate_route_response_size(result, req),
+      [&](auto& writer) {
+        writer.StartObject();
+        if (result.routes_.empty()) {
+          writer.String("error");
+          writer.String("No route found.");
+          writer.EndObject();
+          return;
+        }
+
+        writer.String("routes");
+        writer.StartArray();
+
+        for (auto const& rs : result.routes_) {
+          for (auto const& r : rs) {
+            write_route(writer, rg, r, req);
+          }
+        }
+
+        writer.EndArray();  // routes
+
+        writer.String("statistics");
+        write_routing_statistics(writer, result.stats_);
+
+        writer.EndObject();
+      });
 }
 
 }  // namespace ppr::backend::output
@@ -0,0 +1,96 @@
+#include "ppr/backend/profile_registry.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "boost/filesystem.hpp"
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "ppr/profiles/parse_search_profile.h"
+
+namespace fs = boost::filesystem;
+
+using namespace ppr::routing;
+
+namespace ppr::backend {
+
+profile_registry::profile_registry()
+    : default_{std::make_shared<search_profile const>()} {}
+
+std::size_t profile_registry::load_directory(std::string const& path,
+                                             std::ostream& out) {
+  auto loaded = std::size_t{0};
+  for (auto const& entry : fs::directory_iterator{path}) {
+    auto const& file = entry.path();
+    if (!fs::is_regular_file(file) || file.extension() != ".json") {
+      continue;
+    }
+    auto in = std::ifstream{file.string()};
+    auto content = std::stringstream{};
+    content << in.rdbuf();
+
+    rapidjson::Document doc;
+    doc.Parse<rapidjson::kParseDefaultFlags>(content.str().c_str());
+    if (doc.HasParseError() || !doc.IsObject()) {
+      out << "Invalid profile file (skipped): " << file.string() << std::endl;
+      continue;
+    }
+    auto profile = search_profile{};
+    profiles::parse_search_profile(profile, doc);
+    add(file.stem().string(), profile);
+    ++loaded;
+  }
+  return loaded;
+}
+
+void profile_registry::add(std::string const& name,
+                           search_profile const& profile) {
+  named_[name] = std::make_shared<search_profile const>(profile);
+}
+
+profile_registry::profile_ptr profile_registry::get(
+    std::string_view const name) const {
+  auto const it = named_.find(std::string{name});
+  return it != end(named_) ? it->second : nullptr;
+}
+
+profile_registry::profile_ptr profile_registry::get(
+    rapidjson::Value const& json) {
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  json.Accept(writer);
+  auto key = std::string{sb.GetString(), sb.GetSize()};
+
+  {
+    auto const lock = std::lock_guard{cache_mutex_};
+    if (auto const it = cache_.find(key); it != end(cache_)) {
+      return it->second;
+    }
+  }
+
+  auto profile = search_profile{};
+  profiles::parse_search_profile(profile, json);
+  auto ptr = std::make_shared<search_profile const>(profile);
+
+  auto const lock = std::lock_guard{cache_mutex_};
+  if (cache_.size() >= MAX_CACHED_PROFILES) {
+    cache_.clear();
+  }
+  cache_.emplace(std::move(key), ptr);
+  return ptr;
+}
+
+std::vector<std::string> profile_registry::names() const {
+  auto names = std::vector<std::string>{};
+  for (auto const& [name, profile] : named_) {
+    names.emplace_back(name);
+  }
+  std::sort(begin(names), end(names));
+  return names;
+}
+
+}  // namespace ppr::backend
@@ -0,0 +1,61 @@
+#include "ppr/backend/request_scheduler.h"
+
+#include <utility>
+
+#include "boost/asio/post.hpp"
+
+namespace ppr::backend {
+
+request_scheduler::request_scheduler(boost::asio::io_context& pool,
+                                     std::size_t const max_queued,
+                                     std::chrono::milliseconds const timeout)
+    : pool_{pool}, max_queued_{max_queued}, timeout_{timeout} {}
+
+bool request_scheduler::post(request_priority const priority, task_t task,
+                             bool const admitted) {
+  {
+    auto const lock = std::lock_guard{mutex_};
+    if (!admitted && max_queued_ != 0 && queued_ >= max_queued_) {
+      ++rejected_;
+      return false;
+    }
+    queues_[static_cast<std::size_t>(priority)].push_back(
+        entry{std::move(task), clock::now(), admitted});
+    ++(admitted ? queued_admitted_ : queued_);
+  }
+  boost::asio::post(pool_, [this]() { run_next(); });
+  return true;
+}
+
+void request_scheduler::run_next() {
+  auto e = entry{};
+  {
+    auto const lock = std::lock_guard{mutex_};
+    for (auto& q : queues_) {
+      if (!q.empty()) {
+        e = std::move(q.front());
+        q.pop_front();
+        --(e.admitted_ ? queued_admitted_ : queued_);
+        break;
+      }
+    }
+  }
+  if (!e.task_) {
+    return;
+  }
+  auto const wait = clock::now() - e.enqueued_;
+  auto const expired = timeout_.count() != 0 && wait > timeout_;
+  if (expired) {
+    ++expired_;
+  }
+  e.task_(wait, expired);
+}
+
+request_scheduler_stats request_scheduler::stats() const {
+  auto const lock = std::lock_guard{mutex_};
+  return {.queued_ = queued_ + queued_admitted_,
+          .rejected_ = rejected_,
+          .expired_ = expired_};
+}
+
+}  // namespace ppr::backend
@@ -0,0 +1,71 @@
+#include "ppr/backend/route_batch.h"
+
+#include <exception>
+#include <utility>
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace ppr::backend {
+
+namespace {
+
+std::string error_result(std::string const& msg) {
+  rapidjson::StringBuffer sb;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+  writer.StartObject();
+  writer.String("error");
+  writer.String(msg.data(), static_cast<rapidjson::SizeType>(msg.size()));
+  writer.EndObject();
+  return sb.GetString();
+}
+
+}  // namespace
+
+route_batch::route_batch(rapidjson::Value const& items,
+                         parse_fn_t const& parse)
+    : requests_(items.Size()), results_(items.Size()) {
+  for (auto i = 0U; i < items.Size(); ++i) {
+    if (!items[i].IsObject()) {
+      results_[i] = R"({"error": "Invalid route request"})";
+      continue;
+    }
+    try {
+      requests_[i] = parse(items[i]);
+      pending_.push_back(i);
+    } catch (std::exception const& e) {
+      results_[i] = error_result(e.what());
+    }
+  }
+  remaining_ = pending_.size();
+}
+
+std::size_t route_batch::next() {
+  auto const i = next_++;
+  return i < pending_.size() ? pending_[i] : size();
+}
+
+bool route_batch::set_result(std::size_t const i, std::string result) {
+  results_[i] = std::move(result);
+  return --remaining_ == 0;
+}
+
+std::string route_batch::response() const {
+  auto size = std::size_t{2};
+  for (auto const& result : results_) {
+    size += result.size() + 1;
+  }
+  auto content = std::string{};
+  content.reserve(size);
+  content += "[";
+  for (auto i = 0U; i < results_.size(); ++i) {
+    if (i != 0) {
+      content += ",";
+    }
+    content += results_[i];
+  }
+  content += "]";
+  return content;
+}
+
+}  // namespace ppr::backend
@@ -0,0 +1,62 @@
+#include "ppr/backend/route_cache.h"
+
+#include <utility>
+
+using namespace ppr::routing;
+
+namespace ppr::backend {
+
+route_cache::route_cache(std::size_t const max_memory)
+    : max_memory_{max_memory} {}
+
+std::size_t route_cache::entry_size(entry const& e) {
+  // list node + index slot + strings
+  return sizeof(entry) + 64 + 2 * e.key_.size() + e.response_.size();
+}
+
+std::optional<std::string> route_cache::get(std::string const& key) {
+  auto const lock = std::lock_guard{mutex_};
+  auto const it = index_.find(std::string_view{key});
+  if (it == end(index_)) {
+    ++misses_;
+    return std::nullopt;
+  }
+  ++hits_;
+  lru_.splice(begin(lru_), lru_, it->second);
+  return it->second->response_;
+}
+
+void route_cache::put(std::string key, std::string response,
+                      std::shared_ptr<search_profile const> profile) {
+  auto e = entry{std::move(key), std::move(response), std::move(profile)};
+  auto const size = entry_size(e);
+  if (size > max_memory_) {
+    return;
+  }
+
+  auto const lock = std::lock_guard{mutex_};
+  if (index_.find(std::string_view{e.key_}) != end(index_)) {
+    return;  // added by a concurrent request
+  }
+  while (memory_ + size > max_memory_ && !lru_.empty()) {
+    auto const& last = lru_.back();
+    memory_ -= entry_size(last);
+    index_.erase(std::string_view{last.key_});
+    lru_.pop_back();
+    ++evictions_;
+  }
+  lru_.emplace_front(std::move(e));
+  index_.emplace(std::string_view{lru_.front().key_}, begin(lru_));
+  memory_ += size;
+}
+
+route_cache_stats route_cache::stats() const {
+  auto const lock = std::lock_guard{mutex_};
+  return {.hits_ = hits_,
+          .misses_ = misses_,
+          .evictions_ = evictions_,
+          .entries_ = lru_.size(),
+          .memory_ = memory_};
+}
+
+}  // namespace ppr::backend
@@ -0,0 +1,73 @@
+#include "ppr/backend/route_key.h"
+
+#include <type_traits>
+
+using namespace ppr::routing;
+
+namespace ppr::backend {
+
+namespace {
+
+template <typename T>
+inline void append(std::string& key, T const& val) {
+  static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+  key.append(reinterpret_cast<char const*>(&val), sizeof(T));
+}
+
+void append(std::string& key, input_location const& il) {
+  append(key, il.location_.has_value());
+  if (il.location_) {
+    append(key, il.location_->x());
+    append(key, il.location_->y());
+  }
+  append(key, il.osm_element_.has_value());
+  if (il.osm_element_) {
+    append(key, il.osm_element_->id_);
+    append(key, il.osm_element_->type_);
+  }
+  append(key, il.level_.has_value());
+  if (il.level_) {
+    append(key, *il.level_);
+  }
+  append(key, il.initial_max_distance_);
+  append(key, il.expanded_max_distance_);
+}
+
+void append(std::string& key, routing_options const& opt) {
+  append(key, opt.allow_expansion_);
+  append(key, opt.allow_osm_id_expansion_);
+  append(key, opt.force_level_match_);
+  append(key, opt.allow_match_with_no_level_);
+  append(key, opt.level_dist_penalty_);
+  append(key, opt.no_level_penalty_);
+  append(key, opt.initial_max_pt_query_);
+  append(key, opt.initial_max_pt_count_);
+  append(key, opt.expanded_max_pt_query_);
+  append(key, opt.expanded_max_pt_count_);
+}
+
+}  // namespace
+
+std::string make_route_key(std::string_view const graph,
+                           std::uint64_t const version,
+                           route_request const& r) {
+  auto key = std::string{};
+  key.reserve(160);
+  append(key, graph.size());
+  key.append(graph);
+  append(key, version);
+  append(key, reinterpret_cast<std::uintptr_t>(r.profile_.get()));
+  append(key, r.start_);
+  append(key, r.destination_);
+  append(key, r.options_);
+  append(key, r.include_infos_);
+  append(key, r.include_full_path_);
+  append(key, r.include_steps_);
+  append(key, r.include_steps_path_);
+  append(key, r.include_edges_);
+  append(key, r.include_statistics_);
+  append(key, r.pretty_);
+  return key;
+}
+
+}  // namespace ppr::backend
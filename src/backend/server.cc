@@ -28,25 +28,22 @@ auto run(boost::asio::io_context& ioc) {
   };
 }
 
-void ppr_server(routing_graph const& rg, std::string const& http_host,
-                std::string const& http_port, int num_threads,
-                std::string const& static_file_path,
-                std::string const& cert_path, std::string const& priv_key_path,
-                std::string const& dh_path) {
+void ppr_server(graph_registry& graphs, server_settings const& settings) {
   boost::asio::ssl::context ssl_ctx{boost::asio::ssl::context::tlsv12};
-  load_server_certificate(ssl_ctx, cert_path, priv_key_path, dh_path);
+  load_server_certificate(ssl_ctx, settings.cert_path_,
+                          settings.priv_key_path_, settings.dh_path_);
 
   boost::asio::io_context ioc, thread_pool;
-  http_server http{ioc, thread_pool, ssl_ctx, rg, static_file_path};
+  http_server http{ioc, thread_pool, ssl_ctx, graphs, settings};
 
   auto work_guard = boost::asio::make_work_guard(thread_pool);
   std::vector<std::thread> threads(
-      static_cast<unsigned>(std::max(1, num_threads)));
+      static_cast<unsigned>(std::max(1, settings.num_threads_)));
   for (auto& t : threads) {
     t = std::thread(run(thread_pool));
   }
 
-  http.listen(http_host, http_port);
+  http.listen(settings.http_host_, settings.http_port_);
 
   auto const stop = net::stop_handler(ioc, [&]() {
     http.stop();
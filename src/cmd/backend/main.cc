@@ -1,20 +1,16 @@
+#include <chrono>
 #include <iostream>
-#include <vector>
-
-#include "boost/filesystem.hpp"
+#include <memory>
 
 #include "conf/options_parser.h"
 
+#include "ppr/backend/graph_registry.h"
 #include "ppr/backend/server.h"
 #include "ppr/cmd/backend/prog_options.h"
 #include "ppr/common/mimalloc_support.h"
-#include "ppr/common/timing.h"
-#include "ppr/common/verify.h"
-#include "ppr/serialization/reader.h"
 
 using namespace ppr;
 using namespace ppr::backend;
-using namespace ppr::serialization;
 
 int main(int argc, char const* argv[]) {
   init_mimalloc();
@@ -35,53 +31,28 @@ int main(int argc, char const* argv[]) {
   parser.print_unrecognized(std::cout);
   parser.print_used(std::cout);
 
-  if (!boost::filesystem::exists(opt.graph_file_)) {
-    std::cerr << "File not found: " << opt.graph_file_ << std::endl;
-    return 1;
-  }
-
-  std::cout << "Loading routing graph..." << std::endl;
-  auto const t_deserialize_start = timing_now();
-  routing_graph rg;
+  auto settings = server_settings{};
   try {
-    read_routing_graph(rg, opt.graph_file_);
-  } catch (std::runtime_error const& err) {
-    std::cout << "Deserialization failed: " << err.what() << std::endl;
+    settings = opt.get_server_settings();
+  } catch (std::exception const& e) {
+    std::cerr << e.what() << std::endl;
     return 1;
   }
-  auto const t_deserialize_duration = ms_since(t_deserialize_start);
-  std::cout << "Deserialization: " << t_deserialize_duration << "ms"
-            << std::endl;
 
-  std::cout << "Routing graph: " << rg.data_->nodes_.size() << " nodes, "
-            << rg.data_->areas_.size() << " areas" << std::endl;
-
-  std::cout << "Preparing indices..." << std::endl;
-  auto const t_rtrees_start = timing_now();
-  auto const rtree_opt = opt.lock_rtrees_
-                             ? rtree_options::LOCK
-                             : (opt.prefetch_rtrees_ ? rtree_options::PREFETCH
-                                                     : rtree_options::DEFAULT);
-  rg.prepare_for_routing(opt.edge_rtree_max_size_, opt.area_rtree_max_size_,
-                         rtree_opt);
-  auto const t_rtrees_duration = ms_since(t_rtrees_start);
-  std::cout << "Indices: " << t_rtrees_duration << "ms" << std::endl;
-
-  if (opt.verify_graph_) {
-    std::cout << "Verifying routing graph file..." << std::endl;
-    if (verify_graph(rg)) {
-      std::cout << "Routing graph file appears to be valid." << std::endl;
-    } else {
-      std::cout << "Routing graph file is invalid!" << std::endl;
-      return 2;
+  graph_registry graphs;
+  try {
+    for (auto const& go : opt.get_graphs()) {
+      auto& store = graphs.add(std::make_unique<graph_store>(go, std::cout));
+      store.watch(std::chrono::seconds{opt.watch_graph_});
     }
+  } catch (std::exception const& e) {
+    std::cerr << "Could not load routing graph: " << e.what() << std::endl;
+    return 1;
   }
 
   // HTTP SERVER
 
-  ppr_server(rg, opt.http_host_, opt.http_port_, opt.threads_,
-             opt.static_file_path_, opt.cert_path_, opt.priv_key_path_,
-             opt.dh_path_);
+  ppr_server(graphs, settings);
 
   return 0;
 }
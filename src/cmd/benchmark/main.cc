@@ -79,7 +79,7 @@ int main(int argc, char const* argv[]) {
   std::cout << "Routing graph: " << rg.data_->nodes_.size() << " nodes, "
             << rg.data_->areas_.size() << " areas" << std::endl;
 
-  std::cout << "Creating r-trees..." << std::endl;
+  std::cout << "Preparing indices..." << std::endl;
   rg.prepare_for_routing();
 
   stations st;
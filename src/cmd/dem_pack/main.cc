@@ -0,0 +1,48 @@
+#include <exception>
+#include <iostream>
+
+#include "conf/options_parser.h"
+
+#include "ppr/cmd/dem_pack/prog_options.h"
+#include "ppr/common/timing.h"
+#include "ppr/preprocessing/elevation/dem_pack.h"
+
+using namespace ppr;
+using namespace ppr::dem_pack;
+using namespace ppr::preprocessing::elevation;
+
+int main(int argc, char const* argv[]) {
+  prog_options opt;
+  conf::options_parser parser({&opt});
+  parser.read_command_line_args(argc, argv);
+
+  if (parser.help()) {
+    parser.print_help(std::cout);
+    return 0;
+  } else if (parser.version()) {
+    return 0;
+  }
+
+  parser.read_configuration_file();
+
+  parser.print_unrecognized(std::cout);
+  parser.print_used(std::cout);
+
+  if (opt.dem_files_.empty()) {
+    std::cerr << "No DEM files specified" << std::endl;
+    return 1;
+  }
+
+  auto const t_start = timing_now();
+  try {
+    write_dem_pack(opt.dem_files_, opt.output_file_, opt.tile_size_,
+                   std::clog);
+  } catch (std::exception const& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  std::clog << "Done (" << static_cast<int>(ms_since(t_start)) << "ms)"
+            << std::endl;
+
+  return 0;
+}
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <memory>
+#include <utility>
 
 #include "boost/filesystem.hpp"
 
@@ -9,16 +11,16 @@
 #include "ppr/cmd/preprocess/prog_options.h"
 #include "ppr/common/memory_usage_printer.h"
 #include "ppr/common/mimalloc_support.h"
+#include "ppr/common/snapping_cache.h"
 #include "ppr/common/timing.h"
 #include "ppr/preprocessing/build_routing_graph.h"
 #include "ppr/preprocessing/default_logging.h"
+#include "ppr/preprocessing/routing_graph/rtrees.h"
 
 using namespace ppr;
 using namespace ppr::backend;
 using namespace ppr::preprocessing;
 
-namespace fs = boost::filesystem;
-
 int main(int argc, char const* argv[]) {
   init_mimalloc();
 
@@ -54,17 +56,20 @@ int main(int argc, char const* argv[]) {
                      : memory_usage_printer::mode::DISABLED};
 
   auto const t_start = timing_now();
-  routing_graph rg = build_routing_graph(pp_opt.get_options(), log, stats);
+  auto rg = std::make_shared<routing_graph>(
+      build_routing_graph(pp_opt.get_options(), log, stats));
   auto const t_after_build = timing_now();
   stats.d_total_pp_ = ms_between(t_start, t_after_build);
 
-  std::cout << "Routing graph: " << rg.data_->nodes_.size() << " nodes, "
-            << rg.data_->areas_.size() << " areas" << std::endl;
+  std::cout << "Routing graph: " << rg->data_->nodes_.size() << " nodes, "
+            << rg->data_->areas_.size() << " areas" << std::endl;
 
   std::cout << "Creating indices..." << std::endl;
-  fs::remove(fs::path("routing-graph.ppr.ert"));
-  fs::remove(fs::path("routing-graph.ppr.art"));
-  rg.prepare_for_routing();
+  create_rtrees(*rg, stats.rtrees_);
+  rg->prepare_for_routing();
+  if (be_opt.snapping_cache_size_ != 0) {
+    enable_snapping_cache(*rg, be_opt.get_snapping_cache_config());
+  }
   auto const t_after_rtree = timing_now();
   auto const d_rtree = ms_between(t_after_build, t_after_rtree);
 
@@ -75,9 +80,12 @@ int main(int argc, char const* argv[]) {
 
   // HTTP SERVER
 
-  ppr_server(rg, be_opt.http_host_, be_opt.http_port_, be_opt.threads_,
-             be_opt.static_file_path_, be_opt.cert_path_, be_opt.priv_key_path_,
-             be_opt.dh_path_);
+  // the graph only exists in memory, reloads read pp_opt.graph_file_
+  auto graphs = graph_registry{};
+  graphs.add(std::make_unique<graph_store>(
+      be_opt.get_graph_options(parse_graph_arg(pp_opt.graph_file_)),
+      std::move(rg), std::cout));
+  ppr_server(graphs, be_opt.get_server_settings());
 
   return 0;
 }
@@ -53,7 +53,7 @@ int main(int argc, char const* argv[]) {
   default_log.flush();
   log.out_ = &std::clog;
 
-  if (opt.verify_graph_) {
+  if (opt.verify_graph_ && opt.partitions_.empty()) {
     log.out() << "Verifying routing graph file..." << std::endl;
     auto const rg = routing_graph{};
     read_routing_graph(result.rg_, opt.graph_file_);
@@ -77,6 +77,13 @@ int main(int argc, char const* argv[]) {
                 << "%  " << std::setw(10) << static_cast<int>(step.duration_)
                 << "ms  " << step.name() << std::endl;
     }
+
+    auto const& rs = result.stats_.rtrees_;
+    log.out() << "\nR-Tree Generation:\n";
+    print_timing(log.out(), "Edge Entries", rs.d_edge_entries_);
+    print_timing(log.out(), "Edge R-Tree Packing", rs.d_edge_rtree_);
+    print_timing(log.out(), "Area Entries", rs.d_area_entries_);
+    print_timing(log.out(), "Area R-Tree Packing", rs.d_area_rtree_);
   }
 
   log.out() << "\nDone!" << std::endl;
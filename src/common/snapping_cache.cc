@@ -0,0 +1,148 @@
+#include <cmath>
+#include <algorithm>
+
+#include "ppr/common/snapping_cache.h"
+
+namespace ppr {
+
+namespace {
+
+constexpr auto const METERS_PER_UNIT = snapping_cache::meters_per_unit();
+
+inline std::int64_t floor_div(std::int64_t const a, std::int64_t const b) {
+  auto const q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+inline std::int32_t clamp_fixed(std::int64_t const v) {
+  return static_cast<std::int32_t>(
+      std::clamp(v, static_cast<std::int64_t>(-180LL * location::PRECISION),
+                 static_cast<std::int64_t>(180LL * location::PRECISION)));
+}
+
+}  // namespace
+
+snapping_cache::snapping_cache(routing_graph_data const& rg,
+                               snapping_cache_config config)
+    : rg_{rg},
+      config_{config},
+      cell_size_fixed_{std::max(
+          std::int64_t{1}, static_cast<std::int64_t>(std::ceil(
+                               config.cell_size_ / METERS_PER_UNIT)))} {}
+
+std::uint64_t snapping_cache::cell_key(location const& loc) const {
+  auto const cx = floor_div(loc.x(), cell_size_fixed_);
+  auto const cy = floor_div(loc.y(), cell_size_fixed_);
+  return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32U) |
+         static_cast<std::uint32_t>(cy);
+}
+
+std::shared_ptr<snapping_cache::cell const> snapping_cache::create_cell(
+    std::uint64_t const key) const {
+  auto const cx = static_cast<std::int64_t>(static_cast<std::int32_t>(
+      static_cast<std::uint32_t>(key >> 32U)));
+  auto const cy = static_cast<std::int64_t>(
+      static_cast<std::int32_t>(static_cast<std::uint32_t>(key)));
+
+  // the x margin is widened for the highest latitude within the cell,
+  // where cos(lat) (as used for distances by the r-trees) is smallest
+  auto const margin_y = static_cast<std::int64_t>(
+      std::ceil(config_.max_distance_ / METERS_PER_UNIT));
+  auto const min_y = cy * cell_size_fixed_ - margin_y;
+  auto const max_y = (cy + 1) * cell_size_fixed_ + margin_y;
+  auto const max_abs_lat =
+      std::min(90.0, static_cast<double>(std::max(std::abs(min_y),
+                                                  std::abs(max_y))) /
+                         location::PRECISION);
+  auto const cos_lat = std::max(std::cos(to_rad(max_abs_lat)), 0.01);
+  auto const margin_x = static_cast<std::int64_t>(
+      std::ceil(config_.max_distance_ / (METERS_PER_UNIT * cos_lat)));
+
+  auto const query = packed_rtree_box{
+      clamp_fixed(cx * cell_size_fixed_ - margin_x), clamp_fixed(min_y),
+      clamp_fixed((cx + 1) * cell_size_fixed_ + margin_x), clamp_fixed(max_y)};
+
+  auto c = std::make_shared<cell>();
+  auto const& edge_rtree = rg_.edge_rtree_;
+  auto const& area_rtree = rg_.area_rtree_;
+  edge_rtree.search_entries(query, [&](packed_rtree_box const& box,
+                                       rg_edge const& e) {
+    c->edges_.emplace_back(box, e);
+  });
+  area_rtree.search_entries(query, [&](packed_rtree_box const& box,
+                                       std::uint32_t const area_id) {
+    c->areas_.emplace_back(box, area_id);
+  });
+  c->edges_.shrink_to_fit();
+  c->areas_.shrink_to_fit();
+  return c;
+}
+
+snapping_cache::shard& snapping_cache::get_shard(std::uint64_t const key) {
+  return shards_[ankerl::unordered_dense::hash<std::uint64_t>{}(key) %
+                 SHARD_COUNT];
+}
+
+snapping_cache::lookup_result snapping_cache::get(location const& loc) {
+  auto const key = cell_key(loc);
+  auto& s = get_shard(key);
+
+  {
+    auto const lock = std::scoped_lock{s.mutex_};
+    if (auto it = s.cells_.find(key); it != end(s.cells_)) {
+      s.lru_.splice(begin(s.lru_), s.lru_, it->second.second);
+      ++hits_;
+      return {it->second.first, true};
+    }
+  }
+
+  // computed without holding the lock, concurrent misses for the same
+  // cell may compute it twice, only one copy is stored
+  ++misses_;
+  auto c = create_cell(key);
+  auto const size = c->memory_size();
+  auto const max_shard_memory = config_.max_memory_ / SHARD_COUNT;
+  if (size > max_shard_memory) {
+    return {c, false};
+  }
+
+  auto const lock = std::scoped_lock{s.mutex_};
+  if (auto it = s.cells_.find(key); it != end(s.cells_)) {
+    return {it->second.first, false};
+  }
+  while (!s.lru_.empty() && s.memory_ + size > max_shard_memory) {
+    auto const evict_it = s.cells_.find(s.lru_.back());
+    s.memory_ -= evict_it->second.first->memory_size();
+    s.cells_.erase(evict_it);
+    s.lru_.pop_back();
+  }
+  s.lru_.push_front(key);
+  s.cells_.emplace(key, std::pair{c, begin(s.lru_)});
+  s.memory_ += size;
+  return {c, false};
+}
+
+std::size_t snapping_cache::memory_size() const {
+  auto total = std::size_t{0};
+  for (auto& s : shards_) {
+    auto const lock = std::scoped_lock{s.mutex_};
+    total += s.memory_;
+  }
+  return total;
+}
+
+std::size_t snapping_cache::cell_count() const {
+  auto total = std::size_t{0};
+  for (auto& s : shards_) {
+    auto const lock = std::scoped_lock{s.mutex_};
+    total += s.cells_.size();
+  }
+  return total;
+}
+
+void enable_snapping_cache(routing_graph& rg,
+                           snapping_cache_config const& config) {
+  rg.snapping_cache_ = std::make_shared<snapping_cache>(*rg.data_, config);
+}
+
+}  // namespace ppr
@@ -1,11 +1,14 @@
 #include <algorithm>
 #include <iostream>
 #include <optional>
+#include <sstream>
+#include <string_view>
 
 #include "ankerl/unordered_dense.h"
 
 #include "ppr/common/geometry/path_conversion.h"
 #include "ppr/common/location_geometry.h"
+#include "ppr/common/parallel.h"
 #include "ppr/common/timing.h"
 #include "ppr/preprocessing/build_routing_graph.h"
 #include "ppr/preprocessing/int_graph/int_graph.h"
@@ -18,6 +21,54 @@
 
 namespace ppr::preprocessing {
 
+// Routing graph nodes, edge infos, statistics and log output created while
+// handling a chunk of junctions. Edge infos get temporary indices (with
+// LOCAL_INFO_BIT set) until the buffers are merged into the graph.
+struct junction_buffer {
+  static constexpr auto const LOCAL_INFO_BIT = edge_info_idx_t{1U} << 31U;
+
+  // end offsets of the data created for one junction
+  struct junction {
+    std::uint32_t node_idx_{};
+    std::size_t infos_end_{};
+    std::size_t nodes_end_{};
+    std::size_t log_end_{};
+  };
+
+  std::pair<edge_info_idx_t, edge_info*> create_edge_info(
+      std::int64_t osm_way_id, edge_type type, crossing_type crossing,
+      street_type street) {
+    auto const [idx, info] =
+        make_edge_info(edge_infos_, osm_way_id, type, street, crossing);
+    return {idx | LOCAL_INFO_BIT, info};
+  }
+
+  edge_info const* info(
+      edge_info_idx_t const idx,
+      data::vector_map<edge_info_idx_t, edge_info> const& global) const {
+    return (idx & LOCAL_INFO_BIT) != 0 ? &edge_infos_[idx & ~LOCAL_INFO_BIT]
+                                       : &global[idx];
+  }
+
+  void finish_junction(std::uint32_t const node_idx) {
+    auto const prev = junctions_.empty() ? junction{} : junctions_.back();
+    auto const log_end = static_cast<std::size_t>(log_.tellp());
+    if (prev.infos_end_ != edge_infos_.size() ||
+        prev.nodes_end_ != nodes_.size() || prev.log_end_ != log_end) {
+      junctions_.push_back(
+          {node_idx, edge_infos_.size(), nodes_.size(), log_end});
+    }
+  }
+
+  data::vector_map<edge_info_idx_t, edge_info> edge_infos_;
+  std::vector<data::unique_ptr<node>> nodes_;
+  std::vector<junction> junctions_;
+  std::ostringstream log_;
+  std::size_t n_crossings_created_{};
+  std::size_t n_path_join_failed_same_{};
+  std::size_t n_path_join_failed_diff_{};
+};
+
 struct preprocessor {
   preprocessor(int_graph& ig, options const& opt, logging& log,
                statistics& stats)
@@ -56,39 +107,158 @@ struct preprocessor {
   }
 
 private:
+  static constexpr auto const JUNCTION_CHUNK_SIZE = std::size_t{2048};
+  static constexpr auto const EDGE_CHUNK_SIZE = std::size_t{16384};
+
+  // Junctions are handled in parallel rounds (see junction_rounds). Each
+  // worker thread writes into its own buffer (reused for all rounds), the
+  // buffers are merged in node order afterwards, so the result is identical
+  // to a serial run.
   void handle_junctions() {
     step_progress progress{log_, pp_step::RG_JUNCTIONS, ig_.nodes_.size()};
-    for (auto const& n : ig_.nodes_) {
-      visit_node(n.get());
-      progress.add();
+
+    auto buffers = std::vector<junction_buffer>(thread_count());
+    for (auto const& round : junction_rounds()) {
+      auto const chunk_count =
+          (round.size() + JUNCTION_CHUNK_SIZE - 1) / JUNCTION_CHUNK_SIZE;
+      auto const handle_chunk = [&](std::size_t const worker,
+                                    std::size_t const chunk) {
+        auto const first = chunk * JUNCTION_CHUNK_SIZE;
+        auto const last = std::min(round.size(), first + JUNCTION_CHUNK_SIZE);
+        for (auto i = first; i < last; ++i) {
+          visit_node(buffers[worker], round[i]);
+        }
+      };
+      if (chunk_count == 1) {
+        handle_chunk(0, 0);
+      } else {
+        parallel_for_workers(chunk_count, handle_chunk);
+      }
+      progress.add(round.size());
+    }
+
+    merge_junction_buffers(buffers);
+  }
+
+  // Handling a junction modifies the sidewalk paths of its edges, so the
+  // two junctions of an edge have to be handled in node order (as in a
+  // serial run). A node is assigned to round 1 + the highest round of its
+  // neighbors with a lower index. Nodes in the same round are not adjacent.
+  std::vector<std::vector<std::uint32_t>> junction_rounds() {
+    auto rounds = std::vector<std::vector<std::uint32_t>>{};
+    for (auto i = std::size_t{0}; i < ig_.nodes_.size(); ++i) {
+      auto& n = ig_.nodes_[i];
+      auto round = std::uint32_t{0};
+      auto const visit = [&](int_node const* other) {
+        // neighbors with a higher index (and n itself) have no round yet
+        if (other->junction_round_ != NO_JUNCTION_ROUND) {
+          round = std::max(round, other->junction_round_ + 1);
+        }
+      };
+      for (auto const* e : n.out_edges_) {
+        visit(e->to_);
+      }
+      for (auto const* e : n.in_edges_) {
+        visit(e->from_);
+      }
+      n.junction_round_ = round;
+      if (round >= rounds.size()) {
+        rounds.resize(round + 1);
+      }
+      rounds[round].push_back(static_cast<std::uint32_t>(i));
     }
+    return rounds;
   }
 
-  void visit_node(int_node* in) {
+  void merge_junction_buffers(std::vector<junction_buffer>& buffers) {
+    struct junction_ref {
+      std::uint32_t node_idx_;
+      std::uint32_t buffer_;
+      std::uint32_t junction_;
+    };
+
+    auto refs = std::vector<junction_ref>{};
+    for (auto b = 0U; b < buffers.size(); ++b) {
+      for (auto j = 0U; j < buffers[b].junctions_.size(); ++j) {
+        refs.push_back({buffers[b].junctions_[j].node_idx_, b, j});
+      }
+    }
+    parallel_sort(refs, [](junction_ref const& a, junction_ref const& b) {
+      return a.node_idx_ < b.node_idx_;
+    });
+
+    auto logs = std::vector<std::string>(buffers.size());
+    auto info_maps = std::vector<std::vector<edge_info_idx_t>>(buffers.size());
+    for (auto b = 0U; b < buffers.size(); ++b) {
+      logs[b] = buffers[b].log_.str();
+      info_maps[b].resize(buffers[b].edge_infos_.size());
+      stats_.routing_.n_crossings_created_ += buffers[b].n_crossings_created_;
+      stats_.routing_.n_path_join_failed_same_ +=
+          buffers[b].n_path_join_failed_same_;
+      stats_.routing_.n_path_join_failed_diff_ +=
+          buffers[b].n_path_join_failed_diff_;
+    }
+
+    for (auto const& ref : refs) {
+      auto& buf = buffers[ref.buffer_];
+      auto& info_map = info_maps[ref.buffer_];
+      auto const& j = buf.junctions_[ref.junction_];
+      auto const prev = ref.junction_ == 0
+                            ? junction_buffer::junction{}
+                            : buf.junctions_[ref.junction_ - 1];
+
+      for (auto i = prev.infos_end_; i < j.infos_end_; ++i) {
+        info_map[i] = static_cast<edge_info_idx_t>(ig_.edge_infos_.size());
+        ig_.edge_infos_.emplace_back(buf.edge_infos_[i]);
+      }
+
+      for (auto i = prev.nodes_end_; i < j.nodes_end_; ++i) {
+        auto& n = buf.nodes_[i];
+        n->id_ = ++rg_.data_->max_node_id_;
+        for (auto& e : n->out_edges_) {
+          if ((e->info_ & junction_buffer::LOCAL_INFO_BIT) != 0) {
+            e->info_ = info_map[e->info_ & ~junction_buffer::LOCAL_INFO_BIT];
+          }
+        }
+        rg_.data_->nodes_.emplace_back(std::move(n));
+      }
+
+      if (j.log_end_ != prev.log_end_) {
+        log_.out() << std::string_view{logs[ref.buffer_]}.substr(
+            prev.log_end_, j.log_end_ - prev.log_end_);
+      }
+    }
+  }
+
+  void visit_node(junction_buffer& buf, std::uint32_t const node_idx) {
+    auto* in = &ig_.nodes_[node_idx];
     auto edges = edges_sorted_by_angle(in);
 
     if (edges.empty()) {
       return;
     }
 
-    handle_junction(in, edges);
+    handle_junction(buf, in, edges);
+    buf.finish_junction(node_idx);
   }
 
-  void handle_junction(int_node* in,
+  void handle_junction(junction_buffer& buf, int_node* in,
                        std::vector<oriented_int_edge>& sorted_edges) {
 
     std::optional<edge_info_idx_t> special_edge_info_idx;
     if (in->is_special_node() && sorted_edges.size() > 1) {
       if (in->elevator_) {
-        auto [info_idx, info] =
-            create_edge_info(-in->osm_id_, edge_type::ELEVATOR);
+        auto [info_idx, info] = buf.create_edge_info(
+            -in->osm_id_, edge_type::ELEVATOR, crossing_type::GENERATED,
+            street_type::NONE);
         info->max_width_ = in->max_width_;
         info->levels_ = in->levels_;
         special_edge_info_idx = info_idx;
 
       } else if (in->entrance_) {
-        auto [info_idx, info] =
-            create_edge_info(-in->osm_id_, edge_type::ENTRANCE);
+        auto [info_idx, info] = buf.create_edge_info(
+            -in->osm_id_, edge_type::ENTRANCE, crossing_type::GENERATED,
+            street_type::NONE);
         info->door_type_ = in->door_type_;
         info->automatic_door_type_ = in->automatic_door_type_;
         info->max_width_ = in->max_width_;
@@ -96,8 +266,9 @@ private:
         special_edge_info_idx = info_idx;
 
       } else if (in->cycle_barrier_) {
-        auto [info_idx, info] =
-            create_edge_info(-in->osm_id_, edge_type::CYCLE_BARRIER);
+        auto [info_idx, info] = buf.create_edge_info(
+            -in->osm_id_, edge_type::CYCLE_BARRIER, crossing_type::GENERATED,
+            street_type::NONE);
         info->max_width_ = in->max_width_;
         info->levels_ = in->levels_;
         special_edge_info_idx = info_idx;
@@ -105,8 +276,8 @@ private:
     }
 
     if (should_generate_crossing_at_node(in, sorted_edges)) {
-      auto [info_idx, info] =
-          create_edge_info(-in->osm_id_, edge_type::CROSSING, in->crossing_);
+      auto [info_idx, info] = buf.create_edge_info(
+          -in->osm_id_, edge_type::CROSSING, in->crossing_, street_type::NONE);
 
       if (in->crossing_edge_info_ != NO_EDGE_INFO) {
         auto const& cei = ig_.edge_infos_.at(in->crossing_edge_info_);
@@ -118,14 +289,15 @@ private:
     }
 
     if (special_edge_info_idx) {
-      connect_edges_at_special_node(in, sorted_edges, *special_edge_info_idx);
+      connect_edges_at_special_node(buf, in, sorted_edges,
+                                    *special_edge_info_idx);
     } else {
       // TODO(pablo): disabled for now (removes too many edges)
       //      detect_streets_inside_linked_streets(in, sorted_edges);
-      connect_streets_at_junction(in, sorted_edges);
-      connect_footpaths_at_junction(in, sorted_edges);
+      connect_streets_at_junction(buf, in, sorted_edges);
+      connect_footpaths_at_junction(buf, in, sorted_edges);
     }
-    create_crossings_at_junction(in, sorted_edges);
+    create_crossings_at_junction(buf, in, sorted_edges);
   }
 
   bool should_generate_crossing_at_node(
@@ -177,7 +349,8 @@ private:
   }
 
   void connect_streets_at_junction(
-      int_node const* in, std::vector<oriented_int_edge>& sorted_edges) {
+      junction_buffer& buf, int_node const* in,
+      std::vector<oriented_int_edge>& sorted_edges) {
     if (in->street_edges_ == 1) {
       auto e = std::find_if(
           begin(sorted_edges), end(sorted_edges),
@@ -185,12 +358,12 @@ private:
       assert(e != end(sorted_edges));
       if (has_sidewalk(*e, side_type::LEFT)) {
         auto const& mc = first_path_pt(*e, side_type::LEFT);
-        auto* n = create_node(in->osm_id_, mc);
+        auto* n = create_node(buf, in->osm_id_, mc);
         set_node(ig_, *e, side_type::LEFT, n);
       }
       if (has_sidewalk(*e, side_type::RIGHT)) {
         auto const& mc = first_path_pt(*e, side_type::RIGHT);
-        auto* n = create_node(in->osm_id_, mc);
+        auto* n = create_node(buf, in->osm_id_, mc);
         set_node(ig_, *e, side_type::RIGHT, n);
       }
     } else {
@@ -199,25 +372,26 @@ private:
           [this](oriented_int_edge& e1) {
             return is_street(ig_, e1) && !is_ignored(e1);
           },
-          [this, in](oriented_int_edge& e1, oriented_int_edge& e2) {
+          [this, &buf, in](oriented_int_edge& e1, oriented_int_edge& e2) {
             if (!is_street(ig_, e2) || is_ignored(e2)) {
               return false;
             }
 
-            cut_junction_edges(in, e1, e2);
+            cut_junction_edges(buf, in, e1, e2);
             return true;
           });
     }
   }
 
   void connect_footpaths_at_junction(
-      int_node* in, std::vector<oriented_int_edge>& sorted_edges) {
+      junction_buffer& buf, int_node* in,
+      std::vector<oriented_int_edge>& sorted_edges) {
     if (in->footway_edges_ == 0) {
       return;
     }
 
     if (in->street_edges_ <= 1) {
-      auto* single_node = create_foot_node(in, in->location_);
+      auto* single_node = create_foot_node(buf, in, in->location_);
       for (auto& e : sorted_edges) {
         if (is_street(ig_, e)) {
           connect(single_node, rg_from(ig_, e, side_type::LEFT));
@@ -236,8 +410,8 @@ private:
         [this](oriented_int_edge& e1) {
           return !is_street(ig_, e1) && !is_ignored(e1);
         },
-        [this, in, &update_streets_required](oriented_int_edge& e1,
-                                             oriented_int_edge& e2) {
+        [this, &buf, in, &update_streets_required](oriented_int_edge& e1,
+                                                   oriented_int_edge& e2) {
           if (!is_street(ig_, e2) || is_ignored(e2)) {
             return false;
           }
@@ -246,7 +420,8 @@ private:
           auto& e2_path = sidewalk_path(e2, side_type::RIGHT);
           if (n == nullptr) {
             assert(!e2_path.empty());
-            n = create_foot_node(in, first_path_pt(e2, side_type::RIGHT));
+            n = create_foot_node(buf, in,
+                                 first_path_pt(e2, side_type::RIGHT));
             set_node(ig_, e2, side_type::RIGHT, n);
             update_streets_required = true;
           }
@@ -266,24 +441,25 @@ private:
   }
 
   void connect_edges_at_special_node(
-      int_node* in, std::vector<oriented_int_edge>& sorted_edges,
+      junction_buffer& buf, int_node* in,
+      std::vector<oriented_int_edge>& sorted_edges,
       edge_info_idx_t const info_idx) {
     for (auto& e : sorted_edges) {
       if (is_street(ig_, e)) {
         if (has_sidewalk(e, side_type::LEFT)) {
           auto const& mc = first_path_pt(e, side_type::LEFT);
-          auto* n = create_node(in->osm_id_, mc);
+          auto* n = create_node(buf, in->osm_id_, mc);
           set_node(ig_, e, side_type::LEFT, n);
         }
         if (has_sidewalk(e, side_type::RIGHT)) {
           auto const& mc = first_path_pt(e, side_type::RIGHT);
-          auto* n = create_node(in->osm_id_, mc);
+          auto* n = create_node(buf, in->osm_id_, mc);
           set_node(ig_, e, side_type::RIGHT, n);
         }
       } else {
         auto* n = rg_from(ig_, e, side_type::LEFT);
         if (n == nullptr) {
-          n = create_foot_node(in, in->location_);
+          n = create_foot_node(buf, in, in->location_);
           set_node(ig_, e, side_type::LEFT, n);
         }
       }
@@ -334,8 +510,8 @@ private:
 
   void connect_linked_crossings(step_progress& progress) {
     for (auto& n : ig_.nodes_) {
-      if (n->generated_crossing_edges_) {
-        auto* in = n.get();
+      if (n.generated_crossing_edges_) {
+        auto* in = &n;
         auto edges = edges_sorted_by_angle(in);
         connect_crossing_edges_at_junction(in, edges);
       }
@@ -401,27 +577,29 @@ private:
   }
 
   void create_crossings_at_junction(
-      int_node const* in, std::vector<oriented_int_edge> const& sorted_edges) {
+      junction_buffer& buf, int_node const* in,
+      std::vector<oriented_int_edge> const& sorted_edges) {
     for (auto const& se : sorted_edges) {
-      create_crossing(in, se);
+      create_crossing(buf, in, se);
     }
   }
 
-  void create_crossing(int_node const* in, oriented_int_edge const& se) {
+  void create_crossing(junction_buffer& buf, int_node const* in,
+                       oriented_int_edge const& se) {
     if (is_ignored(se)) {
       return;
     }
     auto* from_node = rg_from(ig_, se, side_type::LEFT);
     auto* to_node = rg_from(ig_, se, side_type::RIGHT);
     if ((from_node != nullptr) && (to_node != nullptr)) {
-      create_crossing(from_node, to_node, se.edge_->info_, in);
+      create_crossing(buf, from_node, to_node, se.edge_->info_, in);
     }
   }
 
-  void create_crossing(node* from, node* to,
+  void create_crossing(junction_buffer& buf, node* from, node* to,
                        edge_info_idx_t crossed_edge_info_idx,
                        int_node const* in) {
-    if (has_crossing(from, to) || has_crossing(to, from)) {
+    if (has_crossing(buf, from, to) || has_crossing(buf, to, from)) {
       return;
     }
     auto type = in->crossing_;
@@ -434,22 +612,24 @@ private:
     auto const street_type = crossed_edge_info.street_type_;
     auto const name = crossed_edge_info.name_;
 
-    auto [info_idx, info] =
-        create_edge_info(osm_way_id, edge_type::CROSSING, type, street_type);
+    auto [info_idx, info] = buf.create_edge_info(
+        osm_way_id, edge_type::CROSSING, type, street_type);
     info->name_ = name;
     info->traffic_signals_sound_ = in->traffic_signals_sound_;
     info->traffic_signals_vibration_ = in->traffic_signals_vibration_;
     auto width = distance(from->location_, to->location_);
     from->out_edges_.emplace_back(
         data::make_unique<edge>(make_edge(info_idx, from, to, width)));
-    stats_.routing_.n_crossings_created_++;
+    buf.n_crossings_created_++;
   }
 
-  bool has_crossing(node const* from, node const* to) {
+  bool has_crossing(junction_buffer const& buf, node const* from,
+                    node const* to) const {
     return std::any_of(
-        begin(from->out_edges_), end(from->out_edges_), [this, to](auto&& e) {
+        begin(from->out_edges_), end(from->out_edges_), [&](auto&& e) {
           return e->to_ == to &&
-                 e->info(*edge_infos_)->type_ == edge_type::CROSSING;
+                 buf.info(e->info_, ig_.edge_infos_)->type_ ==
+                     edge_type::CROSSING;
         });
   }
 
@@ -458,8 +638,8 @@ private:
 
     sorted_edges.reserve(in->out_edges_.size() + in->in_edges_.size());
 
-    for (auto& ie : in->out_edges_) {
-      sorted_edges.emplace_back(ie.get(), false, ie->from_angle(false));
+    for (auto* ie : in->out_edges_) {
+      sorted_edges.emplace_back(ie, false, ie->from_angle(false));
     }
     for (auto* ie : in->in_edges_) {
       sorted_edges.emplace_back(ie, true, ie->from_angle(true));
@@ -470,8 +650,8 @@ private:
     return sorted_edges;
   }
 
-  node* cut_junction_edges(int_node const* center, oriented_int_edge& e1,
-                           oriented_int_edge& e2) {
+  node* cut_junction_edges(junction_buffer& buf, int_node const* center,
+                           oriented_int_edge& e1, oriented_int_edge& e2) {
     node* n = nullptr;
 
     auto e1_sidewalk = has_sidewalk(e1, side_type::LEFT);
@@ -491,21 +671,21 @@ private:
       auto intersection = joined.first;
       if (!joined.second) {
         if (opt_.print_warnings_) {
-          log_.out() << "could not join same edge - way "
+          buf.log_ << "could not join same edge - way "
                      << e1.edge_->info(ig_)->osm_way_id_
                      << ", e1_reverse = " << e1.reverse_
                      << ", e2_reverse = " << e2.reverse_ << std::endl;
         }
-        stats_.routing_.n_path_join_failed_same_++;
+        buf.n_path_join_failed_same_++;
       }
       if (!e1_sidewalk || !e2_sidewalk) {
         if (opt_.print_warnings_) {
-          log_.out() << "skipping node creation because of no sidewalks!"
-                     << std::endl;
+          buf.log_ << "skipping node creation because of no sidewalks!"
+                   << std::endl;
         }
         return n;
       }
-      n = create_node(center->osm_id_, intersection);
+      n = create_node(buf, center->osm_id_, intersection);
     } else {
       auto joined = join_paths(e1_path, e1.reverse_, e2_path, e2.reverse_,
                                center->location_);
@@ -513,14 +693,14 @@ private:
       if (!joined.second) {
         // TODO(pablo):
         if (opt_.print_warnings_) {
-          log_.out() << "could not join ways "
+          buf.log_ << "could not join ways "
                      << e1.edge_->info(ig_)->osm_way_id_ << " and "
                      << e2.edge_->info(ig_)->osm_way_id_ << " at node "
                      << center->osm_id_ << std::endl;
         }
-        stats_.routing_.n_path_join_failed_diff_++;
+        buf.n_path_join_failed_diff_++;
       }
-      n = create_node(center->osm_id_, intersection);
+      n = create_node(buf, center->osm_id_, intersection);
     }
 
     assert(n != nullptr);
@@ -535,28 +715,42 @@ private:
     return n;
   }
 
+  using new_edge = std::pair<node*, data::unique_ptr<edge>>;
+
+  // edges are created in parallel, but added to their nodes in node order
   void create_edges() {
     step_progress progress{log_, pp_step::RG_EDGES, ig_.nodes_.size()};
-    for (auto const& n : ig_.nodes_) {
-      visit_edges(n.get());
-      progress.add();
-    }
-  }
-
-  void visit_edges(int_node* in) {
-    for (auto& ie : in->out_edges_) {
-      visit_edge(*ie);
+    auto const node_count = ig_.nodes_.size();
+    auto const chunk_count =
+        (node_count + EDGE_CHUNK_SIZE - 1) / EDGE_CHUNK_SIZE;
+    auto chunks = std::vector<std::vector<new_edge>>(chunk_count);
+    parallel_for_workers(chunk_count, [&](std::size_t,
+                                          std::size_t const chunk) {
+      auto const first = chunk * EDGE_CHUNK_SIZE;
+      auto const last = std::min(node_count, first + EDGE_CHUNK_SIZE);
+      for (auto i = first; i < last; ++i) {
+        for (auto* ie : ig_.nodes_[i].out_edges_) {
+          visit_edge(*ie, chunks[chunk]);
+        }
+      }
+      progress.add(last - first);
+    });
+    for (auto& edges : chunks) {
+      for (auto& [from, e] : edges) {
+        from->out_edges_.emplace_back(std::move(e));
+      }
     }
   }
 
-  void visit_edge(int_edge& ie) const {
+  void visit_edge(int_edge& ie, std::vector<new_edge>& out) const {
     if (ie.ignore_) {
       return;
     }
     if (ie.generate_sidewalks(ig_)) {
       if (ie.sidewalk_left_ && ie.from_left_ != nullptr &&
           ie.to_left_ != nullptr) {
-        ie.from_left_->out_edges_.emplace_back(
+        out.emplace_back(
+            ie.from_left_,
             data::make_unique<edge>(make_edge(
                 ie.info_, ie.from_left_, ie.to_left_,
                 path_length(ie.path_left_), to_location_vector(ie.path_left_),
@@ -564,7 +758,8 @@ private:
       }
       if (ie.sidewalk_right_ && (ie.from_right_ != nullptr) &&
           (ie.to_right_ != nullptr)) {
-        ie.from_right_->out_edges_.emplace_back(
+        out.emplace_back(
+            ie.from_right_,
             data::make_unique<edge>(make_edge(
                 ie.info_, ie.from_right_, ie.to_right_,
                 path_length(ie.path_right_), to_location_vector(ie.path_right_),
@@ -572,7 +767,8 @@ private:
       }
     } else {
       if ((ie.from_left_ != nullptr) && (ie.to_left_ != nullptr)) {
-        ie.from_left_->out_edges_.emplace_back(
+        out.emplace_back(
+            ie.from_left_,
             data::make_unique<edge>(make_edge(
                 ie.info_, ie.from_left_, ie.to_left_,
                 path_length(ie.path_left_), to_location_vector(ie.path_left_),
@@ -603,15 +799,18 @@ private:
     return angle > PI / 2 && angle < PI * 3 / 2;
   }
 
-  struct node* create_node(std::int64_t osm_id, merc const& mc) {
+  // node ids are assigned when the junction buffers are merged
+  static struct node* create_node(junction_buffer& buf, std::int64_t osm_id,
+                                  merc const& mc) {
     auto const loc = to_location(mc);
-    rg_.data_->nodes_.emplace_back(data::make_unique<struct node>(
-        make_node(++rg_.data_->max_node_id_, osm_id, loc)));
-    return rg_.data_->nodes_.back().get();
+    buf.nodes_.emplace_back(
+        data::make_unique<struct node>(make_node(0, osm_id, loc)));
+    return buf.nodes_.back().get();
   }
 
-  struct node* create_foot_node(int_node* in, merc const& mc) {
-    auto* n = create_node(in->osm_id_, mc);
+  static struct node* create_foot_node(junction_buffer& buf, int_node* in,
+                                       merc const& mc) {
+    auto* n = create_node(buf, in->osm_id_, mc);
     if (in->rg_foot_node_ != nullptr) {
       if (distance(in->location_, mc) <
           distance(in->location_, to_merc(in->rg_foot_node_->location_))) {
@@ -3,6 +3,7 @@
 #include <functional>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <stdexcept>
 #include <unordered_map>
 
@@ -168,6 +169,10 @@ struct dem_grid::impl {
 
     auto const pix_x = static_cast<unsigned>((lon - ulx_) / xdim_);
     auto const pix_y = static_cast<unsigned>((uly_ - lat) / ydim_);
+    return get_pixel(pix_x, pix_y);
+  }
+
+  pixel_value get_pixel(unsigned const pix_x, unsigned const pix_y) {
     assert(pix_x < cols_);
     assert(pix_y < rows_);
     auto const byte_pos = row_size_ * pix_y + pixel_size_ * pix_x;
@@ -190,11 +195,12 @@ struct dem_grid::impl {
     return val;
   }
 
+  // thread safe: grids are queried from multiple threads
   void ensure_file_mapped() {
-    if (!mapped_file_.is_open()) {
+    std::call_once(mapped_once_, [&]() {
       // std::clog << "Using DEM grid file: " << data_file_ << std::endl;
       mapped_file_.open(data_file_);
-    }
+    });
   }
 
   unsigned rows_{0};
@@ -212,6 +218,7 @@ struct dem_grid::impl {
 
   std::string data_file_;
   ios::mapped_file_source mapped_file_;
+  std::once_flag mapped_once_;
 };
 
 dem_grid::dem_grid(std::string const& filename)
@@ -222,7 +229,14 @@ dem_grid::dem_grid(dem_grid&& grid) noexcept : impl_(std::move(grid.impl_)) {}
 dem_grid::~dem_grid() = default;
 
 elevation_t dem_grid::get(location const& loc) const {
-  auto const val = get_raw(loc);
+  return to_elevation(get_raw(loc));
+}
+
+elevation_t dem_grid::get_pixel(unsigned const col, unsigned const row) const {
+  return to_elevation(impl_->get_pixel(col, row));
+}
+
+elevation_t dem_grid::to_elevation(pixel_value const val) const {
   switch (impl_->pixel_type_) {
     case pixel_type::int16:
       if (val.int16_ == impl_->nodata_.int16_) {
@@ -246,4 +260,13 @@ pixel_value dem_grid::get_raw(location const& loc) const {
 
 pixel_type dem_grid::get_pixel_type() const { return impl_->pixel_type_; }
 
+dem_bounds dem_grid::bounds() const {
+  return {impl_->ulx_, impl_->bry_, impl_->brx_, impl_->uly_};
+}
+
+dem_raster dem_grid::raster() const {
+  return {impl_->rows_, impl_->cols_, impl_->ulx_, impl_->uly_, impl_->xdim_,
+          impl_->ydim_};
+}
+
 }  // namespace ppr::preprocessing::elevation
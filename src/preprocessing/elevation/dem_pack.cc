@@ -0,0 +1,204 @@
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "boost/iostreams/device/mapped_file.hpp"
+
+#include "zlib.h"
+
+#include "ppr/preprocessing/elevation/dem_pack.h"
+
+namespace ios = boost::iostreams;
+
+namespace ppr::preprocessing::elevation {
+
+using dem_exception = std::runtime_error;
+
+namespace {
+
+inline std::uint16_t zigzag(std::uint16_t const delta) {
+  return static_cast<std::uint16_t>(
+      static_cast<std::uint16_t>(delta << 1U) ^
+      static_cast<std::uint16_t>(static_cast<std::int16_t>(delta) >> 15));
+}
+
+inline std::uint16_t unzigzag(std::uint16_t const z) {
+  return static_cast<std::uint16_t>((z >> 1U) ^
+                                    static_cast<std::uint16_t>(-(z & 1U)));
+}
+
+}  // namespace
+
+std::vector<std::uint8_t> encode_dem_tile(
+    std::vector<elevation_t> const& values, unsigned const width) {
+  auto const n = values.size();
+  auto raw = std::vector<std::uint8_t>(2 * n);
+  auto row_first = std::uint16_t{0};
+  auto prev = std::uint16_t{0};
+  for (auto i = std::size_t{0}; i < n; ++i) {
+    auto const v = static_cast<std::uint16_t>(values[i]);
+    auto const row_start = i % width == 0;
+    auto const z = zigzag(
+        static_cast<std::uint16_t>(v - (row_start ? row_first : prev)));
+    if (row_start) {
+      row_first = v;
+    }
+    prev = v;
+    raw[i] = static_cast<std::uint8_t>(z & 0xFFU);
+    raw[n + i] = static_cast<std::uint8_t>(z >> 8U);
+  }
+
+  auto out = std::vector<std::uint8_t>(compressBound(raw.size()));
+  auto out_size = static_cast<uLongf>(out.size());
+  if (compress2(out.data(), &out_size, raw.data(),
+                static_cast<uLong>(raw.size()), Z_BEST_COMPRESSION) != Z_OK) {
+    throw dem_exception{"dem pack: tile compression failed"};
+  }
+  out.resize(out_size);
+  return out;
+}
+
+void decode_dem_tile(std::uint8_t const* data, std::size_t const size,
+                     unsigned const width, std::vector<elevation_t>& values) {
+  auto const n = values.size();
+  thread_local auto raw = std::vector<std::uint8_t>{};
+  raw.resize(2 * n);
+  auto raw_size = static_cast<uLongf>(raw.size());
+  if (uncompress(raw.data(), &raw_size, data, static_cast<uLong>(size)) !=
+          Z_OK ||
+      raw_size != raw.size()) {
+    throw dem_exception{"dem pack: invalid tile data"};
+  }
+
+  auto row_first = std::uint16_t{0};
+  auto prev = std::uint16_t{0};
+  for (auto i = std::size_t{0}; i < n; ++i) {
+    auto const z = static_cast<std::uint16_t>(
+        raw[i] | static_cast<std::uint16_t>(raw[n + i] << 8U));
+    auto const row_start = i % width == 0;
+    auto const v = static_cast<std::uint16_t>((row_start ? row_first : prev) +
+                                              unzigzag(z));
+    if (row_start) {
+      row_first = v;
+    }
+    prev = v;
+    values[i] = static_cast<elevation_t>(v);
+  }
+}
+
+struct dem_pack::impl {
+  impl(std::string const& filename, dem_tile_cache& cache)
+      : cache_{cache}, key_base_{cache.next_key_base()} {
+    file_.open(filename);
+    auto pos = std::size_t{0};
+    header_ = read<dem_pack_header>(pos);
+    if (header_.magic_ != DEM_PACK_MAGIC) {
+      throw dem_exception{"dem pack: invalid file: " + filename};
+    }
+    if (header_.version_ != DEM_PACK_VERSION) {
+      throw dem_exception{"dem pack: unsupported version: " + filename};
+    }
+    if (header_.tile_size_ == 0) {
+      throw dem_exception{"dem pack: invalid tile size: " + filename};
+    }
+
+    auto tile_count = std::uint64_t{0};
+    for (auto i = 0U; i < header_.grid_count_; ++i) {
+      auto const& g = grids_.emplace_back(read<dem_pack_grid>(pos));
+      if (g.first_tile_ != tile_count) {
+        throw dem_exception{"dem pack: invalid tile directory: " + filename};
+      }
+      auto const ts = header_.tile_size_;
+      tile_count +=
+          static_cast<std::uint64_t>(g.tile_cols(ts)) * g.tile_rows(ts);
+    }
+
+    tiles_.resize(tile_count);
+    for (auto& t : tiles_) {
+      t = read<dem_pack_tile>(pos);
+      if (t.offset_ + t.size_ > file_.size()) {
+        throw dem_exception{"dem pack: truncated file: " + filename};
+      }
+    }
+  }
+
+  template <typename T>
+  T read(std::size_t& pos) const {
+    if (pos + sizeof(T) > file_.size()) {
+      throw dem_exception{"dem pack: truncated file"};
+    }
+    auto val = T{};
+    std::memcpy(&val, file_.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return val;
+  }
+
+  dem_bounds bounds(std::size_t const grid_idx) const {
+    auto const& r = grids_[grid_idx].raster_;
+    return {r.ulx_, r.uly_ - r.rows_ * r.ydim_, r.ulx_ + r.cols_ * r.xdim_,
+            r.uly_};
+  }
+
+  elevation_t get(std::size_t const grid_idx, location const& loc) const {
+    auto const& g = grids_[grid_idx];
+    auto const& r = g.raster_;
+    auto const lon = loc.lon();
+    auto const lat = loc.lat();
+    auto const b = bounds(grid_idx);
+    if (lon < b.min_lon_ || lat > b.max_lat_ || lon > b.max_lon_ ||
+        lat < b.min_lat_) {
+      return NO_ELEVATION_DATA;
+    }
+
+    auto const ts = header_.tile_size_;
+    auto const pix_x =
+        std::min(static_cast<unsigned>((lon - r.ulx_) / r.xdim_), r.cols_ - 1);
+    auto const pix_y =
+        std::min(static_cast<unsigned>((r.uly_ - lat) / r.ydim_), r.rows_ - 1);
+    auto const tile_x = pix_x / ts;
+    auto const tile_y = pix_y / ts;
+    auto const tile_idx =
+        g.first_tile_ +
+        static_cast<std::uint64_t>(tile_y) * g.tile_cols(ts) + tile_x;
+    auto const& t = tiles_[tile_idx];
+    if (t.size_ == 0) {
+      return NO_ELEVATION_DATA;
+    }
+
+    auto const width = std::min(ts, r.cols_ - tile_x * ts);
+    auto const height = std::min(ts, r.rows_ - tile_y * ts);
+    auto const values = cache_.get(key_base_ | tile_idx, [&]() {
+      auto decoded = dem_tile_cache::tile(width * height);
+      decode_dem_tile(
+          reinterpret_cast<std::uint8_t const*>(file_.data()) + t.offset_,
+          t.size_, width, decoded);
+      return decoded;
+    });
+    return (*values)[(pix_y - tile_y * ts) * width + (pix_x - tile_x * ts)];
+  }
+
+  dem_tile_cache& cache_;
+  std::uint64_t key_base_;
+  ios::mapped_file_source file_;
+  dem_pack_header header_;
+  std::vector<dem_pack_grid> grids_;
+  std::vector<dem_pack_tile> tiles_;
+};
+
+dem_pack::dem_pack(std::string const& filename, dem_tile_cache& cache)
+    : impl_(std::make_unique<impl>(filename, cache)) {}
+
+dem_pack::~dem_pack() = default;
+
+std::size_t dem_pack::grid_count() const { return impl_->grids_.size(); }
+
+dem_bounds dem_pack::bounds(std::size_t const grid_idx) const {
+  return impl_->bounds(grid_idx);
+}
+
+elevation_t dem_pack::get(std::size_t const grid_idx,
+                          location const& loc) const {
+  return impl_->get(grid_idx, loc);
+}
+
+}  // namespace ppr::preprocessing::elevation
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+
+#include "boost/algorithm/string/case_conv.hpp"
+#include "boost/filesystem.hpp"
+
+#include "utl/parallel_for.h"
+
+#include "ppr/preprocessing/elevation/dem_pack.h"
+
+namespace fs = boost::filesystem;
+
+namespace ppr::preprocessing::elevation {
+
+namespace {
+
+std::vector<std::string> find_grid_files(
+    std::vector<std::string> const& input_files) {
+  auto files = std::vector<std::string>{};
+  for (auto const& input : input_files) {
+    auto const path = fs::path{input};
+    if (fs::is_directory(path)) {
+      for (auto const& de : fs::directory_iterator(path)) {
+        if (boost::to_lower_copy(de.path().extension().string()) == ".hdr") {
+          files.emplace_back(de.path().string());
+        }
+      }
+    } else {
+      files.emplace_back(input);
+    }
+  }
+  return files;
+}
+
+template <typename T>
+void write(std::ofstream& out, T const& val) {
+  out.write(reinterpret_cast<char const*>(&val), sizeof(T));
+}
+
+}  // namespace
+
+void write_dem_pack(std::vector<std::string> const& input_files,
+                    std::string const& output_file, unsigned const tile_size,
+                    std::ostream& log) {
+  if (tile_size == 0) {
+    throw std::runtime_error{"dem pack: invalid tile size"};
+  }
+
+  auto grids = std::vector<dem_grid>{};
+  auto pack_grids = std::vector<dem_pack_grid>{};
+  auto tile_count = std::uint64_t{0};
+  for (auto const& file : find_grid_files(input_files)) {
+    auto const& grid = grids.emplace_back(file);
+    auto& pg = pack_grids.emplace_back();
+    pg.raster_ = grid.raster();
+    pg.first_tile_ = tile_count;
+    tile_count += static_cast<std::uint64_t>(pg.tile_cols(tile_size)) *
+                  pg.tile_rows(tile_size);
+  }
+
+  auto out = std::ofstream{output_file, std::ios::binary | std::ios::trunc};
+  if (!out) {
+    throw std::runtime_error{"dem pack: could not open output file: " +
+                             output_file};
+  }
+  out.exceptions(std::ios::failbit | std::ios::badbit);
+
+  auto header = dem_pack_header{};
+  header.tile_size_ = tile_size;
+  header.grid_count_ = static_cast<std::uint32_t>(grids.size());
+  write(out, header);
+  for (auto const& pg : pack_grids) {
+    write(out, pg);
+  }
+
+  // the tile directory is written after all tiles are known
+  auto const directory_pos = static_cast<std::uint64_t>(out.tellp());
+  auto tiles = std::vector<dem_pack_tile>(tile_count);
+  auto offset = directory_pos + tile_count * sizeof(dem_pack_tile);
+  out.seekp(static_cast<std::streamoff>(offset));
+
+  auto raw_size = std::uint64_t{0};
+  for (auto grid_idx = std::size_t{0}; grid_idx < grids.size(); ++grid_idx) {
+    auto const& grid = grids[grid_idx];
+    auto const& pg = pack_grids[grid_idx];
+    auto const& r = pg.raster_;
+    auto const tile_cols = pg.tile_cols(tile_size);
+    log << "Packing DEM grid " << (grid_idx + 1) << "/" << grids.size() << ": "
+        << r.cols_ << "x" << r.rows_ << " pixels, " << tile_cols << "x"
+        << pg.tile_rows(tile_size) << " tiles" << std::endl;
+
+    // tiles of a tile row are encoded in parallel and written in order
+    for (auto tile_y = 0U; tile_y < pg.tile_rows(tile_size); ++tile_y) {
+      auto encoded = std::vector<std::vector<std::uint8_t>>(tile_cols);
+      utl::parallel_for_run(tile_cols, [&](std::size_t const tile_x) {
+        auto const x0 = static_cast<unsigned>(tile_x) * tile_size;
+        auto const y0 = tile_y * tile_size;
+        auto const width = std::min(tile_size, r.cols_ - x0);
+        auto const height = std::min(tile_size, r.rows_ - y0);
+        auto values = std::vector<elevation_t>{};
+        values.reserve(width * height);
+        auto has_data = false;
+        for (auto y = y0; y < y0 + height; ++y) {
+          for (auto x = x0; x < x0 + width; ++x) {
+            auto const val = grid.get_pixel(x, y);
+            has_data = has_data || val != NO_ELEVATION_DATA;
+            values.push_back(val);
+          }
+        }
+        if (has_data) {
+          encoded[tile_x] = encode_dem_tile(values, width);
+        }
+      });
+
+      for (auto tile_x = 0U; tile_x < tile_cols; ++tile_x) {
+        auto const& data = encoded[tile_x];
+        auto& t = tiles[pg.first_tile_ +
+                        static_cast<std::uint64_t>(tile_y) * tile_cols +
+                        tile_x];
+        if (data.empty()) {
+          continue;
+        }
+        t.offset_ = offset;
+        t.size_ = static_cast<std::uint32_t>(data.size());
+        out.write(reinterpret_cast<char const*>(data.data()),
+                  static_cast<std::streamsize>(data.size()));
+        offset += data.size();
+      }
+    }
+    raw_size += static_cast<std::uint64_t>(r.cols_) * r.rows_ *
+                sizeof(elevation_t);
+  }
+
+  out.seekp(static_cast<std::streamoff>(directory_pos));
+  for (auto const& t : tiles) {
+    write(out, t);
+  }
+  out.close();
+
+  log << "DEM pack written: " << output_file << " (" << (offset >> 20U)
+      << " MiB, " << (raw_size >> 20U) << " MiB uncompressed int16)"
+      << std::endl;
+}
+
+}  // namespace ppr::preprocessing::elevation
@@ -1,38 +1,106 @@
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <deque>
+#include <utility>
 #include <vector>
 
 #include "boost/algorithm/string/case_conv.hpp"
 #include "boost/filesystem.hpp"
 
+#include "ppr/common/parallel.h"
 #include "ppr/preprocessing/elevation/dem_grid.h"
+#include "ppr/preprocessing/elevation/dem_pack.h"
 #include "ppr/preprocessing/elevation/dem_source.h"
 
 namespace fs = boost::filesystem;
 
 namespace ppr::preprocessing::elevation {
 
+// DEM grids (bil files and grids of dem packs) are indexed by 1x1 degree
+// cells. Each cell stores the grids overlapping it, in the order they were
+// added (the first grid with data for a location wins).
+constexpr auto const INDEX_COLS = 360;
+constexpr auto const INDEX_ROWS = 180;
+
+inline int index_col(double const lon) {
+  return std::clamp(static_cast<int>(std::floor(lon)) + 180, 0,
+                    INDEX_COLS - 1);
+}
+
+inline int index_row(double const lat) {
+  return std::clamp(static_cast<int>(std::floor(lat)) + 90, 0,
+                    INDEX_ROWS - 1);
+}
+
+inline std::uint32_t index_cell(location const& loc) {
+  return static_cast<std::uint32_t>(index_row(loc.lat()) * INDEX_COLS +
+                                    index_col(loc.lon()));
+}
+
 struct dem_source::impl {
-  impl() = default;
+  // a bil grid or a grid of a dem pack
+  struct grid_ref {
+    elevation_t get(location const& loc) const {
+      return grid_ != nullptr ? grid_->get(loc) : pack_->get(pack_grid_, loc);
+    }
+
+    dem_grid const* grid_{};
+    dem_pack const* pack_{};
+    std::size_t pack_grid_{};
+  };
+
+  explicit impl(std::size_t const max_tile_cache_memory)
+      : cells_(INDEX_COLS * INDEX_ROWS), tile_cache_{max_tile_cache_memory} {}
 
   void add_file(std::string const& filename) {
     auto const path = fs::path{filename};
     if (fs::is_directory(path)) {
       for (auto const& de : fs::directory_iterator(path)) {
-        if (boost::to_lower_copy(de.path().extension().string()) == ".hdr") {
+        auto const ext = boost::to_lower_copy(de.path().extension().string());
+        if (ext == ".hdr") {
           add_grid_file(de.path());
+        } else if (ext == DEM_PACK_EXTENSION) {
+          add_pack_file(de.path());
         }
       }
+    } else if (boost::to_lower_copy(path.extension().string()) ==
+               DEM_PACK_EXTENSION) {
+      add_pack_file(path);
     } else {
       add_grid_file(path);
     }
   }
 
   void add_grid_file(fs::path const& path) {
-    grids_.emplace_back(path.string());
+    auto const& grid = grids_.emplace_back(path.string());
+    add_grid(grid_ref{&grid, nullptr, 0}, grid.bounds());
+  }
+
+  void add_pack_file(fs::path const& path) {
+    auto const& pack = *packs_.emplace_back(
+        std::make_unique<dem_pack>(path.string(), tile_cache_));
+    for (auto i = std::size_t{0}; i < pack.grid_count(); ++i) {
+      add_grid(grid_ref{nullptr, &pack, i}, pack.bounds(i));
+    }
+  }
+
+  void add_grid(grid_ref const& ref, dem_bounds const& b) {
+    auto const grid_idx = static_cast<std::uint32_t>(refs_.size());
+    refs_.push_back(ref);
+    for (auto row = index_row(b.min_lat_); row <= index_row(b.max_lat_);
+         ++row) {
+      for (auto col = index_col(b.min_lon_); col <= index_col(b.max_lon_);
+           ++col) {
+        cells_[static_cast<std::size_t>(row * INDEX_COLS + col)].push_back(
+            grid_idx);
+      }
+    }
   }
 
-  elevation_t get(location const& loc) {
-    for (auto const& grid : grids_) {
-      auto const data = grid.get(loc);
+  elevation_t get(location const& loc) const {
+    for (auto const grid_idx : cells_[index_cell(loc)]) {
+      auto const data = refs_[grid_idx].get(loc);
       if (data != NO_ELEVATION_DATA) {
         return data;
       }
@@ -40,10 +108,34 @@ struct dem_source::impl {
     return NO_ELEVATION_DATA;
   }
 
-  std::vector<dem_grid> grids_;
+  std::vector<elevation_t> get(std::vector<location> const& locs) const {
+    auto order = std::vector<std::pair<std::uint32_t, std::uint32_t>>(
+        locs.size());
+    parallel_for_chunks(locs.size(), [&](std::size_t const i) {
+      order[i] = {index_cell(locs[i]), static_cast<std::uint32_t>(i)};
+    });
+    parallel_sort(order);
+
+    auto result = std::vector<elevation_t>(locs.size());
+    parallel_for_chunks(
+        order.size(),
+        [&](std::size_t const i) {
+          auto const idx = order[i].second;
+          result[idx] = get(locs[idx]);
+        },
+        4096);
+    return result;
+  }
+
+  std::deque<dem_grid> grids_;
+  std::vector<std::unique_ptr<dem_pack>> packs_;
+  std::vector<grid_ref> refs_;
+  std::vector<std::vector<std::uint32_t>> cells_;
+  mutable dem_tile_cache tile_cache_;
 };
 
-dem_source::dem_source() : impl_(std::make_unique<impl>()) {}
+dem_source::dem_source(std::size_t const max_tile_cache_memory)
+    : impl_(std::make_unique<impl>(max_tile_cache_memory)) {}
 
 dem_source::~dem_source() = default;
 
@@ -55,4 +147,9 @@ elevation_t dem_source::get(location const& loc) const {
   return impl_->get(loc);
 }
 
+std::vector<elevation_t> dem_source::get(
+    std::vector<location> const& locs) const {
+  return impl_->get(locs);
+}
+
 }  // namespace ppr::preprocessing::elevation
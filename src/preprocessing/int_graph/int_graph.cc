@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <iostream>
 
+#include "ppr/common/parallel.h"
 #include "ppr/common/timing.h"
 #include "ppr/preprocessing/int_graph/int_graph.h"
 #include "ppr/preprocessing/int_graph/sidewalks.h"
@@ -40,120 +41,168 @@ struct int_graph_builder {
   }
 
 private:
+  // osm edges between two int nodes that are merged into a single int edge
+  struct edge_chain {
+    osm_edge* edge_{};  // first edge, used for the edge attributes
+    osm_node* from_{};
+    osm_node* to_{};
+    std::vector<merc> path_left_;
+    std::vector<merc> path_right_;
+    std::size_t path_size_{};
+    double distance_{};
+    double from_angle_{};
+    double to_angle_{};
+    elevation_diff_t elevation_up_{};
+    elevation_diff_t elevation_down_{};
+    std::size_t n_compressed_edges_{};
+  };
+
+  static constexpr auto const CHAIN_CHUNK_SIZE = std::size_t{8192};
+
+  // 1. mark all nodes inside of chains (in parallel)
+  // 2. follow the chains starting at all other nodes (in parallel,
+  //    into chunk-local buffers)
+  // 3. create the int nodes and edges (in node order)
   void compress_edges() {
-    step_progress progress{log_, pp_step::INT_EDGES, og_.nodes_.size()};
+    auto const node_count = og_.nodes_.size();
+    step_progress progress{log_, pp_step::INT_EDGES, node_count * 2};
+
+    parallel_for_chunks(node_count, [&](std::size_t const i) {
+      auto& n = og_.nodes_[i];
+      n.compressed_ = is_chain_node(n);
+    });
+    progress.add(node_count);
+
+    auto const chunk_count =
+        (node_count + CHAIN_CHUNK_SIZE - 1) / CHAIN_CHUNK_SIZE;
+    auto chunks = std::vector<std::vector<edge_chain>>(chunk_count);
+    parallel_for_workers(chunk_count, [&](std::size_t,
+                                          std::size_t const chunk) {
+      auto const first = chunk * CHAIN_CHUNK_SIZE;
+      auto const last = std::min(node_count, first + CHAIN_CHUNK_SIZE);
+      for (auto i = first; i < last; ++i) {
+        auto& n = og_.nodes_[i];
+        if (!n.compressed_) {
+          for (auto& e : n.out_edges_) {
+            chunks[chunk].emplace_back(follow_chain(e));
+          }
+        }
+      }
+      progress.add(last - first);
+    });
+
+    for (auto& chains : chunks) {
+      for (auto& c : chains) {
+        add_int_edge(c);
+      }
+    }
+
+    // remaining edges are part of cycles that consist only of chain nodes
     for (auto& n : og_.nodes_) {
-      if (!n->compressed_) {
-        for (auto& e : n->out_edges_) {
-          handle_edge(e);
+      for (auto& e : n.out_edges_) {
+        if (!e.processed_) {
+          auto c = follow_cycle(e);
+          add_int_edge(c);
         }
       }
-      progress.add();
     }
   }
 
-  void handle_edge(osm_edge& oe) {
-    if (oe.processed_) {
-      return;
-    }
+  static bool same_edge_attrs(osm_edge const& a, osm_edge const& b) {
+    return a.info_ == b.info_ && a.sidewalk_left_ == b.sidewalk_left_ &&
+           a.sidewalk_right_ == b.sidewalk_right_ &&
+           (a.linked_left_ != nullptr) == (b.linked_left_ != nullptr) &&
+           (a.linked_right_ != nullptr) == (b.linked_right_ != nullptr);
+  }
 
-    elevation_diff_t elevation_up = 0;
-    elevation_diff_t elevation_down = 0;
-    edge_info* info = oe.info(og_);
-    assert(!(info->area_ && oe.generate_sidewalks(og_)));
-    auto const sidewalk_left = oe.sidewalk_left_;
-    auto const sidewalk_right = oe.sidewalk_right_;
-    auto const linked_left = oe.linked_left_ != nullptr;
-    auto const linked_right = oe.linked_right_ != nullptr;
-    auto* from = oe.from_;
-    auto* to = oe.to_;
-    std::vector<merc> path{from->location_, to->location_};
-    std::vector<osm_edge*> edges{&oe};
-    double distance = oe.distance_;
-    oe.processed_ = true;
-
-    auto const different_edge_attrs = [&](osm_edge* o) {
-      return o->info_ != oe.info_ || o->processed_ ||
-             o->sidewalk_left_ != sidewalk_left ||
-             o->sidewalk_right_ != sidewalk_right ||
-             (o->linked_left_ != nullptr) != linked_left ||
-             (o->linked_right_ != nullptr) != linked_right;
-    };
-
-    auto const update_elevation = [&](osm_edge const* e) {
-      elevation_up += e->elevation_up_;
-      elevation_down += e->elevation_down_;
-    };
-
-    auto* e = &oe;
-    update_elevation(e);
-    while (e->from_->can_be_compressed()) {
-      auto* prev = e->from_->in_edges_[0];
-      if (different_edge_attrs(prev)) {
-        break;
-      }
-      from->compressed_ = true;
-      e = prev;
-      from = e->from_;
-      path.insert(begin(path), from->location_);
-      edges.insert(begin(edges), e);
-      distance += e->distance_;
+  // chain nodes are removed: their in and out edge are merged
+  static bool is_chain_node(osm_node const& n) {
+    return n.can_be_compressed() &&
+           same_edge_attrs(*n.in_edges_[0], n.out_edges_[0]);
+  }
+
+  edge_chain follow_chain(osm_edge& first) const {
+    auto edges = std::vector<osm_edge*>{&first};
+    first.processed_ = true;
+    for (auto* e = &first; e->to_->compressed_;) {
+      e = &e->to_->out_edges_[0];
       e->processed_ = true;
-      update_elevation(e);
-      stats_.int_.n_compressed_edges_++;
+      edges.push_back(e);
     }
+    return make_chain(edges);
+  }
 
-    e = &oe;
-    while (e->to_->can_be_compressed()) {
-      auto& next = e->to_->out_edges_[0];
-      if (different_edge_attrs(&next)) {
-        break;
-      }
-      to->compressed_ = true;
-      e = &next;
-      to = e->to_;
-      path.push_back(to->location_);
-      edges.push_back(e);
-      distance += e->distance_;
+  edge_chain follow_cycle(osm_edge& first) const {
+    auto edges = std::vector<osm_edge*>{&first};
+    first.processed_ = true;
+    for (auto* e = &first.to_->out_edges_[0]; !e->processed_;
+         e = &e->to_->out_edges_[0]) {
       e->processed_ = true;
-      update_elevation(e);
-      stats_.int_.n_compressed_edges_++;
+      edges.push_back(e);
     }
+    return make_chain(edges);
+  }
 
-    auto* ig_from = get_or_create_node(from);
-    auto* ig_to = get_or_create_node(to);
-    auto const from_angle = edges.front()->normalized_angle(false);
-    auto const to_angle = edges.back()->normalized_angle(true);
+  edge_chain make_chain(std::vector<osm_edge*> const& edges) const {
+    auto& first = *edges.front();
+    auto c = edge_chain{};
+    c.edge_ = &first;
+    c.from_ = first.from_;
+    c.to_ = edges.back()->to_;
+    c.n_compressed_edges_ = edges.size() - 1;
+    c.from_angle_ = first.normalized_angle(false);
+    c.to_angle_ = edges.back()->normalized_angle(true);
 
+    auto path = std::vector<merc>{};
+    path.reserve(edges.size() + 1);
+    path.push_back(first.from_->location_);
+    for (auto const* e : edges) {
+      path.push_back(e->to_->location_);
+      c.distance_ += e->distance_;
+      c.elevation_up_ += e->elevation_up_;
+      c.elevation_down_ += e->elevation_down_;
+    }
     path.erase(std::unique(begin(path), end(path)), end(path));
+    c.path_size_ = path.size();
 
-    if (path.size() < 2) {
-      log_.out() << "WARNING: Path with length " << path.size()
-                 << " created for osm way " << info->osm_way_id_ << "\n";
+    if (first.generate_sidewalks(og_)) {
+      auto paths = generate_sidewalk_paths(path, first.width_);
+      c.path_left_ = std::move(paths.first);
+      c.path_right_ = std::move(paths.second);
+    } else {
+      c.path_left_ = std::move(path);
     }
+    return c;
+  }
 
-    if (oe.generate_sidewalks(og_)) {
-      auto paths = generate_sidewalk_paths(path, oe.width_);
-      ig_from->emplace_out_edge(oe.info_, ig_from, ig_to, distance,
-                                std::move(paths.first), std::move(paths.second),
-                                from_angle, to_angle);
-    } else {
-      ig_from->emplace_out_edge(oe.info_, ig_from, ig_to, distance,
-                                std::move(path), std::vector<merc>(),
-                                from_angle, to_angle);
+  void add_int_edge(edge_chain& c) {
+    auto const& oe = *c.edge_;
+    auto const* info = oe.info(og_);
+    assert(!(info->area_ && oe.generate_sidewalks(og_)));
+
+    auto* ig_from = get_or_create_node(c.from_);
+    auto* ig_to = get_or_create_node(c.to_);
+
+    if (c.path_size_ < 2) {
+      log_.out() << "WARNING: Path with length " << c.path_size_
+                 << " created for osm way " << info->osm_way_id_ << "\n";
     }
-    auto* ie = ig_from->out_edges_.back().get();
-    ie->sidewalk_left_ = sidewalk_left;
-    ie->sidewalk_right_ = sidewalk_right;
-    ie->linked_left_ = linked_left;
-    ie->linked_right_ = linked_right;
+
+    auto* ie = ig_.add_edge(oe.info_, ig_from, ig_to, c.distance_,
+                            std::move(c.path_left_), std::move(c.path_right_),
+                            c.from_angle_, c.to_angle_);
+    ie->sidewalk_left_ = oe.sidewalk_left_;
+    ie->sidewalk_right_ = oe.sidewalk_right_;
+    ie->linked_left_ = oe.linked_left_ != nullptr;
+    ie->linked_right_ = oe.linked_right_ != nullptr;
     ie->layer_ = oe.layer_;
-    ie->elevation_up_ = elevation_up;
-    ie->elevation_down_ = elevation_down;
+    ie->elevation_up_ = c.elevation_up_;
+    ie->elevation_down_ = c.elevation_down_;
     assert(!(ie->path_left_.empty() && ie->path_right_.empty()));
     assert(ie->elevation_up_ >= 0);
     assert(ie->elevation_down_ >= 0);
 
+    stats_.int_.n_compressed_edges_ += c.n_compressed_edges_;
     switch (info->type_) {
       case edge_type::STREET:
         if (!info->is_rail_edge()) {
@@ -177,9 +226,8 @@ private:
     // split node when access not allowed
     if (on->int_node_ == nullptr || !on->access_allowed_) {
       auto const crossing = on->crossing_;
-      ig_.nodes_.emplace_back(
-          std::make_unique<int_node>(on->osm_id_, on->location_, crossing));
-      auto* in = ig_.nodes_.back().get();
+      auto* in =
+          &ig_.nodes_.emplace_back(on->osm_id_, on->location_, crossing);
       in->access_allowed_ = on->access_allowed_;
       in->elevator_ = on->elevator_;
       in->entrance_ = on->entrance_;
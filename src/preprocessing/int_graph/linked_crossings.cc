@@ -39,10 +39,10 @@ rtree_type create_rtree(int_graph& ig) {
   std::vector<rtree_value_t> values;
 
   for (auto const& n : ig.nodes_) {
-    for (auto& e : n->out_edges_) {
+    for (auto* e : n.out_edges_) {
       if (e->is_linked()) {
-        add_segments(values, e.get(), side_type::LEFT);
-        add_segments(values, e.get(), side_type::RIGHT);
+        add_segments(values, e, side_type::LEFT);
+        add_segments(values, e, side_type::RIGHT);
       }
     }
   }
@@ -148,9 +148,8 @@ int_node* split_edge(int_graph& ig, routing_graph& rg, rtree_type& rtree,
       end(orig_path));
   second_path.insert(begin(second_path), cut_pt.point_);
 
-  ig.nodes_.emplace_back(
-      std::make_unique<int_node>(0, cut_pt.point_, crossing_type::NONE));
-  auto* mid_node = ig.nodes_.back().get();
+  auto* mid_node =
+      &ig.nodes_.emplace_back(0, cut_pt.point_, crossing_type::NONE);
 
   end_node->remove_incoming_edge(orig_edge);
   orig_edge->to_ = mid_node;
@@ -171,11 +170,10 @@ int_node* split_edge(int_graph& ig, routing_graph& rg, rtree_type& rtree,
   auto empty_path = std::vector<merc>{};
   auto second_left_path = side == side_type::LEFT ? second_path : empty_path;
   auto second_right_path = side == side_type::LEFT ? empty_path : second_path;
-  mid_node->emplace_out_edge(
+  auto* second_edge = ig.add_edge(
       orig_edge->info_, mid_node, end_node, path_length(second_path),
       std::move(second_left_path), std::move(second_right_path), mid_from_angle,
       orig_to_angle);
-  auto* second_edge = mid_node->out_edges_.back().get();
   second_edge->sidewalk_left_ = orig_edge->sidewalk_left_;
   second_edge->sidewalk_right_ = orig_edge->sidewalk_right_;
   second_edge->linked_left_ = orig_edge->linked_left_;
@@ -294,12 +292,11 @@ void create_linked_crossing(int_graph& ig, routing_graph& rg, rtree_type& rtree,
       set_street_name(info, e, other_edge, ig);
       auto const crossing_angle =
           get_normalized_angle(to_node->location_ - from_node->location_);
-      from_node->emplace_out_edge(
+      auto* crossing_edge = ig.add_edge(
           info_idx, from_node, to_node,
           distance(from_node->location_, to_node->location_),
           std::move(crossing_path), std::vector<merc>(), crossing_angle,
           crossing_angle);
-      auto* crossing_edge = from_node->out_edges_.back().get();
       to_node->in_edges_.emplace_back(crossing_edge);
       from_node->generated_crossing_edges_ = true;
       to_node->generated_crossing_edges_ = true;
@@ -335,9 +332,9 @@ void add_linked_crossings(int_graph& ig, routing_graph& rg, logging& log,
   for (std::size_t i = 0; i < node_size; i++) {
     auto const& n = ig.nodes_[i];
     std::vector<int_edge*> edges;
-    for (auto& e : n->out_edges_) {
-      if (linked_on_one_side(e.get())) {
-        edges.push_back(e.get());
+    for (auto* e : n.out_edges_) {
+      if (linked_on_one_side(e)) {
+        edges.push_back(e);
       }
     }
     for (auto& e : edges) {
@@ -4,8 +4,13 @@ namespace ppr::preprocessing {
 
 logging::logging()
     : steps_{
+          {pp_step::UPDATE_CHANGES, "Update: Changes", 0},
+          {pp_step::UPDATE_REGION, "Update: Affected Region", 0},
+          {pp_step::PARTITION_SCAN, "Partitions: Scan", 0},
+          {pp_step::OSM_EXTRACT_REGION, "OSM Extract: Region", 0},
           {pp_step::OSM_EXTRACT_RELATIONS, "OSM Extract: Relations", 2},
-          {pp_step::OSM_EXTRACT_MAIN, "OSM Extract: Nodes + Edges", 22},
+          {pp_step::OSM_EXTRACT_WAY_NODES, "OSM Extract: Way Nodes", 4},
+          {pp_step::OSM_EXTRACT_MAIN, "OSM Extract: Nodes + Edges", 18},
           {pp_step::OSM_EXTRACT_AREAS, "OSM Extract: Areas", 30},
           {pp_step::OSM_DEM, "Elevation data", 4},
           {pp_step::INT_PARALLEL_STREETS, "Parallel Street Detection", 2},
@@ -17,9 +22,12 @@ logging::logging()
           {pp_step::RG_EDGES, "Edge Creation", 3},
           {pp_step::RG_AREAS, "Area Creation", 0},
           {pp_step::RG_CROSSING_DETOURS, "Crossing Detours", 5},
+          {pp_step::UPDATE_SPLICE, "Update: Splicing", 0},
+          {pp_step::UPDATE_CROSSING_DETOURS, "Update: Crossing Detours", 0},
+          {pp_step::PARTITION_MERGE, "Partitions: Merge", 0},
           {pp_step::POST_GRAPH_VERIFICATION, "Graph Verification", 0},
-          {pp_step::POST_SERIALIZATION, "Graph Serialization", 7},
-          {pp_step::POST_RTREES, "R-Tree Generation", 9},
+          {pp_step::POST_RTREES, "R-Tree Generation", 2},
+          {pp_step::POST_SERIALIZATION, "Graph Serialization", 14},
       } {}
 
 step_info& logging::get_step_info(pp_step step_id) {
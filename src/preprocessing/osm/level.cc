@@ -11,6 +11,27 @@
 
 namespace ppr::preprocessing::osm {
 
+levels get_multiple_levels(cista::raw::vector<std::int16_t> const& lvls,
+                           levels_vector_t& levels_vec) {
+  for (auto const [idx, bucket] : utl::enumerate(levels_vec)) {
+    if (bucket.size() == lvls.size()) {
+      auto match = true;
+      for (auto const [a, b] : utl::zip(lvls, bucket)) {
+        if (a != b) {
+          match = false;
+          break;
+        }
+      }
+      if (match) {
+        return make_multiple_levels(static_cast<std::uint16_t>(idx));
+      }
+    }
+  }
+  auto const levels_idx = levels_vec.size();
+  levels_vec.emplace_back(lvls);
+  return make_multiple_levels(levels_idx);
+}
+
 levels get_levels(char const* level_tag, levels_vector_t& levels_vec) {
   if (level_tag == nullptr) {
     return {};
@@ -143,24 +164,19 @@ levels get_levels(char const* level_tag, levels_vector_t& levels_vec) {
   } else if (entries == 1) {
     return make_single_level(levels[0]);
   } else {
-    for (auto const [idx, bucket] : utl::enumerate(levels_vec)) {
-      if (bucket.size() == entries) {
-        auto match = true;
-        for (auto const [a, b] : utl::zip(levels, bucket)) {
-          if (a != b) {
-            match = false;
-            break;
-          }
-        }
-        if (match) {
-          return make_multiple_levels(static_cast<std::uint16_t>(idx));
-        }
-      }
-    }
-    auto const levels_idx = levels_vec.size();
-    levels_vec.emplace_back(levels);
-    return make_multiple_levels(levels_idx);
+    return get_multiple_levels(levels, levels_vec);
+  }
+}
+
+levels copy_levels(levels const& lvl, levels_vector_t const& from,
+                   levels_vector_t& to) {
+  if (!lvl.has_multiple_levels()) {
+    return lvl;
   }
+  auto const bucket = from[lvl.multi_level_index()];
+  auto const lvls =
+      cista::raw::vector<std::int16_t>(begin(bucket), end(bucket));
+  return get_multiple_levels(lvls, to);
 }
 
 levels get_levels(osmium::TagList const& tags, levels_vector_t& levels_vec) {
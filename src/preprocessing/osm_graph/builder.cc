@@ -12,12 +12,12 @@ namespace ppr::preprocessing {
 
 osm_graph build_osm_graph(options const& opt, logging& log, statistics& stats) {
   auto const t_start = timing_now();
-  auto og = extract(opt.osm_file_, log, stats);
+  auto og = extract(opt.osm_file_, log, stats, opt.extract_region_.get());
   auto const t_after_extract = timing_now();
   stats.osm_.d_extract_ = ms_between(t_start, t_after_extract);
 
   if (!opt.dem_files_.empty()) {
-    dem_source dem;
+    dem_source dem{opt.dem_tile_cache_size_};
     for (auto const& file : opt.dem_files_) {
       dem.add_file(file);
     }
@@ -1,12 +1,16 @@
 #include "ppr/preprocessing/osm_graph/elevation.h"
 
 #include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include "ppr/common/parallel.h"
 
 using namespace ppr::preprocessing::elevation;
 
 namespace ppr::preprocessing {
 
-void sample_elevation(osm_edge& edge, elevation::dem_source& dem,
+void sample_elevation(osm_edge& edge, elevation::dem_source const& dem,
                       double sampling_interval, elevation_statistics& stats) {
   assert(edge.elevation_down_ == 0);
   assert(edge.elevation_up_ == 0);
@@ -45,35 +49,54 @@ void sample_elevation(osm_edge& edge, elevation::dem_source& dem,
 void add_elevation_data(osm_graph& og, elevation::dem_source& dem,
                         double sampling_interval, logging& log,
                         elevation_statistics& stats) {
-  step_progress progress{log, pp_step::OSM_DEM, og.nodes_.size() * 2};
-  stats.n_queries_ += og.nodes_.size();
-  for (auto& node : og.nodes_) {
-    auto const val = dem.get(to_location(node->location_));
-    node->elevation_ = val;
-    if (val == NO_ELEVATION_DATA) {
+  constexpr auto const EDGE_CHUNK_SIZE = std::size_t{4096};
+  auto const node_count = og.nodes_.size();
+  step_progress progress{log, pp_step::OSM_DEM, node_count * 2};
+
+  auto locations = std::vector<location>(node_count);
+  parallel_for_chunks(node_count, [&](std::size_t const i) {
+    locations[i] = to_location(og.nodes_[i].location_);
+  });
+  auto const elevations = dem.get(locations);
+  stats.n_queries_ += node_count;
+  for (auto i = std::size_t{0}; i < node_count; ++i) {
+    og.nodes_[i].elevation_ = elevations[i];
+    if (elevations[i] == NO_ELEVATION_DATA) {
       stats.n_misses_++;
     }
-    progress.add();
   }
+  progress.add(node_count);
+
+  // each thread only modifies the out edges of its nodes
   auto const use_sampling = sampling_interval > 0;
-  for (auto& node : og.nodes_) {
-    for (auto& edge : node->out_edges_) {
-      if (!edge.from_->has_elevation_data() ||
-          !edge.to_->has_elevation_data() || !edge.calculate_elevation(og)) {
-        continue;
-      }
-      if (use_sampling && edge.distance_ > sampling_interval) {
-        sample_elevation(edge, dem, sampling_interval, stats);
-      } else {
-        auto const diff = edge.to_->elevation_ - edge.from_->elevation_;
-        if (diff >= 0) {
-          edge.elevation_up_ = static_cast<elevation_diff_t>(diff);
+  auto const chunk_count = (node_count + EDGE_CHUNK_SIZE - 1) / EDGE_CHUNK_SIZE;
+  auto chunk_stats = std::vector<elevation_statistics>(chunk_count);
+  utl::parallel_for_run(chunk_count, [&](std::size_t const chunk) {
+    auto const first = chunk * EDGE_CHUNK_SIZE;
+    auto const last = std::min(node_count, first + EDGE_CHUNK_SIZE);
+    for (auto i = first; i < last; ++i) {
+      for (auto& edge : og.nodes_[i].out_edges_) {
+        if (!edge.from_->has_elevation_data() ||
+            !edge.to_->has_elevation_data() || !edge.calculate_elevation(og)) {
+          continue;
+        }
+        if (use_sampling && edge.distance_ > sampling_interval) {
+          sample_elevation(edge, dem, sampling_interval, chunk_stats[chunk]);
         } else {
-          edge.elevation_down_ = static_cast<elevation_diff_t>(-diff);
+          auto const diff = edge.to_->elevation_ - edge.from_->elevation_;
+          if (diff >= 0) {
+            edge.elevation_up_ = static_cast<elevation_diff_t>(diff);
+          } else {
+            edge.elevation_down_ = static_cast<elevation_diff_t>(-diff);
+          }
         }
       }
     }
-    progress.add();
+    progress.add(last - first);
+  });
+  for (auto const& cs : chunk_stats) {
+    stats.n_queries_ += cs.n_queries_;
+    stats.n_misses_ += cs.n_misses_;
   }
 }
 
@@ -1,5 +1,9 @@
 #include <cstdint>
 #include <algorithm>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "ankerl/unordered_dense.h"
 
@@ -7,16 +11,18 @@
 #include "boost/geometry/geometries/geometries.hpp"
 #include "boost/geometry/geometries/point_xy.hpp"
 #include "boost/geometry/geometry.hpp"
+#include "boost/geometry/index/rtree.hpp"
 
 #include "osmium/area/assembler.hpp"
 #include "osmium/area/multipolygon_manager.hpp"
 #include "osmium/handler.hpp"
 #include "osmium/handler/node_locations_for_ways.hpp"
-#include "osmium/index/map/flex_mem.hpp"
 #include "osmium/io/pbf_input.hpp"
 #include "osmium/relations/relations_manager.hpp"
 #include "osmium/visitor.hpp"
 
+#include "utl/parallel_for.h"
+
 #include "ppr/common/timing.h"
 #include "ppr/preprocessing/logging.h"
 #include "ppr/preprocessing/names.h"
@@ -28,7 +34,9 @@
 #include "ppr/preprocessing/osm/width.h"
 #include "ppr/preprocessing/osm_graph/areas.h"
 #include "ppr/preprocessing/osm_graph/extractor.h"
+#include "ppr/preprocessing/osm_graph/node_location_index.h"
 #include "ppr/preprocessing/statistics.h"
+#include "ppr/preprocessing/update/update_region.h"
 
 namespace bg = boost::geometry;
 namespace bgi = boost::geometry::index;
@@ -37,66 +45,144 @@ using namespace ppr::preprocessing::osm;
 
 namespace ppr::preprocessing {
 
-using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type,
-                                               osmium::Location>;
-using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+using location_handler_type =
+    osmium::handler::NodeLocationsForWays<node_location_index>;
+
+using mp_manager_type =
+    osmium::area::MultipolygonManager<osmium::area::Assembler>;
+using mp_handler_type = std::remove_reference_t<
+    decltype(std::declval<mp_manager_type&>().handler())>;
 
 using point_type = bg::model::d2::point_xy<int32_t>;
 using value_type = std::pair<point_type, uint32_t>;
 using rtree_type = bgi::rtree<value_type, bgi::rstar<64>>;
 
+using way_id_set = ankerl::unordered_dense::set<osmium::object_id_type>;
+
+// Tags of a node relevant for the graph. Classification runs in parallel,
+// levels are stored in a chunk local levels vector until the merge.
+struct node_record {
+  bool access_denied_ : 1 {};
+  bool elevator_ : 1 {};
+  bool entrance_ : 1 {};
+  bool cycle_barrier_ : 1 {};
+  crossing_type crossing_{crossing_type::NONE};
+  tri_state traffic_signals_sound_{tri_state::UNKNOWN};
+  tri_state traffic_signals_vibration_{tri_state::UNKNOWN};
+  door_type door_type_{door_type::UNKNOWN};
+  automatic_door_type automatic_door_type_{automatic_door_type::UNKNOWN};
+  std::uint8_t elevator_max_width_{};
+  std::uint8_t entrance_max_width_{};
+  std::uint8_t cycle_barrier_max_width_{};
+  levels entrance_levels_;
+  levels cycle_barrier_levels_;
+};
+
+node_record classify_node(osmium::Node const& n, levels_vector_t& levels_vec) {
+  auto r = node_record{};
+  auto const& tags = n.tags();
+  if (tags.empty()) {
+    return r;
+  }
+  r.access_denied_ = !access_allowed(tags, true);
+  r.crossing_ = get_node_crossing_type(tags);
+  if (r.crossing_ == crossing_type::SIGNALS) {
+    extract_traffic_signal_attributes(&r, tags);
+  }
+  if (tags.has_tag("highway", "elevator")) {
+    r.elevator_ = true;
+    r.elevator_max_width_ = get_max_width_as_cm(tags);
+  }
+  if (tags.has_key("entrance") || tags.has_tag("indoor", "door")) {
+    r.entrance_ = true;
+    r.door_type_ = get_door_type(tags);
+    r.automatic_door_type_ = get_automatic_door_type(tags);
+    r.entrance_max_width_ = get_max_width_as_cm(tags);
+    r.entrance_levels_ = get_levels(tags, levels_vec);
+  }
+  if (tags.has_tag("barrier", "cycle_barrier")) {
+    r.cycle_barrier_ = true;
+    r.cycle_barrier_max_width_ = get_cycle_barrier_max_width_as_cm(tags);
+    r.cycle_barrier_levels_ = get_levels(tags, levels_vec);
+  }
+  return r;
+}
+
+struct object_record {
+  node_record node_;
+  way_info way_;
+};
+
+// Classification results for a range of objects. Edge infos, names and
+// levels referenced by the records are stored in scratch_.
+struct classified_chunk {
+  osm_graph scratch_;
+  std::vector<object_record> records_;
+};
+
 struct extract_handler : public osmium::handler::Handler {
   extract_handler(
       osm_graph& g,
       ankerl::unordered_dense::set<osmium::object_id_type>& multipolygon_ways,
-      osm_graph_statistics& stats)
-      : graph_(g), multipolygon_ways_(multipolygon_ways), stats_(stats) {}
-
-  void node(osmium::Node const& n) noexcept {
-    auto const& tags = n.tags();
-    if (!access_allowed(tags, true)) {
+      update_region const* region, osm_graph_statistics& stats)
+      : graph_(g),
+        multipolygon_ways_(multipolygon_ways),
+        region_(region),
+        stats_(stats) {}
+
+  void merge_node(osmium::Node const& n, node_record const& r,
+                  osm_graph const& scratch) {
+    if (!in_region(n.location())) {
+      return;
+    }
+    if (r.access_denied_) {
       auto* node = get_node(n.id(), n.location());
       node->access_allowed_ = false;
       stats_.n_access_not_allowed_nodes_++;
     }
-    auto crossing = get_node_crossing_type(tags);
-    if (crossing != crossing_type::NONE) {
+    if (r.crossing_ != crossing_type::NONE) {
       auto* node = get_node(n.id(), n.location());
-      node->crossing_ = crossing;
+      node->crossing_ = r.crossing_;
       stats_.n_crossing_nodes_++;
-      if (crossing == crossing_type::SIGNALS) {
-        extract_traffic_signal_attributes(node, tags);
+      if (r.traffic_signals_sound_ != tri_state::UNKNOWN) {
+        node->traffic_signals_sound_ = r.traffic_signals_sound_;
+      }
+      if (r.traffic_signals_vibration_ != tri_state::UNKNOWN) {
+        node->traffic_signals_vibration_ = r.traffic_signals_vibration_;
       }
     }
-    if (tags.has_tag("highway", "elevator")) {
+    if (r.elevator_) {
       auto* node = get_node(n.id(), n.location());
       node->elevator_ = true;
-      node->max_width_ = get_max_width_as_cm(tags);
+      node->max_width_ = r.elevator_max_width_;
       stats_.n_elevators_++;
     }
-    if (tags.has_key("entrance") || tags.has_tag("indoor", "door")) {
+    if (r.entrance_) {
       auto* node = get_node(n.id(), n.location());
       node->entrance_ = true;
-      node->door_type_ = get_door_type(tags);
-      node->automatic_door_type_ = get_automatic_door_type(tags);
-      node->max_width_ = get_max_width_as_cm(tags);
-      node->levels_ = get_levels(tags, graph_.levels_);
+      node->door_type_ = r.door_type_;
+      node->automatic_door_type_ = r.automatic_door_type_;
+      node->max_width_ = r.entrance_max_width_;
+      node->levels_ =
+          copy_levels(r.entrance_levels_, scratch.levels_, graph_.levels_);
       stats_.n_entrances_++;
     }
-    if (tags.has_tag("barrier", "cycle_barrier")) {
+    if (r.cycle_barrier_) {
       auto* node = get_node(n.id(), n.location());
       node->cycle_barrier_ = true;
-      node->max_width_ = get_cycle_barrier_max_width_as_cm(tags);
-      node->levels_ = get_levels(tags, graph_.levels_);
+      node->max_width_ = r.cycle_barrier_max_width_;
+      node->levels_ =
+          copy_levels(r.cycle_barrier_levels_, scratch.levels_, graph_.levels_);
       stats_.n_cycle_barriers_++;
     }
   }
 
-  void way(osmium::Way const& way) noexcept {
-    auto info = get_way_info(way, graph_);
+  void merge_way(osmium::Way const& way, way_info info,
+                 osm_graph const& scratch) {
     if (info.edge_info_ == NO_EDGE_INFO) {
       return;
     }
+    info.edge_info_ = copy_edge_info(scratch, info.edge_info_);
     auto e_info = &graph_.edge_infos_[info.edge_info_];
     if (e_info->area_) {
       return;
@@ -111,6 +197,12 @@ struct extract_handler : public osmium::handler::Handler {
     }
 
     auto const& way_nodes = way.nodes();
+    if (std::none_of(way_nodes.begin(), way_nodes.end(),
+                     [&](osmium::NodeRef const& nr) {
+                       return in_region(nr.location());
+                     })) {
+      return;
+    }
     std::vector<osm_node*> nodes;
     nodes.reserve(way_nodes.size());
 
@@ -188,6 +280,9 @@ struct extract_handler : public osmium::handler::Handler {
       return;
     }
     auto const& area_tags = area.tags();
+    if (!in_region(area)) {
+      return;
+    }
 
     for (auto const& outer : area.outer_rings()) {
       auto outer_nodes = get_nodes(outer);
@@ -227,19 +322,48 @@ struct extract_handler : public osmium::handler::Handler {
   }
 
 private:
+  // copies an edge info (and its name and levels) from a chunk scratch graph
+  edge_info_idx_t copy_edge_info(osm_graph const& scratch,
+                                 edge_info_idx_t const scratch_idx) {
+    auto info = scratch.edge_infos_[scratch_idx];
+    info.name_ = get_name(std::string{scratch.names_[info.name_].view()},
+                          graph_.names_, graph_.names_map_);
+    info.levels_ = copy_levels(info.levels_, scratch.levels_, graph_.levels_);
+    auto const idx = graph_.edge_infos_.size();
+    graph_.edge_infos_.emplace_back(info);
+    return idx;
+  }
+
   struct osm_node* get_node(std::int64_t osm_id, osmium::Location const& loc) {
     auto n = node_map_.find(osm_id);
     if (n != std::end(node_map_)) {
       return n->second;
     } else {
-      graph_.nodes_.emplace_back(
-          std::make_unique<struct osm_node>(osm_id, to_merc(loc)));
-      auto* node = graph_.nodes_.back().get();
+      auto* node = &graph_.nodes_.emplace_back(osm_id, to_merc(loc));
       node_map_[osm_id] = node;
       return node;
     }
   }
 
+  // objects outside of the update region (if any) are ignored
+  inline bool in_region(osmium::Location const& loc) const {
+    return region_ == nullptr ||
+           region_->in_region(make_location(loc.x(), loc.y()));
+  }
+
+  bool in_region(osmium::Area const& area) const {
+    if (region_ == nullptr) {
+      return true;
+    }
+    auto box = packed_rtree_box{};
+    for (auto const& outer : area.outer_rings()) {
+      for (auto const& nr : outer) {
+        box.extend(make_location(nr.location().x(), nr.location().y()));
+      }
+    }
+    return region_->intersects_region(box);
+  }
+
   inline bool way_is_part_of_multipolygon(osmium::object_id_type id) const {
     return multipolygon_ways_.find(id) != end(multipolygon_ways_);
   }
@@ -265,6 +389,7 @@ private:
   ankerl::unordered_dense::map<std::int64_t, struct osm_node*> node_map_;
   ankerl::unordered_dense::set<osmium::object_id_type> const&
       multipolygon_ways_;
+  update_region const* region_;
   ankerl::unordered_dense::map<osm_node*,
                                ankerl::unordered_dense::set<osm_area*>>
       node_areas_;
@@ -296,8 +421,193 @@ struct multipolygon_way_manager
   ankerl::unordered_dense::set<osmium::object_id_type>& ways_;
 };
 
+// Collects the ids of all ways with at least one node in the extract region.
+// Relies on nodes being stored before ways (as in the main pass).
+struct region_way_collector : public osmium::handler::Handler {
+  region_way_collector(update_region const& region, way_id_set& ways)
+      : region_{region}, ways_{ways} {}
+
+  void node(osmium::Node const& n) {
+    auto const& loc = n.location();
+    if (n.id() >= 0 && loc.valid() &&
+        region_.in_region(make_location(loc.x(), loc.y()))) {
+      node_ids_.push_back(n.positive_id());
+    }
+  }
+
+  void way(osmium::Way const& way) {
+    if (!nodes_finished_) {
+      finish_node_id_set(node_ids_);
+      nodes_finished_ = true;
+    }
+    auto const& way_nodes = way.nodes();
+    if (std::any_of(way_nodes.begin(), way_nodes.end(),
+                    [&](osmium::NodeRef const& nr) {
+                      return nr.ref() >= 0 &&
+                             std::binary_search(node_ids_.begin(),
+                                                node_ids_.end(),
+                                                nr.positive_ref());
+                    })) {
+      ways_.insert(way.id());
+    }
+  }
+
+private:
+  update_region const& region_;
+  way_id_set& ways_;
+  node_id_set node_ids_;
+  bool nodes_finished_{false};
+};
+
+// Collects the ids of all nodes referenced by ways that may be used in the
+// graph or for areas. Only locations of these nodes are stored later.
+// Conservative: ways ignored by get_way_info may be included.
+// For region extracts, only ways touching the region and members of
+// multipolygons touching the region are considered.
+struct way_node_collector : public osmium::handler::Handler {
+  way_node_collector(osmium::TagsFilter const& area_filter,
+                     way_id_set const& multipolygon_ways,
+                     way_id_set const* region_ways, node_id_set& ids)
+      : area_filter_{area_filter},
+        multipolygon_ways_{multipolygon_ways},
+        region_ways_{region_ways},
+        ids_{ids} {}
+
+  void way(osmium::Way const& way) {
+    if (!is_relevant(way)) {
+      return;
+    }
+    for (auto const& nr : way.nodes()) {
+      if (nr.ref() >= 0) {
+        ids_.push_back(nr.positive_ref());
+      }
+    }
+  }
+
+private:
+  bool is_relevant(osmium::Way const& way) const {
+    if (multipolygon_ways_.find(way.id()) != end(multipolygon_ways_)) {
+      return true;
+    }
+    if (region_ways_ != nullptr &&
+        region_ways_->find(way.id()) == end(*region_ways_)) {
+      return false;
+    }
+    auto const& tags = way.tags();
+    return tags.has_key("highway") || tags.has_key("railway") ||
+           tags.has_tag("public_transport", "platform") ||
+           osmium::tags::match_any_of(tags, area_filter_);
+  }
+
+  osmium::TagsFilter const& area_filter_;
+  way_id_set const& multipolygon_ways_;
+  way_id_set const* region_ways_;
+  node_id_set& ids_;
+};
+
+// objects per classification chunk / per batch of buffers
+constexpr auto const CLASSIFY_CHUNK_SIZE = std::size_t{4096};
+constexpr auto const BATCH_SIZE = std::size_t{1} << 18U;
+
+// Buffers are processed in batches. Node locations are stored serially,
+// the tags of all objects in the batch are then classified in parallel and
+// finally merged into the graph in file order (so the resulting graph is
+// identical to a serial run).
+struct extract_pipeline {
+  extract_pipeline(extract_handler& handler, mp_manager_type& mp_manager,
+                   osm_graph_statistics& stats)
+      : handler_{handler},
+        mp_handler_{mp_manager.handler(
+            [&handler](osmium::memory::Buffer&& buffer) {
+              osmium::apply(buffer, handler);
+            })},
+        stats_{stats} {}
+
+  void add(osmium::memory::Buffer&& buffer) {
+    for (auto& object : buffer.select<osmium::OSMObject>()) {
+      if (object.type() == osmium::item_type::node ||
+          object.type() == osmium::item_type::way) {
+        objects_.push_back(&object);
+      }
+    }
+    buffer_ends_.push_back(objects_.size());
+    buffers_.emplace_back(std::move(buffer));
+    if (objects_.size() >= BATCH_SIZE) {
+      process();
+    }
+  }
+
+  void process() {
+    auto const t_start = timing_now();
+    auto const chunks = classify();
+    auto const t_after_classify = timing_now();
+    merge(chunks);
+    stats_.extract_.d_classify_ += ms_between(t_start, t_after_classify);
+    stats_.extract_.d_merge_ += ms_since(t_after_classify);
+
+    objects_.clear();
+    buffer_ends_.clear();
+    buffers_.clear();
+  }
+
+private:
+  std::vector<classified_chunk> classify() const {
+    auto const chunk_count =
+        (objects_.size() + CLASSIFY_CHUNK_SIZE - 1) / CLASSIFY_CHUNK_SIZE;
+    auto chunks = std::vector<classified_chunk>(chunk_count);
+    utl::parallel_for_run(chunk_count, [&](std::size_t const chunk_idx) {
+      auto& chunk = chunks[chunk_idx];
+      auto const first = chunk_idx * CLASSIFY_CHUNK_SIZE;
+      auto const last =
+          std::min(objects_.size(), first + CLASSIFY_CHUNK_SIZE);
+      chunk.records_.resize(last - first);
+      for (auto i = first; i < last; ++i) {
+        auto const* object = objects_[i];
+        auto& record = chunk.records_[i - first];
+        if (object->type() == osmium::item_type::node) {
+          record.node_ =
+              classify_node(static_cast<osmium::Node const&>(*object),
+                            chunk.scratch_.levels_);
+        } else {
+          record.way_ = get_way_info(static_cast<osmium::Way const&>(*object),
+                                     chunk.scratch_);
+        }
+      }
+    });
+    return chunks;
+  }
+
+  void merge(std::vector<classified_chunk> const& chunks) {
+    auto i = std::size_t{0};
+    for (auto const buffer_end : buffer_ends_) {
+      for (; i < buffer_end; ++i) {
+        auto const* object = objects_[i];
+        auto const& chunk = chunks[i / CLASSIFY_CHUNK_SIZE];
+        auto const& record = chunk.records_[i % CLASSIFY_CHUNK_SIZE];
+        if (object->type() == osmium::item_type::node) {
+          handler_.merge_node(static_cast<osmium::Node const&>(*object),
+                              record.node_, chunk.scratch_);
+        } else {
+          auto const& way = static_cast<osmium::Way const&>(*object);
+          handler_.merge_way(way, record.way_, chunk.scratch_);
+          mp_handler_.way(way);
+        }
+      }
+      mp_handler_.flush();
+    }
+  }
+
+  extract_handler& handler_;
+  mp_handler_type& mp_handler_;
+  osm_graph_statistics& stats_;
+
+  std::vector<osmium::memory::Buffer> buffers_;
+  std::vector<osmium::OSMObject*> objects_;
+  std::vector<std::size_t> buffer_ends_;
+};
+
 osm_graph extract(std::string const& osm_file, logging& log,
-                  statistics& stats) {
+                  statistics& stats, update_region const* region) {
   auto const t_start = timing_now();
   auto const infile = osmium::io::File(osm_file);
   stats.osm_input_size_ = boost::filesystem::file_size(osm_file);
@@ -310,18 +620,55 @@ osm_graph extract(std::string const& osm_file, logging& log,
   filter.add_rule(true, "public_transport", "platform");
   filter.add_rule(true, "highway", "platform");
   filter.add_rule(true, "railway", "platform");
-  osmium::area::MultipolygonManager<osmium::area::Assembler> mp_manager{
-      assembler_config, filter};
-  ankerl::unordered_dense::set<osmium::object_id_type> multipolygon_ways;
+  mp_manager_type mp_manager{assembler_config, filter};
+  way_id_set multipolygon_ways;
   multipolygon_way_manager mp_way_manager{filter, multipolygon_ways};
 
+  // region extracts: only ways touching the region and multipolygons with
+  // such a way as member are collected in the following passes
+  way_id_set region_ways;
+  if (region != nullptr) {
+    osmium::io::Reader reader{
+        infile, osmium::osm_entity_bits::node | osmium::osm_entity_bits::way,
+        osmium::io::read_meta::no};
+    region_way_collector collector{*region, region_ways};
+    step_progress progress{log, pp_step::OSM_EXTRACT_REGION,
+                           reader.file_size()};
+    while (auto buffer = reader.read()) {
+      progress.set(reader.offset());
+      osmium::apply(buffer, collector);
+    }
+    reader.close();
+  }
+  auto const touches_region = [&](osmium::Relation const& relation) {
+    return std::any_of(
+        relation.members().begin(), relation.members().end(),
+        [&](osmium::RelationMember const& member) {
+          return member.type() == osmium::item_type::way &&
+                 region_ways.find(member.ref()) != end(region_ways);
+        });
+  };
+
+  stats.osm_.extract_.d_region_pass_ =
+      log.get_step_duration(pp_step::OSM_EXTRACT_REGION);
+  stats.osm_.extract_.n_region_ways_ = region_ways.size();
+
   {
     osmium::io::Reader reader{infile, osmium::osm_entity_bits::relation};
     step_progress progress{log, pp_step::OSM_EXTRACT_RELATIONS,
                            reader.file_size()};
     while (auto buffer = reader.read()) {
       progress.set(reader.offset());
-      osmium::apply(buffer, mp_manager, mp_way_manager);
+      if (region == nullptr) {
+        osmium::apply(buffer, mp_manager, mp_way_manager);
+        continue;
+      }
+      for (auto const& relation : buffer.select<osmium::Relation>()) {
+        if (touches_region(relation)) {
+          mp_manager.relation(relation);
+          mp_way_manager.relation(relation);
+        }
+      }
     }
     reader.close();
     mp_manager.prepare_for_lookup();
@@ -331,26 +678,49 @@ osm_graph extract(std::string const& osm_file, logging& log,
   stats.osm_.extract_.d_relations_pass_ =
       log.get_step_duration(pp_step::OSM_EXTRACT_RELATIONS);
 
+  node_id_set way_node_ids;
+  {
+    osmium::io::Reader reader{infile, osmium::osm_entity_bits::way,
+                              osmium::io::read_meta::no};
+    way_node_collector collector{filter, multipolygon_ways,
+                                 region != nullptr ? &region_ways : nullptr,
+                                 way_node_ids};
+    step_progress progress{log, pp_step::OSM_EXTRACT_WAY_NODES,
+                           reader.file_size()};
+    while (auto buffer = reader.read()) {
+      progress.set(reader.offset());
+      osmium::apply(buffer, collector);
+    }
+    reader.close();
+    finish_node_id_set(way_node_ids);
+  }
+
+  stats.osm_.extract_.d_way_nodes_pass_ =
+      log.get_step_duration(pp_step::OSM_EXTRACT_WAY_NODES);
+  stats.osm_.extract_.n_way_nodes_ = way_node_ids.size();
+
   osm_graph og;
   {
     osmium::io::Reader reader{
         infile, osmium::osm_entity_bits::node | osmium::osm_entity_bits::way,
         osmium::io::read_meta::no};
 
-    index_type index;
+    node_location_index index{std::move(way_node_ids)};
+    stats.osm_.extract_.location_index_size_ = index.used_memory();
     location_handler_type location_handler{index};
     location_handler.ignore_errors();
 
-    extract_handler handler(og, multipolygon_ways, stats.osm_);
+    extract_handler handler(og, multipolygon_ways, region, stats.osm_);
+    extract_pipeline pipeline{handler, mp_manager, stats.osm_};
     step_progress progress{log, pp_step::OSM_EXTRACT_MAIN, reader.file_size()};
     while (auto buffer = reader.read()) {
       progress.set(reader.offset());
-      osmium::apply(
-          buffer, location_handler, handler,
-          mp_manager.handler([&handler](osmium::memory::Buffer&& buffer) {
-            osmium::apply(buffer, handler);
-          }));
+      auto const t_before_locations = timing_now();
+      osmium::apply(buffer, location_handler);
+      stats.osm_.extract_.d_locations_ += ms_since(t_before_locations);
+      pipeline.add(std::move(buffer));
     }
+    pipeline.process();
     reader.close();
   }
   stats.osm_.extract_.d_main_pass_ =
@@ -87,8 +87,8 @@ void check_street_junction(osm_graph& og, osm_node* n,
 void move_crossings(osm_graph& og, logging& log, osm_graph_statistics& stats) {
   step_progress progress{log, pp_step::INT_MOVE_CROSSINGS, og.nodes_.size()};
   for (auto& n : og.nodes_) {
-    if (n->street_edges_ > 2) {
-      check_street_junction(og, n.get(), stats);
+    if (n.street_edges_ > 2) {
+      check_street_junction(og, &n, stats);
     }
   }
   progress.add();
@@ -0,0 +1,72 @@
+#include <algorithm>
+
+#include "osmium/index/index.hpp"
+
+#include "ppr/common/parallel.h"
+#include "ppr/preprocessing/osm_graph/node_location_index.h"
+
+namespace ppr::preprocessing {
+
+void finish_node_id_set(node_id_set& ids) {
+  parallel_sort(ids);
+  ids.resize(static_cast<std::size_t>(
+      std::unique(ids.begin(), ids.end()) - ids.begin()));
+  ids.shrink_to_fit();
+}
+
+node_location_index::node_location_index(node_id_set&& ids)
+    : ids_{std::move(ids)} {
+  locations_.resize(ids_.size());
+}
+
+void node_location_index::set(osmium::unsigned_object_id_type const id,
+                              osmium::Location const value) {
+  if (id < last_id_) {
+    // unsorted input
+    cursor_ = static_cast<std::size_t>(
+        std::lower_bound(ids_.begin(), ids_.end(), id) - ids_.begin());
+  }
+  last_id_ = id;
+  while (cursor_ < ids_.size() && ids_[cursor_] < id) {
+    ++cursor_;
+  }
+  if (cursor_ < ids_.size() && ids_[cursor_] == id) {
+    locations_[cursor_] = value;
+  }
+}
+
+osmium::Location node_location_index::get(
+    osmium::unsigned_object_id_type const id) const {
+  auto const loc = get_noexcept(id);
+  if (!loc) {
+    throw osmium::not_found{id};
+  }
+  return loc;
+}
+
+osmium::Location node_location_index::get_noexcept(
+    osmium::unsigned_object_id_type const id) const noexcept {
+  auto const it = std::lower_bound(ids_.begin(), ids_.end(), id);
+  if (it == ids_.end() || *it != id) {
+    return {};
+  }
+  return locations_[static_cast<std::size_t>(it - ids_.begin())];
+}
+
+std::size_t node_location_index::size() const { return ids_.size(); }
+
+std::size_t node_location_index::used_memory() const {
+  return ids_.capacity() * sizeof(osmium::unsigned_object_id_type) +
+         locations_.capacity() * sizeof(osmium::Location);
+}
+
+void node_location_index::clear() {
+  ids_.clear();
+  ids_.shrink_to_fit();
+  locations_.clear();
+  locations_.shrink_to_fit();
+  cursor_ = 0;
+  last_id_ = 0;
+}
+
+}  // namespace ppr::preprocessing
@@ -48,8 +48,8 @@ inline bool include_edge(osm_graph const& og, osm_edge const& e) {
 rtree_type create_segment_rtree(osm_graph& og) {
   std::vector<rtree_value_t> values;
 
-  for (auto const& n : og.nodes_) {
-    for (auto& e : n->out_edges_) {
+  for (auto& n : og.nodes_) {
+    for (auto& e : n.out_edges_) {
       if (include_edge(og, e)) {
         auto segment = segment_t(e.from_->location_, e.to_->location_);
         values.emplace_back(segment, &e);
@@ -228,8 +228,8 @@ void detect_parallel_streets(osm_graph& og, logging& log,
   step_progress progress{log, pp_step::INT_PARALLEL_STREETS, og.nodes_.size()};
   auto rtree = create_segment_rtree(og);
 
-  for (auto const& n : og.nodes_) {
-    for (auto& e : n->out_edges_) {
+  for (auto& n : og.nodes_) {
+    for (auto& e : n.out_edges_) {
       if (include_edge(og, e)) {
         check_edge(og, rtree, e, log, stats);
       }
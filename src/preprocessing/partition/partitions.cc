@@ -0,0 +1,272 @@
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "boost/filesystem.hpp"
+
+#include "ankerl/unordered_dense.h"
+
+#include "osmium/io/pbf_input.hpp"
+#include "osmium/osm/node.hpp"
+
+#include "ppr/common/timing.h"
+#include "ppr/preprocessing/build_routing_graph.h"
+#include "ppr/preprocessing/partition/partitions.h"
+#include "ppr/preprocessing/update/splice.h"
+#include "ppr/serialization/reader.h"
+#include "ppr/serialization/writer.h"
+
+namespace fs = boost::filesystem;
+
+namespace ppr::preprocessing {
+
+namespace {
+
+constexpr auto const PARTITION_FILE_EXTENSION = ".part";
+
+inline std::int64_t floor_div(std::int64_t const a, std::int64_t const b) {
+  auto const q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// cell edge length in update region tiles
+std::int64_t cell_tiles(options const& opt) {
+  if (opt.partition_size_ <= 0) {
+    throw std::runtime_error{"partition size must be > 0"};
+  }
+  return std::max(std::int64_t{1},
+                  static_cast<std::int64_t>(std::llround(
+                      opt.partition_size_ * location::PRECISION /
+                      static_cast<double>(update_region::TILE_SIZE))));
+}
+
+}  // namespace
+
+partition get_partition(options const& opt, location const& loc) {
+  auto const tile = update_region::tile(loc);
+  auto const size = cell_tiles(opt);
+  return {static_cast<std::int32_t>(
+              floor_div(update_region::tile_col(tile), size)),
+          static_cast<std::int32_t>(
+              floor_div(update_region::tile_row(tile), size))};
+}
+
+std::string to_string(partition const& p) {
+  return std::to_string(p.col_) + "_" + std::to_string(p.row_);
+}
+
+partition parse_partition(std::string const& str) {
+  auto const sep = str.find('_', 1);
+  if (sep == std::string::npos) {
+    throw std::runtime_error{"invalid partition: " + str};
+  }
+  try {
+    return {static_cast<std::int32_t>(std::stoi(str.substr(0, sep))),
+            static_cast<std::int32_t>(std::stoi(str.substr(sep + 1)))};
+  } catch (std::logic_error const&) {
+    throw std::runtime_error{"invalid partition: " + str};
+  }
+}
+
+std::string get_partition_file(options const& opt, partition const& p) {
+  return opt.graph_file_ + "." + to_string(p) + PARTITION_FILE_EXTENSION;
+}
+
+partition get_partition_from_file(std::string const& filename) {
+  auto const path = fs::path{filename};
+  if (path.extension() != PARTITION_FILE_EXTENSION) {
+    throw std::runtime_error{"not a partition file: " + filename};
+  }
+  auto const stem = path.stem().string();
+  auto const dot = stem.rfind('.');
+  return parse_partition(dot == std::string::npos ? stem
+                                                  : stem.substr(dot + 1));
+}
+
+std::shared_ptr<update_region> get_partition_region(options const& opt,
+                                                    partition const& p) {
+  auto const size = cell_tiles(opt) * update_region::TILE_SIZE;
+  auto const clamp = [](std::int64_t const v) {
+    return static_cast<std::int32_t>(
+        std::clamp(v, std::int64_t{std::numeric_limits<std::int32_t>::min()},
+                   std::int64_t{std::numeric_limits<std::int32_t>::max()}));
+  };
+  auto region = std::make_shared<update_region>();
+  region->add(packed_rtree_box{clamp(p.col_ * size), clamp(p.row_ * size),
+                               clamp((p.col_ + 1) * size - 1),
+                               clamp((p.row_ + 1) * size - 1)});
+  region->expand(std::max(opt.partition_halo_, opt.crossing_detours_limit_));
+  return region;
+}
+
+std::vector<partition> get_partitions(options const& opt, logging& log) {
+  auto partitions = std::vector<partition>{};
+  if (!opt.partitions_.empty()) {
+    for (auto const& p : opt.partitions_) {
+      partitions.emplace_back(parse_partition(p));
+    }
+  } else {
+    auto const progress = step_progress{log, pp_step::PARTITION_SCAN};
+    auto cells = ankerl::unordered_dense::set<std::uint64_t>{};
+    osmium::io::Reader reader{opt.osm_file_, osmium::osm_entity_bits::node,
+                              osmium::io::read_meta::no};
+    while (auto buffer = reader.read()) {
+      for (auto const& n : buffer.select<osmium::Node>()) {
+        if (n.location().valid()) {
+          auto const p = get_partition(
+              opt, make_location(n.location().x(), n.location().y()));
+          cells.insert(update_region::make_tile(p.col_, p.row_));
+        }
+      }
+    }
+    reader.close();
+    for (auto const c : cells) {
+      partitions.emplace_back(partition{update_region::tile_col(c),
+                                        update_region::tile_row(c)});
+    }
+  }
+  std::sort(begin(partitions), end(partitions));
+  partitions.erase(std::unique(begin(partitions), end(partitions)),
+                   end(partitions));
+  return partitions;
+}
+
+std::vector<std::string> build_partitions(
+    options const& opt, std::vector<partition> const& partitions,
+    logging& log, statistics& stats) {
+  auto const t_start = timing_now();
+  auto files = std::vector<std::string>(partitions.size());
+  auto const build = [&](std::size_t const i, logging& part_log,
+                         statistics& part_stats) {
+    auto part_opt = opt;
+    part_opt.extract_region_ = get_partition_region(opt, partitions[i]);
+    auto const rg = build_routing_graph(part_opt, part_log, part_stats);
+    files[i] = get_partition_file(opt, partitions[i]);
+    serialization::write_routing_graph(rg, files[i], part_stats);
+  };
+
+  // each build is parallelized internally, multiple concurrent builds
+  // trade memory for throughput
+  auto const jobs = std::min(std::max(opt.partition_jobs_, 1U),
+                             static_cast<unsigned>(partitions.size()));
+  if (jobs <= 1) {
+    for (auto i = std::size_t{0}; i < partitions.size(); ++i) {
+      log.out() << "Partition " << (i + 1) << "/" << partitions.size() << ": "
+                << to_string(partitions[i]) << std::endl;
+      build(i, log, stats);
+    }
+  } else {
+    auto next = std::atomic_size_t{0};
+    auto mutex = std::mutex{};
+    auto workers = std::vector<std::thread>{};
+    auto error = std::exception_ptr{};
+    for (auto j = 0U; j < jobs; ++j) {
+      workers.emplace_back([&]() {
+        for (auto i = next++; i < partitions.size(); i = next++) {
+          logging part_log;
+          auto part_out = std::ostringstream{};
+          part_log.out_ = &part_out;
+          auto part_stats = statistics{};
+          try {
+            build(i, part_log, part_stats);
+          } catch (...) {
+            auto const guard = std::lock_guard{mutex};
+            error = std::current_exception();
+          }
+          auto const guard = std::lock_guard{mutex};
+          log.out() << "Partition " << to_string(partitions[i]) << " done ("
+                    << static_cast<int>(ms_since(t_start)) << "ms)\n"
+                    << part_out.str() << std::flush;
+        }
+      });
+    }
+    for (auto& w : workers) {
+      w.join();
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  stats.partition_.n_partitions_ = partitions.size();
+  stats.partition_.d_build_ = ms_since(t_start);
+  return files;
+}
+
+routing_graph merge_partitions(options const& opt,
+                               std::vector<std::string> const& files,
+                               logging& log, statistics& stats) {
+  auto rg = routing_graph{};
+  {
+    step_progress progress{log, pp_step::PARTITION_MERGE, files.size()};
+    // only one partition graph is loaded at a time, edges to partitions that
+    // have not been added yet are connected at the end
+    auto splicer = routing_graph_splicer{};
+    for (auto const& file : files) {
+      auto const p = get_partition_from_file(file);
+      auto const g = serialization::read_routing_graph(file);
+      // every node and area is taken from the partition that owns it
+      auto const owns = [&opt, p](location const& loc) {
+        return get_partition(opt, loc) == p;
+      };
+      auto in = splice_input{
+          .rg_ = g.data_.get(),
+          .take_node_ = [=](node const& n) { return owns(n.location_); },
+          .take_area_ =
+              [=](area const& a) {
+                auto const box = get_area_box(a);
+                return owns(make_location(box.min_x_, box.min_y_));
+              }};
+      splicer.add(in);
+      progress.add();
+    }
+
+    auto result = splicer.finish();
+    rg = std::move(result.rg_);
+    rg.create_in_edges();
+    stats.partition_.n_unmatched_edges_ = result.n_unmatched_edges_;
+    stats.partition_.n_unmatched_area_nodes_ = result.n_unmatched_area_nodes_;
+    stats.partition_.n_ambiguous_nodes_ = result.n_ambiguous_nodes_;
+  }
+  stats.partition_.d_merge_ = log.get_step_duration(pp_step::PARTITION_MERGE);
+
+  if (stats.partition_.n_unmatched_edges_ != 0 ||
+      stats.partition_.n_unmatched_area_nodes_ != 0) {
+    log.out() << "Warning: " << stats.partition_.n_unmatched_edges_
+              << " edges and " << stats.partition_.n_unmatched_area_nodes_
+              << " area exit nodes could not be connected at partition "
+                 "boundaries (increase the partition halo)"
+              << std::endl;
+  }
+  if (stats.partition_.n_ambiguous_nodes_ != 0) {
+    log.out() << "Warning: " << stats.partition_.n_ambiguous_nodes_
+              << " boundary nodes matched several nodes with the same "
+                 "location and osm id and were not connected"
+              << std::endl;
+  }
+
+  collect_stats(stats.routing_, rg);
+  return rg;
+}
+
+routing_graph build_partitioned_routing_graph(options const& opt,
+                                              logging& log,
+                                              statistics& stats) {
+  auto const partitions = get_partitions(opt, log);
+  log.out() << partitions.size() << " partitions" << std::endl;
+  auto const files = build_partitions(opt, partitions, log, stats);
+  auto rg = merge_partitions(opt, files, log, stats);
+  if (!opt.keep_partition_files_) {
+    for (auto const& file : files) {
+      fs::remove(file);
+    }
+  }
+  return rg;
+}
+
+}  // namespace ppr::preprocessing
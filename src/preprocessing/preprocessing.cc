@@ -6,8 +6,11 @@
 #include "ppr/common/verify.h"
 #include "ppr/preprocessing/build_routing_graph.h"
 #include "ppr/preprocessing/logging.h"
+#include "ppr/preprocessing/partition/partitions.h"
+#include "ppr/preprocessing/routing_graph/rtrees.h"
 #include "ppr/preprocessing/statistics.h"
 #include "ppr/preprocessing/stats_writer.h"
+#include "ppr/preprocessing/update/update_routing_graph.h"
 #include "ppr/serialization/reader.h"
 #include "ppr/serialization/writer.h"
 
@@ -28,7 +31,16 @@ preprocessing_result create_routing_data(options const& opt, logging& log) {
   preprocessing_result result;
   auto& stats = result.stats_;
 
-  if (!boost::filesystem::exists(opt.osm_file_)) {
+  if (!opt.base_graph_file_.empty() &&
+      !boost::filesystem::exists(opt.base_graph_file_)) {
+    log.out() << "File not found: " << opt.base_graph_file_ << std::endl;
+    result.success_ = false;
+    result.error_msg_ = "Base graph file not found";
+    return result;
+  }
+
+  if (opt.partition_files_.empty() &&
+      !boost::filesystem::exists(opt.osm_file_)) {
     log.out() << "File not found: " << opt.osm_file_ << std::endl;
     result.success_ = false;
     result.error_msg_ = "OSM file not found";
@@ -37,7 +49,26 @@ preprocessing_result create_routing_data(options const& opt, logging& log) {
 
   {
     auto const t_start = timing_now();
-    result.rg_ = build_routing_graph(opt, log, stats);
+    try {
+      if (!opt.base_graph_file_.empty()) {
+        result.rg_ = update_routing_graph(opt, log, stats);
+      } else if (!opt.partition_files_.empty()) {
+        result.rg_ = merge_partitions(opt, opt.partition_files_, log, stats);
+      } else if (opt.partition_size_ > 0 && !opt.partitions_.empty()) {
+        // partition files are merged later (--merge)
+        build_partitions(opt, get_partitions(opt, log), log, stats);
+        return result;
+      } else if (opt.partition_size_ > 0) {
+        result.rg_ = build_partitioned_routing_graph(opt, log, stats);
+      } else {
+        result.rg_ = build_routing_graph(opt, log, stats);
+      }
+    } catch (std::exception const& e) {
+      log.out() << "Preprocessing failed: " << e.what() << std::endl;
+      result.success_ = false;
+      result.error_msg_ = e.what();
+      return result;
+    }
     auto& rg = result.rg_;
     auto const t_after_build = timing_now();
     stats.d_total_pp_ = ms_between(t_start, t_after_build);
@@ -55,6 +86,12 @@ preprocessing_result create_routing_data(options const& opt, logging& log) {
     stats.d_verification_ =
         log.get_step_duration(pp_step::POST_GRAPH_VERIFICATION);
 
+    {
+      auto const progress = step_progress{log, pp_step::POST_RTREES};
+      create_rtrees(rg, stats.rtrees_);
+    }
+    stats.d_rtrees_ = log.get_step_duration(pp_step::POST_RTREES);
+
     {
       auto const progress = step_progress{log, pp_step::POST_SERIALIZATION};
       rg.filename_ = opt.graph_file_;
@@ -62,15 +99,6 @@ preprocessing_result create_routing_data(options const& opt, logging& log) {
     }
     stats.d_serialization_ = log.get_step_duration(pp_step::POST_SERIALIZATION);
 
-    if (opt.create_rtrees_) {
-      auto const progress = step_progress{log, pp_step::POST_RTREES};
-      fs::remove(fs::path(rg.filename_ + ".ert"));
-      fs::remove(fs::path(rg.filename_ + ".art"));
-      rg.prepare_for_routing(opt.edge_rtree_max_size_,
-                             opt.area_rtree_max_size_);
-    }
-    stats.d_rtrees_ = log.get_step_duration(pp_step::POST_RTREES);
-
     auto const t_end = timing_now();
     stats.d_total_ = ms_between(t_start, t_end);
 
@@ -1,36 +1,36 @@
-#include <queue>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <utility>
 #include <vector>
 
-#include "ankerl/unordered_dense.h"
-
 #include "utl/parallel_for.h"
 
+#include "ppr/common/parallel.h"
 #include "ppr/common/routing_graph.h"
 #include "ppr/preprocessing/routing_graph/crossing_detour.h"
 
 namespace ppr::preprocessing {
 
-namespace {
-
 double distance_with_marked_crossings(routing_graph_data const& rg,
                                       edge const& crossing_edge,
-                                      double distance_limit) {
-  using dist_t = std::pair<double, int>;
-  using queue_entry = std::pair<dist_t, node const*>;
-  ankerl::unordered_dense::map<node const*, dist_t> dists;
-  std::priority_queue<queue_entry, std::vector<queue_entry>, std::greater<>> pq;
-  auto const& start_node = crossing_edge.from_;
-  auto const& end_node = crossing_edge.to_;
+                                      double distance_limit,
+                                      detour_workspace& ws) {
+  node const* start_node = crossing_edge.from_;
+  node const* end_node = crossing_edge.to_;
   auto const ref_street_type = crossing_edge.info(rg)->street_type_;
 
-  dists[start_node] = {0.0, 0};
-  pq.push({{0.0, 0}, start_node});
+  ws.reset();
+  ws.get(start_node) = {0.0, 0};
+  ws.push({0.0, 0}, start_node);
 
-  auto const expand_edge = [&](edge const* e, dist_t dist, bool fwd) {
+  auto const expand_edge = [&](edge const* e, detour_dist_t dist, bool fwd) {
     if (e == nullptr) {  // for clang-tidy
       return;
     }
-    auto const& dest = fwd ? e->to_ : e->from_;
+    node const* dest = fwd ? e->to_ : e->from_;
     auto const total_dist = dist.first + e->distance_;
     auto const e_info = e->info(rg);
     if (total_dist > distance_limit ||
@@ -39,25 +39,23 @@ double distance_with_marked_crossings(routing_graph_data const& rg,
           static_cast<uint8_t>(ref_street_type)))) {
       return;
     }
-    auto current_dist = std::numeric_limits<double>::max();
-    auto f = dists.find(dest);
-    if (f != end(dists)) {
-      current_dist = f->second.first;
-    }
-    if (total_dist < current_dist) {
-      auto const new_dist = dist_t{
-          total_dist, dist.second + (e_info->is_marked_crossing() ? 1 : 0)};
-      dists[dest] = new_dist;
-      pq.emplace(new_dist, dest);
+    auto& current = ws.get(dest);
+    if (total_dist < current.first) {
+      current =
+          detour_dist_t{total_dist,
+                        dist.second + (e_info->is_marked_crossing() ? 1 : 0)};
+      ws.push(current, dest);
     }
   };
 
-  while (!pq.empty()) {
-    auto const& e = pq.top();
-    auto const* node = e.second;
-    auto const dist = dists[node];
-    pq.pop();
+  while (!ws.empty()) {
+    auto const [entry_dist, node] = ws.pop();
+    auto const dist = *ws.find(node);
+    if (entry_dist.first > dist.first) {
+      continue;  // outdated queue entry
+    }
 
+    // the target is settled, no shorter path exists
     if (node == end_node) {
       return dist.second > 0 ? dist.first : 0;
     }
@@ -74,28 +72,77 @@ double distance_with_marked_crossings(routing_graph_data const& rg,
   return 0;
 }
 
+namespace {
+
 void calc_crossing_detour(routing_graph_data& rg, edge& e,
-                          double distance_limit) {
-  auto dist = distance_with_marked_crossings(rg, e, distance_limit);
+                          double distance_limit, detour_workspace& ws) {
+  auto dist = distance_with_marked_crossings(rg, e, distance_limit, ws);
   auto const int_dist = static_cast<int32_t>(std::ceil(dist));
   e.info(rg)->marked_crossing_detour_ = int_dist;
 }
 
+// z-order curve index of a ~700m grid cell
+std::uint64_t cell_index(location const& loc) {
+  auto const spread = [](std::uint64_t v) {
+    v &= 0xFFFFFFFFULL;
+    v = (v | (v << 16U)) & 0x0000FFFF0000FFFFULL;
+    v = (v | (v << 8U)) & 0x00FF00FF00FF00FFULL;
+    v = (v | (v << 4U)) & 0x0F0F0F0F0F0F0F0FULL;
+    v = (v | (v << 2U)) & 0x3333333333333333ULL;
+    v = (v | (v << 1U)) & 0x5555555555555555ULL;
+    return v;
+  };
+  auto const cell = [](std::int32_t const c) {
+    return static_cast<std::uint64_t>(
+        (static_cast<std::int64_t>(c) - std::numeric_limits<int32_t>::min()) >>
+        16U);
+  };
+  return spread(cell(loc.x())) | (spread(cell(loc.y())) << 1U);
+}
+
 }  // namespace
 
 void calc_crossing_detours(routing_graph& graph, options const& opt,
                            logging& log) {
-  step_progress progress{log, pp_step::RG_CROSSING_DETOURS,
-                         graph.data_->nodes_.size()};
+  calc_crossing_detours(graph, opt, log, pp_step::RG_CROSSING_DETOURS,
+                        [](node const&) { return true; });
+}
+
+void calc_crossing_detours(routing_graph& graph, options const& opt,
+                           logging& log, pp_step const step,
+                           std::function<bool(node const&)> const& filter) {
+  constexpr auto const CHUNK_SIZE = std::size_t{256};
+
+  step_progress progress{log, step};
   auto& rg = *graph.data_;
 
-  utl::parallel_for(graph.data_->nodes_, [&](auto& n) {
-    for (auto& e : n->out_edges_) {
-      if (e->info(rg)->is_unmarked_crossing()) {
-        calc_crossing_detour(rg, *e, opt.crossing_detours_limit_);
+  // crossings are processed in spatial order, so consecutive searches of a
+  // thread mostly visit the same (cached) nodes
+  auto crossings = std::vector<std::pair<std::uint64_t, edge*>>{};
+  for (auto& n : rg.nodes_) {
+    if (filter(*n)) {
+      for (auto& e : n->out_edges_) {
+        if (e->info(rg)->is_unmarked_crossing()) {
+          crossings.emplace_back(cell_index(n->location_), e.get());
+        }
       }
     }
-    progress.add();
+  }
+  parallel_sort(crossings, [](auto const& a, auto const& b) {
+    return a.first < b.first;
+  });
+  progress.set_max(crossings.size());
+
+  auto const chunk_count = (crossings.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  utl::parallel_for_run(chunk_count, [&](std::size_t const chunk) {
+    thread_local auto ws = detour_workspace{};
+    auto const first = chunk * CHUNK_SIZE;
+    auto const last = std::min(crossings.size(), first + CHUNK_SIZE);
+    for (auto i = first; i < last; ++i) {
+      calc_crossing_detour(rg, *crossings[i].second,
+                           opt.crossing_detours_limit_, ws);
+    }
+    progress.add(last - first);
   });
 }
 
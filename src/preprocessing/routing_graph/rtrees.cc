@@ -0,0 +1,91 @@
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ppr/common/parallel.h"
+#include "ppr/common/routing_graph.h"
+#include "ppr/common/timing.h"
+#include "ppr/preprocessing/routing_graph/rtrees.h"
+
+namespace ppr::preprocessing {
+
+namespace {
+
+std::vector<std::pair<packed_rtree_box, rg_edge>> create_edge_rtree_entries(
+    routing_graph_data const& rg) {
+  auto offsets = std::vector<std::size_t>(rg.nodes_.size() + 1);
+  for (auto node_index = 0U; node_index < rg.nodes_.size(); ++node_index) {
+    offsets[node_index + 1] =
+        offsets[node_index] + rg.nodes_[node_index]->out_edges_.size();
+  }
+
+  auto values = std::vector<std::pair<packed_rtree_box, rg_edge>>(
+      offsets.back());
+  parallel_for_chunks(
+      rg.nodes_.size(),
+      [&](std::size_t const node_index) {
+        auto const& edges = rg.nodes_[node_index]->out_edges_;
+        for (auto edge_index = 0U; edge_index < edges.size(); ++edge_index) {
+          values[offsets[node_index] + edge_index] = {
+              make_packed_rtree_box(edges[edge_index]->path_),
+              rg_edge{static_cast<std::uint32_t>(node_index), edge_index}};
+        }
+      },
+      1024);
+  return values;
+}
+
+std::vector<std::pair<packed_rtree_box, std::uint32_t>>
+create_area_rtree_entries(routing_graph_data const& rg) {
+  auto values =
+      std::vector<std::pair<packed_rtree_box, std::uint32_t>>(rg.areas_.size());
+  parallel_for_chunks(
+      rg.areas_.size(),
+      [&](std::size_t const i) {
+        auto const& area = rg.areas_[i];
+        auto box = packed_rtree_box{};
+        for (auto const& pt : area.polygon_.outer()) {
+          box.extend(pt.location_);
+        }
+        values[i] = {box, area.id_};
+      },
+      256);
+  return values;
+}
+
+}  // namespace
+
+void create_rtrees(routing_graph& rg, rtree_statistics& stats) {
+  auto const t_start = timing_now();
+  auto& data = *rg.data_;
+
+  // both trees are built concurrently, each build is parallelized as well
+  auto area_thread = std::thread{[&]() {
+    auto const t_area_start = timing_now();
+    auto const entries = create_area_rtree_entries(data);
+    auto const t_after_entries = timing_now();
+    data.area_rtree_ = build_packed_rtree(entries);
+    stats.n_area_entries_ = entries.size();
+    stats.d_area_entries_ = ms_between(t_area_start, t_after_entries);
+    stats.d_area_rtree_ = ms_since(t_after_entries);
+  }};
+
+  {
+    auto const entries = create_edge_rtree_entries(data);
+    auto const t_after_entries = timing_now();
+    data.edge_rtree_ = build_packed_rtree(entries);
+    stats.n_edge_entries_ = entries.size();
+    stats.d_edge_entries_ = ms_between(t_start, t_after_entries);
+    stats.d_edge_rtree_ = ms_since(t_after_entries);
+  }
+
+  area_thread.join();
+
+  stats.edge_rtree_size_ = data.edge_rtree_.memory_size();
+  stats.area_rtree_size_ = data.area_rtree_.memory_size();
+  stats.d_total_ = ms_since(t_start);
+}
+
+}  // namespace ppr::preprocessing
@@ -15,7 +15,7 @@ void collect_general_stats(graph_statistics& stats, Graph const& g) {
 
   stats.n_edges_ = 0;
   for (auto const& n : g.nodes_) {
-    stats.n_edges_ += n->out_edges_.size();
+    stats.n_edges_ += n.out_edges_.size();
   }
 }
 
@@ -30,10 +30,20 @@ void write_stats(statistics const& s, std::string const& filename) {
   write(out, "osm.d_extract", s.osm_.d_extract_);
   write(out, "osm.d_elevation", s.osm_.d_elevation_);
   write(out, "osm.d_total", s.osm_.d_total_);
+  write(out, "osm.extract.d_region_pass", s.osm_.extract_.d_region_pass_);
   write(out, "osm.extract.d_relations_pass", s.osm_.extract_.d_relations_pass_);
+  write(out, "osm.extract.d_way_nodes_pass",
+        s.osm_.extract_.d_way_nodes_pass_);
   write(out, "osm.extract.d_main_pass", s.osm_.extract_.d_main_pass_);
+  write(out, "osm.extract.d_locations", s.osm_.extract_.d_locations_);
+  write(out, "osm.extract.d_classify", s.osm_.extract_.d_classify_);
+  write(out, "osm.extract.d_merge", s.osm_.extract_.d_merge_);
   write(out, "osm.extract.d_areas", s.osm_.extract_.d_areas_);
   write(out, "osm.extract.d_total", s.osm_.extract_.d_total_);
+  write(out, "osm.extract.n_region_ways", s.osm_.extract_.n_region_ways_);
+  write(out, "osm.extract.n_way_nodes", s.osm_.extract_.n_way_nodes_);
+  write(out, "osm.extract.location_index_size",
+        s.osm_.extract_.location_index_size_);
   write(out, "osm.graph.n_nodes", s.osm_.graph_.n_nodes_);
   write(out, "osm.graph.n_edges", s.osm_.graph_.n_edges_);
   write(out, "osm.graph.n_edge_infos", s.osm_.graph_.n_edge_infos_);
@@ -102,6 +112,42 @@ void write_stats(statistics const& s, std::string const& filename) {
   write(out, "routing.n_crossings_marked", s.routing_.n_crossings_marked_);
   write(out, "routing.n_crossings_island", s.routing_.n_crossings_island_);
   write(out, "routing.n_crossings_signals", s.routing_.n_crossings_signals_);
+
+  write(out, "rtrees.d_edge_entries", s.rtrees_.d_edge_entries_);
+  write(out, "rtrees.d_edge_rtree", s.rtrees_.d_edge_rtree_);
+  write(out, "rtrees.d_area_entries", s.rtrees_.d_area_entries_);
+  write(out, "rtrees.d_area_rtree", s.rtrees_.d_area_rtree_);
+  write(out, "rtrees.d_total", s.rtrees_.d_total_);
+  write(out, "rtrees.n_edge_entries", s.rtrees_.n_edge_entries_);
+  write(out, "rtrees.n_area_entries", s.rtrees_.n_area_entries_);
+  write(out, "rtrees.edge_rtree_size", s.rtrees_.edge_rtree_size_);
+  write(out, "rtrees.area_rtree_size", s.rtrees_.area_rtree_size_);
+
+  write(out, "update.d_changes", s.update_.d_changes_);
+  write(out, "update.d_region", s.update_.d_region_);
+  write(out, "update.d_splice", s.update_.d_splice_);
+  write(out, "update.d_crossing_detours", s.update_.d_crossing_detours_);
+  write(out, "update.n_changed_nodes", s.update_.n_changed_nodes_);
+  write(out, "update.n_changed_ways", s.update_.n_changed_ways_);
+  write(out, "update.n_changed_relations", s.update_.n_changed_relations_);
+  write(out, "update.n_core_tiles", s.update_.n_core_tiles_);
+  write(out, "update.n_region_tiles", s.update_.n_region_tiles_);
+  write(out, "update.n_base_nodes", s.update_.n_base_nodes_);
+  write(out, "update.n_update_nodes", s.update_.n_update_nodes_);
+  write(out, "update.n_base_areas", s.update_.n_base_areas_);
+  write(out, "update.n_update_areas", s.update_.n_update_areas_);
+  write(out, "update.n_unmatched_edges", s.update_.n_unmatched_edges_);
+  write(out, "update.n_unmatched_area_nodes",
+        s.update_.n_unmatched_area_nodes_);
+  write(out, "update.n_ambiguous_nodes", s.update_.n_ambiguous_nodes_);
+
+  write(out, "partition.d_build", s.partition_.d_build_);
+  write(out, "partition.d_merge", s.partition_.d_merge_);
+  write(out, "partition.n_partitions", s.partition_.n_partitions_);
+  write(out, "partition.n_unmatched_edges", s.partition_.n_unmatched_edges_);
+  write(out, "partition.n_unmatched_area_nodes",
+        s.partition_.n_unmatched_area_nodes_);
+  write(out, "partition.n_ambiguous_nodes", s.partition_.n_ambiguous_nodes_);
 }
 
 }  // namespace ppr::preprocessing
@@ -0,0 +1,305 @@
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "boost/algorithm/string/case_conv.hpp"
+#include "boost/filesystem.hpp"
+
+#include "osmium/handler.hpp"
+#include "osmium/io/input_iterator.hpp"
+#include "osmium/io/pbf_input.hpp"
+#include "osmium/visitor.hpp"
+
+#include "zlib.h"
+
+#include "ppr/preprocessing/update/osm_changes.h"
+
+namespace fs = boost::filesystem;
+
+namespace ppr::preprocessing {
+
+namespace {
+
+inline location to_location(osmium::Location const& loc) {
+  return make_location(loc.x(), loc.y());
+}
+
+// --- osc (xml) files ---
+// Only ids, node locations and relation members are needed, so a minimal
+// tag scanner is used instead of a full xml parser.
+
+std::string read_file(std::string const& filename) {
+  // gzread reads both compressed and uncompressed files
+  auto* f = gzopen(filename.c_str(), "rb");
+  if (f == nullptr) {
+    throw std::runtime_error{"could not open change file: " + filename};
+  }
+  auto content = std::string{};
+  auto buf = std::array<char, 1U << 16U>{};
+  auto n = 0;
+  while ((n = gzread(f, buf.data(), static_cast<unsigned>(buf.size()))) > 0) {
+    content.append(buf.data(), static_cast<std::size_t>(n));
+  }
+  gzclose(f);
+  if (n < 0) {
+    throw std::runtime_error{"could not read change file: " + filename};
+  }
+  return content;
+}
+
+std::string_view get_attribute(std::string_view const tag,
+                               std::string_view const key) {
+  auto pos = std::size_t{0};
+  while ((pos = tag.find(key, pos)) != std::string_view::npos) {
+    auto const eq = pos + key.size();
+    if (pos > 0 &&
+        std::isspace(static_cast<unsigned char>(tag[pos - 1])) != 0 &&
+        eq + 1 < tag.size() && tag[eq] == '=' &&
+        (tag[eq + 1] == '"' || tag[eq + 1] == '\'')) {
+      auto const first = eq + 2;
+      auto const last = tag.find(tag[eq + 1], first);
+      if (last == std::string_view::npos) {
+        return {};
+      }
+      return tag.substr(first, last - first);
+    }
+    pos = eq;
+  }
+  return {};
+}
+
+std::int64_t get_id(std::string_view const tag, std::string_view const key) {
+  return std::strtoll(std::string{get_attribute(tag, key)}.c_str(), nullptr,
+                      10);
+}
+
+void read_osc(std::string const& filename, osm_changes& changes) {
+  auto const content = read_file(filename);
+  auto const sv = std::string_view{content};
+  auto in_relation = false;
+  auto pos = std::size_t{0};
+  while ((pos = sv.find('<', pos)) != std::string_view::npos) {
+    auto const end = sv.find('>', pos);
+    if (end == std::string_view::npos) {
+      break;
+    }
+    auto const tag = sv.substr(pos + 1, end - pos - 1);
+    pos = end + 1;
+    if (tag.empty() || tag[0] == '?' || tag[0] == '!') {
+      continue;
+    }
+    if (tag[0] == '/') {
+      if (tag.substr(1) == "relation") {
+        in_relation = false;
+      }
+      continue;
+    }
+
+    auto const name = tag.substr(0, tag.find_first_of(" \t\r\n/"));
+    if (name == "node") {
+      changes.nodes_.insert(get_id(tag, "id"));
+      auto const lat = get_attribute(tag, "lat");
+      auto const lon = get_attribute(tag, "lon");
+      if (!lat.empty() && !lon.empty()) {
+        changes.node_locations_.emplace_back(
+            make_location(std::strtod(std::string{lon}.c_str(), nullptr),
+                          std::strtod(std::string{lat}.c_str(), nullptr)));
+      }
+    } else if (name == "way") {
+      changes.ways_.insert(get_id(tag, "id"));
+    } else if (name == "relation") {
+      changes.relations_.insert(get_id(tag, "id"));
+      in_relation = tag.back() != '/';
+    } else if (name == "member" && in_relation &&
+               get_attribute(tag, "type") == "way") {
+      changes.ways_.insert(get_id(tag, "ref"));
+    }
+  }
+}
+
+// --- pbf diff ---
+
+bool same_tags(osmium::TagList const& a, osmium::TagList const& b) {
+  return std::equal(
+      a.begin(), a.end(), b.begin(), b.end(),
+      [](osmium::Tag const& x, osmium::Tag const& y) {
+        return std::strcmp(x.key(), y.key()) == 0 &&
+               std::strcmp(x.value(), y.value()) == 0;
+      });
+}
+
+bool same_object(osmium::OSMObject const& a, osmium::OSMObject const& b) {
+  if (!same_tags(a.tags(), b.tags())) {
+    return false;
+  }
+  switch (a.type()) {
+    case osmium::item_type::node:
+      return static_cast<osmium::Node const&>(a).location() ==
+             static_cast<osmium::Node const&>(b).location();
+    case osmium::item_type::way: {
+      auto const& na = static_cast<osmium::Way const&>(a).nodes();
+      auto const& nb = static_cast<osmium::Way const&>(b).nodes();
+      return std::equal(na.begin(), na.end(), nb.begin(), nb.end(),
+                        [](osmium::NodeRef const& x, osmium::NodeRef const& y) {
+                          return x.ref() == y.ref();
+                        });
+    }
+    case osmium::item_type::relation: {
+      auto const& ma = static_cast<osmium::Relation const&>(a).members();
+      auto const& mb = static_cast<osmium::Relation const&>(b).members();
+      return std::equal(
+          ma.begin(), ma.end(), mb.begin(), mb.end(),
+          [](osmium::RelationMember const& x, osmium::RelationMember const& y) {
+            return x.type() == y.type() && x.ref() == y.ref() &&
+                   std::strcmp(x.role(), y.role()) == 0;
+          });
+    }
+    default: return true;
+  }
+}
+
+void add_change(osmium::OSMObject const& o, osm_changes& changes) {
+  switch (o.type()) {
+    case osmium::item_type::node: {
+      auto const& n = static_cast<osmium::Node const&>(o);
+      changes.nodes_.insert(n.id());
+      if (n.location().valid()) {
+        changes.node_locations_.emplace_back(to_location(n.location()));
+      }
+      break;
+    }
+    case osmium::item_type::way: changes.ways_.insert(o.id()); break;
+    case osmium::item_type::relation:
+      changes.relations_.insert(o.id());
+      for (auto const& m : static_cast<osmium::Relation const&>(o).members()) {
+        if (m.type() == osmium::item_type::way) {
+          changes.ways_.insert(m.ref());
+        }
+      }
+      break;
+    default: break;
+  }
+}
+
+// both files must be sorted by type and id (as usual for pbf files)
+void diff_pbf(std::string const& old_file, std::string const& new_file,
+              osm_changes& changes) {
+  auto const entities = osmium::osm_entity_bits::node |
+                        osmium::osm_entity_bits::way |
+                        osmium::osm_entity_bits::relation;
+  osmium::io::Reader old_reader{old_file, entities, osmium::io::read_meta::no};
+  osmium::io::Reader new_reader{new_file, entities, osmium::io::read_meta::no};
+  auto old_range =
+      osmium::io::make_input_iterator_range<osmium::OSMObject const>(
+          old_reader);
+  auto new_range =
+      osmium::io::make_input_iterator_range<osmium::OSMObject const>(
+          new_reader);
+
+  auto const key = [](osmium::OSMObject const& o) {
+    return std::pair{static_cast<int>(o.type()), o.id()};
+  };
+
+  auto a = old_range.begin();
+  auto b = new_range.begin();
+  auto const a_end = old_range.end();
+  auto const b_end = new_range.end();
+  while (a != a_end || b != b_end) {
+    if (b == b_end || (a != a_end && key(*a) < key(*b))) {
+      add_change(*a, changes);  // deleted
+      ++a;
+    } else if (a == a_end || key(*b) < key(*a)) {
+      add_change(*b, changes);  // created
+      ++b;
+    } else {
+      if (!same_object(*a, *b)) {
+        add_change(*a, changes);
+        add_change(*b, changes);
+      }
+      ++a;
+      ++b;
+    }
+  }
+  old_reader.close();
+  new_reader.close();
+}
+
+struct way_nodes_handler : public osmium::handler::Handler {
+  explicit way_nodes_handler(osm_changes const& changes) : changes_{changes} {}
+
+  void way(osmium::Way const& way) {
+    if (changes_.ways_.find(way.id()) == end(changes_.ways_)) {
+      return;
+    }
+    auto& refs = ways_.emplace_back();
+    for (auto const& nr : way.nodes()) {
+      refs.push_back(nr.ref());
+      locations_.emplace(nr.ref(), location{});
+    }
+  }
+
+  void node(osmium::Node const& n) {
+    if (auto it = locations_.find(n.id()); it != end(locations_)) {
+      it->second = to_location(n.location());
+    }
+  }
+
+  osm_changes const& changes_;
+  std::vector<std::vector<std::int64_t>> ways_;
+  ankerl::unordered_dense::map<std::int64_t, location> locations_;
+};
+
+}  // namespace
+
+osm_changes read_osm_changes(std::string const& changes_file,
+                             std::string const& osm_file) {
+  if (!fs::exists(changes_file)) {
+    throw std::runtime_error{"change file not found: " + changes_file};
+  }
+  auto changes = osm_changes{};
+  if (boost::to_lower_copy(fs::path{changes_file}.extension().string()) ==
+      ".pbf") {
+    diff_pbf(changes_file, osm_file, changes);
+  } else {
+    read_osc(changes_file, changes);
+  }
+  return changes;
+}
+
+std::vector<packed_rtree_box> get_changed_way_boxes(
+    std::string const& osm_file, osm_changes const& changes) {
+  auto handler = way_nodes_handler{changes};
+  {
+    osmium::io::Reader reader{osm_file, osmium::osm_entity_bits::way,
+                              osmium::io::read_meta::no};
+    osmium::apply(reader, handler);
+    reader.close();
+  }
+  {
+    osmium::io::Reader reader{osm_file, osmium::osm_entity_bits::node,
+                              osmium::io::read_meta::no};
+    osmium::apply(reader, handler);
+    reader.close();
+  }
+
+  auto boxes = std::vector<packed_rtree_box>{};
+  boxes.reserve(handler.ways_.size());
+  for (auto const& refs : handler.ways_) {
+    auto box = packed_rtree_box{};
+    for (auto const ref : refs) {
+      auto const& loc = handler.locations_.at(ref);
+      if (loc.valid()) {
+        box.extend(loc);
+      }
+    }
+    boxes.push_back(box);
+  }
+  return boxes;
+}
+
+}  // namespace ppr::preprocessing
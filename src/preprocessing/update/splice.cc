@@ -0,0 +1,430 @@
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ankerl/unordered_dense.h"
+
+#include "ppr/preprocessing/names.h"
+#include "ppr/preprocessing/osm/level.h"
+#include "ppr/preprocessing/update/splice.h"
+
+namespace ppr::preprocessing {
+
+namespace {
+
+inline std::uint64_t location_key(location const& loc) {
+  return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(loc.x()))
+          << 32U) |
+         static_cast<std::uint32_t>(loc.y());
+}
+
+constexpr auto const NO_AREA = std::numeric_limits<std::uint32_t>::max();
+
+// mappings from one input graph to the output graph
+struct source {
+  explicit source(splice_input& in)
+      : in_{in},
+        rg_{*in.rg_},
+        infos_(rg_.edge_infos_.size(), NO_EDGE_INFO),
+        areas_(rg_.areas_.size(), NO_AREA) {}
+
+  splice_input& in_;
+  routing_graph_data const& rg_;
+  std::vector<edge_info_idx_t> infos_;  // source info -> output info
+  std::vector<std::uint32_t> areas_;  // source area id -> output area id
+  std::size_t first_area_{}, last_area_{};  // output areas from this source
+};
+
+// node of an input that was not taken from that input
+struct node_ref {
+  friend bool operator==(node_ref const&, node_ref const&) = default;
+
+  location location_;
+  std::int64_t osm_id_{};
+};
+
+// edge (in either direction) between an output node and a node that was
+// not taken from the same input, used to tell apart output nodes with the
+// same location and osm id (e.g. the foot nodes of an entrance)
+struct boundary_edge {
+  node const* node_{};
+  std::int64_t osm_way_id_{};
+  node_ref other_;
+};
+
+// references to nodes and areas of other inputs, resolved in finish() once
+// all nodes are known
+struct pending_edge {
+  node* from_{};
+  edge* edge_{};
+  node_ref to_;
+};
+
+struct pending_area_node {
+  std::uint32_t area_{};
+  std::uint32_t ring_{};  // 0 = outer, i + 1 = inner i
+  std::uint32_t point_{};
+  node_ref node_;
+};
+
+struct pending_adjacent_area {
+  std::uint32_t area_{};
+  std::int64_t osm_id_{};
+  bool from_way_{};
+};
+
+}  // namespace
+
+struct routing_graph_splicer::impl {
+  impl() {
+    out_ = result_.rg_.data_.get();
+    // names[0] = empty string, edge_infos[0] = additional edges
+    out_->names_.emplace_back(std::string_view{});
+  }
+
+  void add(splice_input& in) {
+    auto src = source{in};
+    if (!src.infos_.empty()) {
+      if (out_->edge_infos_.empty()) {
+        copy_info(src, 0);
+      } else {
+        src.infos_[0] = 0;
+      }
+    }
+    if (in.keep_node_ids_) {
+      if (new_node_ids_) {
+        throw std::runtime_error{
+            "splice: inputs that keep their node ids must be added first"};
+      }
+      out_->max_node_id_ = std::max(out_->max_node_id_, src.rg_.max_node_id_);
+    }
+
+    node_map_.clear();
+    for (auto const& n : src.rg_.nodes_) {
+      if (in.take_node_(*n)) {
+        add_node(src, *n);
+      }
+    }
+    copy_edges(src);
+
+    src.first_area_ = out_->areas_.size();
+    for (auto const& a : src.rg_.areas_) {
+      if (in.take_area_(a)) {
+        add_area(src, a);
+      }
+    }
+    src.last_area_ = out_->areas_.size();
+    fix_area_references(src);
+  }
+
+  splice_result finish() {
+    std::sort(begin(boundary_edges_), end(boundary_edges_),
+              [](boundary_edge const& a, boundary_edge const& b) {
+                return a.node_ < b.node_;
+              });
+
+    auto unmatched_from = std::vector<node*>{};
+    for (auto const& p : pending_edges_) {
+      auto const via =
+          boundary_edge{p.from_, p.edge_->info(*out_)->osm_way_id_,
+                        to_ref(*p.from_)};
+      p.edge_->to_ = find_node(p.to_, &via);
+      if (p.edge_->to_ == nullptr) {
+        unmatched_from.push_back(p.from_);
+      }
+    }
+    std::sort(begin(unmatched_from), end(unmatched_from));
+    unmatched_from.erase(
+        std::unique(begin(unmatched_from), end(unmatched_from)),
+        end(unmatched_from));
+    for (auto* from : unmatched_from) {
+      auto& edges = from->out_edges_;
+      auto const it =
+          std::remove_if(begin(edges), end(edges),
+                         [](auto const& e) { return e->to_ == nullptr; });
+      result_.n_unmatched_edges_ +=
+          static_cast<std::size_t>(std::distance(it, end(edges)));
+      edges.erase(it, end(edges));
+    }
+
+    for (auto const& p : pending_area_nodes_) {
+      auto& a = out_->areas_[p.area_];
+      auto& ring =
+          p.ring_ == 0 ? a.polygon_.outer() : a.polygon_.inners()[p.ring_ - 1];
+      ring[p.point_].node_ = find_node(p.node_);
+      if (ring[p.point_].node_ == nullptr) {
+        ++result_.n_unmatched_area_nodes_;
+      }
+    }
+
+    for (auto const& p : pending_adjacent_areas_) {
+      auto const& lookup = p.from_way_ ? way_areas_ : relation_areas_;
+      if (auto const it = lookup.find(p.osm_id_); it != end(lookup)) {
+        out_->areas_[p.area_].adjacent_areas_.push_back(it->second);
+      }
+    }
+
+    pending_edges_.clear();
+    pending_area_nodes_.clear();
+    pending_adjacent_areas_.clear();
+    boundary_edges_.clear();
+    return std::move(result_);
+  }
+
+private:
+  void add_node(source& src, node const& n) {
+    auto const id = src.in_.keep_node_ids_ ? n.id_ : ++out_->max_node_id_;
+    new_node_ids_ = new_node_ids_ || !src.in_.keep_node_ids_;
+    auto& out_node = out_->nodes_.emplace_back(
+        data::make_unique<node>(make_node(id, n.osm_id_, n.location_)));
+    node_map_[&n] = out_node.get();
+    nodes_[location_key(n.location_)].push_back(out_node.get());
+    ++src.in_.n_nodes_;
+  }
+
+  // the only output node with the same location and osm id. if there are
+  // several, the only one of them with a boundary edge of the same way to
+  // the other end of the edge (via) is used.
+  node* find_node(node_ref const& ref, boundary_edge const* via = nullptr) {
+    auto const it = nodes_.find(location_key(ref.location_));
+    if (it == end(nodes_)) {
+      return nullptr;
+    }
+    auto candidates = std::vector<node*>{};
+    for (auto* candidate : it->second) {
+      if (candidate->osm_id_ == ref.osm_id_) {
+        candidates.push_back(candidate);
+      }
+    }
+    if (candidates.size() > 1 && via != nullptr) {
+      auto const linked = std::partition(
+          begin(candidates), end(candidates), [&](node const* candidate) {
+            return has_boundary_edge(candidate, via->osm_way_id_, via->other_);
+          });
+      if (linked != begin(candidates)) {
+        candidates.erase(linked, end(candidates));
+      }
+    }
+    if (candidates.size() > 1) {
+      ++result_.n_ambiguous_nodes_;
+      return nullptr;
+    }
+    return candidates.empty() ? nullptr : candidates.front();
+  }
+
+  bool has_boundary_edge(node const* n, std::int64_t const osm_way_id,
+                         node_ref const& other) const {
+    for (auto it = std::lower_bound(begin(boundary_edges_),
+                                    end(boundary_edges_), n,
+                                    [](boundary_edge const& be,
+                                       node const* x) { return be.node_ < x; });
+         it != end(boundary_edges_) && it->node_ == n; ++it) {
+      if (it->osm_way_id_ == osm_way_id && it->other_ == other) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // output node for a node taken from the current input (nodes of other
+  // inputs are matched in finish())
+  node* get_node(node const* n) const {
+    auto const it = node_map_.find(n);
+    return it != end(node_map_) ? it->second : nullptr;
+  }
+
+  static node_ref to_ref(node const& n) { return {n.location_, n.osm_id_}; }
+
+  void copy_edges(source& src) {
+    for (auto const& n : src.rg_.nodes_) {
+      // node_map_ only contains the selected nodes
+      auto const it = node_map_.find(n.get());
+      if (it == end(node_map_)) {
+        continue;
+      }
+      auto* from = it->second;
+      for (auto const& e : n->out_edges_) {
+        auto* to = get_node(e->to_);
+        auto const& out_edge =
+            from->out_edges_.emplace_back(data::make_unique<edge>(make_edge(
+                copy_info(src, e->info_), from, to, e->distance_,
+                data::vector<location>{e->path_}, e->side_, e->elevation_up_,
+                e->elevation_down_)));
+        if (to == nullptr) {
+          pending_edges_.push_back({from, out_edge.get(), to_ref(*e->to_)});
+          boundary_edges_.push_back(
+              {from, out_edge->info(*out_)->osm_way_id_, to_ref(*e->to_)});
+        }
+      }
+      for (auto const& e : n->in_edges_) {
+        if (get_node(e->from_) == nullptr) {
+          boundary_edges_.push_back(
+              {from, e->info(src.rg_)->osm_way_id_, to_ref(*e->from_)});
+        }
+      }
+    }
+  }
+
+  edge_info_idx_t copy_info(source& src, edge_info_idx_t const idx) {
+    if (idx == NO_EDGE_INFO) {
+      return idx;
+    }
+    auto& mapped = src.infos_[idx];
+    if (mapped == NO_EDGE_INFO) {
+      auto info = src.rg_.edge_infos_[idx];
+      info.name_ = copy_name(src, info.name_);
+      info.levels_ =
+          osm::copy_levels(info.levels_, src.rg_.levels_, out_->levels_);
+      mapped = static_cast<edge_info_idx_t>(out_->edge_infos_.size());
+      out_->edge_infos_.emplace_back(info);
+    }
+    return mapped;
+  }
+
+  names_idx_t copy_name(source const& src, names_idx_t const idx) {
+    return get_name(std::string{src.rg_.names_[idx].view()}, out_->names_,
+                    names_map_);
+  }
+
+  void add_area(source& src, area const& a) {
+    auto const id = static_cast<std::uint32_t>(out_->areas_.size());
+    auto& out_area = out_->areas_.emplace_back(a);
+    out_area.id_ = id;
+    out_area.edge_info_ = copy_info(src, a.edge_info_);
+    out_area.name_ = copy_name(src, a.name_);
+    out_area.levels_ =
+        osm::copy_levels(a.levels_, src.rg_.levels_, out_->levels_);
+
+    auto const fix_ring = [&](auto& ring, std::uint32_t const ring_idx) {
+      for (auto i = 0U; i < ring.size(); ++i) {
+        auto& pt = ring[i];
+        if (pt.node_ != nullptr) {
+          node const* const src_node = pt.node_;
+          pt.node_ = get_node(src_node);
+          if (pt.node_ == nullptr) {
+            pending_area_nodes_.push_back({id, ring_idx, i, to_ref(*src_node)});
+          }
+        }
+      }
+    };
+    fix_ring(out_area.polygon_.outer(), 0);
+    auto& inners = out_area.polygon_.inners();
+    for (auto i = 0U; i < inners.size(); ++i) {
+      fix_ring(inners[i], i + 1);
+    }
+
+    src.areas_[a.id_] = id;
+    (a.from_way_ ? way_areas_ : relation_areas_)[a.osm_id_] = id;
+    ++src.in_.n_areas_;
+  }
+
+  // adjacent areas that were not taken from the same input are replaced by
+  // the area with the same osm id from another input (if any)
+  void fix_area_references(source const& src) {
+    for (auto i = src.first_area_; i < src.last_area_; ++i) {
+      auto& a = out_->areas_[i];
+      auto adjacent = data::vector<std::uint32_t>{};
+      for (auto const adj : a.adjacent_areas_) {
+        auto mapped = src.areas_[adj];
+        if (mapped == NO_AREA) {
+          auto const& src_area = src.rg_.areas_[adj];
+          auto const& lookup =
+              src_area.from_way_ ? way_areas_ : relation_areas_;
+          if (auto const it = lookup.find(src_area.osm_id_);
+              it != end(lookup)) {
+            mapped = it->second;
+          } else {
+            pending_adjacent_areas_.push_back({static_cast<std::uint32_t>(i),
+                                               src_area.osm_id_,
+                                               src_area.from_way_});
+          }
+        }
+        if (mapped != NO_AREA) {
+          adjacent.push_back(mapped);
+        }
+      }
+      a.adjacent_areas_ = adjacent;
+    }
+  }
+
+  splice_result result_;
+  routing_graph_data* out_{};
+  bool new_node_ids_{false};
+  // current input node -> output node
+  ankerl::unordered_dense::map<node const*, node*> node_map_;
+  // output nodes by location
+  ankerl::unordered_dense::map<std::uint64_t, std::vector<node*>> nodes_;
+  // output area ids by osm id
+  ankerl::unordered_dense::map<std::int64_t, std::uint32_t> way_areas_;
+  ankerl::unordered_dense::map<std::int64_t, std::uint32_t> relation_areas_;
+  names_map_t names_map_;
+  std::vector<pending_edge> pending_edges_;
+  std::vector<pending_area_node> pending_area_nodes_;
+  std::vector<pending_adjacent_area> pending_adjacent_areas_;
+  std::vector<boundary_edge> boundary_edges_;
+};
+
+routing_graph_splicer::routing_graph_splicer()
+    : impl_{std::make_unique<impl>()} {}
+
+routing_graph_splicer::~routing_graph_splicer() = default;
+
+void routing_graph_splicer::add(splice_input& in) { impl_->add(in); }
+
+splice_result routing_graph_splicer::finish() { return impl_->finish(); }
+
+packed_rtree_box get_area_box(area const& a) {
+  auto box = packed_rtree_box{};
+  for (auto const& pt : a.outer()) {
+    box.extend(pt.location_);
+  }
+  return box;
+}
+
+splice_result splice_routing_graphs(std::vector<splice_input>& inputs) {
+  auto splicer = routing_graph_splicer{};
+  for (auto& in : inputs) {
+    splicer.add(in);
+  }
+  return splicer.finish();
+}
+
+routing_graph splice_routing_graph(routing_graph_data const& base,
+                                   routing_graph_data const& update,
+                                   update_region const& region,
+                                   update_statistics& stats) {
+  auto inputs = std::vector<splice_input>{};
+  inputs.emplace_back(splice_input{
+      .rg_ = &base,
+      .take_node_ =
+          [&](node const& n) { return !region.in_core(n.location_); },
+      .take_area_ =
+          [&](area const& a) {
+            return !region.intersects_core(get_area_box(a));
+          },
+      .keep_node_ids_ = true});
+  inputs.emplace_back(splice_input{
+      .rg_ = &update,
+      .take_node_ = [&](node const& n) { return region.in_core(n.location_); },
+      .take_area_ =
+          [&](area const& a) {
+            return region.intersects_core(get_area_box(a));
+          }});
+
+  auto result = splice_routing_graphs(inputs);
+  stats.n_base_nodes_ = inputs[0].n_nodes_;
+  stats.n_update_nodes_ = inputs[1].n_nodes_;
+  stats.n_base_areas_ = inputs[0].n_areas_;
+  stats.n_update_areas_ = inputs[1].n_areas_;
+  stats.n_unmatched_edges_ = result.n_unmatched_edges_;
+  stats.n_unmatched_area_nodes_ = result.n_unmatched_area_nodes_;
+  stats.n_ambiguous_nodes_ = result.n_ambiguous_nodes_;
+  return std::move(result.rg_);
+}
+
+}  // namespace ppr::preprocessing
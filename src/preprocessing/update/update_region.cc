@@ -0,0 +1,126 @@
+#include <cmath>
+#include <algorithm>
+
+#include "ppr/common/math.h"
+#include "ppr/preprocessing/update/update_region.h"
+
+namespace ppr::preprocessing {
+
+namespace {
+
+using tile_set = ankerl::unordered_dense::set<update_region::tile_t>;
+
+inline std::int64_t floor_div(std::int64_t const a, std::int64_t const b) {
+  auto const q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+struct tile_range {
+  explicit tile_range(packed_rtree_box const& box)
+      : min_col_{floor_div(box.min_x_, update_region::TILE_SIZE)},
+        min_row_{floor_div(box.min_y_, update_region::TILE_SIZE)},
+        max_col_{floor_div(box.max_x_, update_region::TILE_SIZE)},
+        max_row_{floor_div(box.max_y_, update_region::TILE_SIZE)} {}
+
+  std::size_t size() const {
+    return static_cast<std::size_t>((max_col_ - min_col_ + 1) *
+                                    (max_row_ - min_row_ + 1));
+  }
+
+  bool contains(update_region::tile_t const t) const {
+    auto const col = update_region::tile_col(t);
+    auto const row = update_region::tile_row(t);
+    return col >= min_col_ && col <= max_col_ && row >= min_row_ &&
+           row <= max_row_;
+  }
+
+  template <typename Fn>
+  void for_each(Fn&& fn) const {
+    for (auto col = min_col_; col <= max_col_; ++col) {
+      for (auto row = min_row_; row <= max_row_; ++row) {
+        fn(update_region::make_tile(col, row));
+      }
+    }
+  }
+
+  std::int64_t min_col_, min_row_, max_col_, max_row_;
+};
+
+// iterates over the smaller of the two sets
+bool intersects(tile_set const& tiles, packed_rtree_box const& box) {
+  if (tiles.empty() || box.min_x_ > box.max_x_) {
+    return false;
+  }
+  auto const range = tile_range{box};
+  if (range.size() <= tiles.size()) {
+    auto found = false;
+    range.for_each([&](update_region::tile_t const t) {
+      found = found || tiles.find(t) != end(tiles);
+    });
+    return found;
+  } else {
+    return std::any_of(begin(tiles), end(tiles),
+                       [&](auto const t) { return range.contains(t); });
+  }
+}
+
+}  // namespace
+
+update_region::tile_t update_region::tile(location const& loc) {
+  return make_tile(floor_div(loc.x(), TILE_SIZE),
+                   floor_div(loc.y(), TILE_SIZE));
+}
+
+void update_region::add(location const& loc) { core_.insert(tile(loc)); }
+
+void update_region::add(packed_rtree_box const& box) {
+  if (box.min_x_ > box.max_x_) {
+    return;
+  }
+  tile_range{box}.for_each([&](tile_t const t) { core_.insert(t); });
+}
+
+void update_region::expand(double const halo) {
+  constexpr auto const METERS_PER_TILE =
+      to_rad(static_cast<double>(TILE_SIZE) / location::PRECISION) *
+      AVG_EARTH_RADIUS;
+  auto const dy = static_cast<std::int64_t>(std::ceil(halo / METERS_PER_TILE));
+
+  region_ = core_;
+  for (auto const t : core_) {
+    auto const col = static_cast<std::int64_t>(tile_col(t));
+    auto const row = static_cast<std::int64_t>(tile_row(t));
+    // x distances are smallest at the tile edge farther from the equator
+    auto const max_abs_lat =
+        std::min(90.0, static_cast<double>(std::max(std::abs(row),
+                                                    std::abs(row + 1)) *
+                                           TILE_SIZE) /
+                           location::PRECISION);
+    auto const cos_lat = std::max(std::cos(to_rad(max_abs_lat)), 0.01);
+    auto const dx = static_cast<std::int64_t>(
+        std::ceil(halo / (METERS_PER_TILE * cos_lat)));
+    for (auto c = col - dx; c <= col + dx; ++c) {
+      for (auto r = row - dy; r <= row + dy; ++r) {
+        region_.insert(make_tile(c, r));
+      }
+    }
+  }
+}
+
+bool update_region::in_core(location const& loc) const {
+  return core_.find(tile(loc)) != end(core_);
+}
+
+bool update_region::in_region(location const& loc) const {
+  return region_.find(tile(loc)) != end(region_);
+}
+
+bool update_region::intersects_core(packed_rtree_box const& box) const {
+  return intersects(core_, box);
+}
+
+bool update_region::intersects_region(packed_rtree_box const& box) const {
+  return intersects(region_, box);
+}
+
+}  // namespace ppr::preprocessing
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "ppr/common/timing.h"
+#include "ppr/preprocessing/build_routing_graph.h"
+#include "ppr/preprocessing/routing_graph/crossing_detour.h"
+#include "ppr/preprocessing/update/osm_changes.h"
+#include "ppr/preprocessing/update/splice.h"
+#include "ppr/preprocessing/update/update_region.h"
+#include "ppr/preprocessing/update/update_routing_graph.h"
+#include "ppr/serialization/reader.h"
+
+namespace ppr::preprocessing {
+
+namespace {
+
+constexpr auto const MAX_AREA_CLOSURE_ROUNDS = 16;
+
+// core = all tiles touched by changed objects in the old or new data
+std::shared_ptr<update_region> get_update_region(options const& opt,
+                                                 routing_graph_data const& rg,
+                                                 osm_changes const& changes) {
+  auto region = std::make_shared<update_region>();
+  for (auto const& loc : changes.node_locations_) {
+    region->add(loc);
+  }
+  for (auto const& box : get_changed_way_boxes(opt.osm_file_, changes)) {
+    region->add(box);
+  }
+
+  for (auto const& n : rg.nodes_) {
+    if (changes.nodes_.find(n->osm_id_) != end(changes.nodes_)) {
+      region->add(n->location_);
+    }
+    for (auto const& e : n->out_edges_) {
+      auto const way_id = e->info(rg)->osm_way_id_;
+      if (way_id != 0 && changes.ways_.find(way_id) != end(changes.ways_)) {
+        region->add(make_packed_rtree_box(e->path_));
+      }
+    }
+  }
+
+  auto area_boxes = std::vector<packed_rtree_box>{};
+  area_boxes.reserve(rg.areas_.size());
+  for (auto const& a : rg.areas_) {
+    area_boxes.emplace_back(get_area_box(a));
+    auto const& ids = a.from_way_ ? changes.ways_ : changes.relations_;
+    if (ids.find(a.osm_id_) != end(ids)) {
+      region->add(area_boxes.back());
+    }
+  }
+
+  // areas are rebuilt as a whole, so every area touching the core is added
+  // completely (which may touch further areas)
+  auto added = std::vector<bool>(rg.areas_.size(), false);
+  for (auto round = 0; round < MAX_AREA_CLOSURE_ROUNDS; ++round) {
+    auto changed = false;
+    for (auto i = 0U; i < area_boxes.size(); ++i) {
+      if (!added[i] && region->intersects_core(area_boxes[i])) {
+        added[i] = true;
+        region->add(area_boxes[i]);
+        changed = true;
+      }
+    }
+    if (!changed) {
+      break;
+    }
+  }
+
+  region->expand(std::max(opt.update_halo_, opt.crossing_detours_limit_));
+  return region;
+}
+
+}  // namespace
+
+routing_graph update_routing_graph(options const& opt, logging& log,
+                                   statistics& stats) {
+  auto& ustats = stats.update_;
+  auto const base = serialization::read_routing_graph(opt.base_graph_file_);
+  auto const& base_data = *base.data_;
+
+  auto changes = osm_changes{};
+  {
+    auto const progress = step_progress{log, pp_step::UPDATE_CHANGES};
+    changes = read_osm_changes(opt.changes_file_, opt.osm_file_);
+  }
+  ustats.d_changes_ = log.get_step_duration(pp_step::UPDATE_CHANGES);
+  ustats.n_changed_nodes_ = changes.nodes_.size();
+  ustats.n_changed_ways_ = changes.ways_.size();
+  ustats.n_changed_relations_ = changes.relations_.size();
+
+  auto region = std::shared_ptr<update_region>{};
+  {
+    auto const progress = step_progress{log, pp_step::UPDATE_REGION};
+    region = get_update_region(opt, base_data, changes);
+  }
+  ustats.d_region_ = log.get_step_duration(pp_step::UPDATE_REGION);
+  ustats.n_core_tiles_ = region->core_size();
+  ustats.n_region_tiles_ = region->region_size();
+  log.out() << "Update region: " << region->core_size() << " tiles ("
+            << region->region_size() << " including halo)" << std::endl;
+
+  auto update = routing_graph{};
+  if (!region->empty()) {
+    auto update_opt = opt;
+    update_opt.extract_region_ = region;
+    update = build_routing_graph(update_opt, log, stats);
+  }
+
+  auto rg = routing_graph{};
+  {
+    auto const progress = step_progress{log, pp_step::UPDATE_SPLICE};
+    rg = splice_routing_graph(base_data, *update.data_, *region, ustats);
+    rg.create_in_edges();
+  }
+  ustats.d_splice_ = log.get_step_duration(pp_step::UPDATE_SPLICE);
+
+  if (ustats.n_unmatched_edges_ != 0 || ustats.n_unmatched_area_nodes_ != 0) {
+    throw std::runtime_error{
+        "incremental update failed: " +
+        std::to_string(ustats.n_unmatched_edges_) + " edges and " +
+        std::to_string(ustats.n_unmatched_area_nodes_) +
+        " area exit nodes at the region boundary could not be connected (" +
+        std::to_string(ustats.n_ambiguous_nodes_) +
+        " ambiguous), a full rebuild is required"};
+  }
+
+  // detours of crossings near the changes depend on the new data
+  calc_crossing_detours(
+      rg, opt, log, pp_step::UPDATE_CROSSING_DETOURS,
+      [&](node const& n) { return region->in_region(n.location_); });
+  ustats.d_crossing_detours_ =
+      log.get_step_duration(pp_step::UPDATE_CROSSING_DETOURS);
+
+  collect_stats(stats.routing_, rg);
+  return rg;
+}
+
+}  // namespace ppr::preprocessing
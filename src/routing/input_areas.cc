@@ -1,7 +1,11 @@
+#include <cstdint>
 #include <algorithm>
+#include <vector>
 
 #include "boost/geometry/algorithms/covered_by.hpp"
 
+#include "ankerl/unordered_dense.h"
+
 #include "ppr/routing/input_areas.h"
 
 #include "ppr/common/area_routing.h"
@@ -73,39 +77,48 @@ void create_area_edges(area const* ar, std::vector<node*>& nodes,
   });
 }
 
-void connect_adjacent_areas(additional_edges& additional, area const* a1,
-                            node* n1, area const* a2, node* n2) {
-  auto const mp = bg::model::multi_polygon<typename area::polygon_t>{
-      a1->polygon_, a2->polygon_};
-  auto const line =
-      bg::model::linestring<location>{n1->location_, n2->location_};
-
-  if (bg::covered_by(line, mp)) {
-    additional.connect(n1, n2);
+void connect_adjacent_areas(
+    additional_edges& additional,
+    bg::model::multi_polygon<typename area::polygon_t> const& mp,
+    std::vector<node*> const& nodes1, std::vector<node*> const& nodes2) {
+  for (auto* n1 : nodes1) {
+    for (auto* n2 : nodes2) {
+      auto const line =
+          bg::model::linestring<location>{n1->location_, n2->location_};
+      if (bg::covered_by(line, mp)) {
+        additional.connect(n1, n2);
+      }
+    }
   }
 }
 
 void check_adjacent_areas(additional_edges& additional) {
-  std::vector<std::pair<node*, area const*>> nodes;
-  for (auto& it : additional.area_nodes_) {
-    std::transform(begin(it.second), end(it.second), std::back_inserter(nodes),
-                   [&](node* n) { return std::make_pair(n, it.first); });
-  }
-  if (nodes.size() < 2) {
+  auto const& area_nodes = additional.area_nodes_;
+  if (area_nodes.size() < 2) {
     return;
   }
-  for (std::size_t i = 0; i < nodes.size() - 1; i++) {
-    for (std::size_t j = i + 1; j < nodes.size(); j++) {
-      auto const* a1 = nodes[i].second;
-      auto const* a2 = nodes[j].second;
-      if (a1 == a2 ||
-          std::find(begin(a1->adjacent_areas_), end(a1->adjacent_areas_),
-                    a2->id_) == end(a1->adjacent_areas_)) {
+
+  auto areas_by_id = ankerl::unordered_dense::map<std::uint32_t, area const*>{};
+  areas_by_id.reserve(area_nodes.size());
+  for (auto const& it : area_nodes) {
+    areas_by_id.emplace(it.first->id_, it.first);
+  }
+
+  for (auto const& it : area_nodes) {
+    auto const* a1 = it.first;
+    for (auto const a2_id : a1->adjacent_areas_) {
+      // adjacency is symmetric, only check each pair once
+      if (a2_id <= a1->id_) {
+        continue;
+      }
+      auto const a2_it = areas_by_id.find(a2_id);
+      if (a2_it == end(areas_by_id)) {
         continue;
       }
-      auto* n1 = nodes[i].first;
-      auto* n2 = nodes[j].first;
-      connect_adjacent_areas(additional, a1, n1, a2, n2);
+      auto const* a2 = a2_it->second;
+      auto const mp = bg::model::multi_polygon<typename area::polygon_t>{
+          a1->polygon_, a2->polygon_};
+      connect_adjacent_areas(additional, mp, it.second, area_nodes.at(a2));
     }
   }
 }
@@ -8,94 +8,91 @@
 #include "boost/geometry/algorithms/for_each.hpp"
 #include "boost/geometry/geometries/geometries.hpp"
 
-#include "boost/iterator/function_output_iterator.hpp"
-
 #include "utl/erase_if.h"
 
 #include "ppr/common/geometry/path_conversion.h"
+#include "ppr/common/snapping_cache.h"
 #include "ppr/routing/input_pt.h"
+#include "ppr/routing/snapping.h"
 
 namespace bg = boost::geometry;
-namespace bgi = boost::geometry::index;
 
 namespace ppr::routing {
 
-location nearest_pt_on_segment(location const& loc, location const& seg_from,
-                               location const& seg_to) {
-  auto const merc_loc = to_merc(loc);
-  auto const merc_seg_from = to_merc(seg_from);
-  auto const merc_seg_to = to_merc(seg_to);
-
-  if (merc_loc == merc_seg_from || merc_loc == merc_seg_to) {
-    return loc;
+using cache_cell = snapping_cache::cell;
+
+// Calls fn(value) for the max_query entries with the nearest bounding boxes.
+// If a cached cell is available, the entries are selected from the cell
+// instead of the r-tree. Only entries within max_dist are reported in that
+// case, all others are discarded by the callers anyway.
+template <typename T, typename Fn>
+void nearest_entries(packed_rtree<T> const& rtree,
+                     std::vector<std::pair<packed_rtree_box, T>> const* cached,
+                     location const& loc, unsigned const max_query,
+                     double const max_dist, Fn&& fn) {
+  if (cached == nullptr) {
+    rtree.nearest(loc, max_query, fn);
+    return;
   }
 
-  auto seg_dir = merc_seg_to - merc_seg_from;
-  auto const seg_len = seg_dir.length();
+  auto const scale_x = std::cos(to_rad(loc.lat()));
+  auto const max_dist_fixed = snapping_cache::search_radius(max_dist) /
+                              snapping_cache::meters_per_unit();
+  auto const max_dist_sq = max_dist_fixed * max_dist_fixed;
 
-  if (seg_len < 0.000000001) {
-    return seg_from;
+  auto candidates = std::vector<std::pair<double, T const*>>{};
+  for (auto const& [box, value] : *cached) {
+    auto const d = box_dist_sq(loc, box, scale_x);
+    if (d <= max_dist_sq) {
+      candidates.emplace_back(d, &value);
+    }
   }
-
-  auto const start_vec = merc_loc - merc_seg_from;
-  auto const end_vec = merc_loc - merc_seg_to;
-  auto const start_angle =
-      std::acos(seg_dir.dot(start_vec) / (seg_len * start_vec.length()));
-  auto const end_angle =
-      std::acos(seg_dir.dot(end_vec) / (seg_len * end_vec.length()));
-
-  assert(!std::isnan(start_angle) && !std::isnan(end_angle));
-
-  if (start_angle >= to_rad(90)) {
-    return seg_from;
-  } else if (end_angle <= to_rad(90)) {
-    return seg_to;
-  } else {
-    // law of sines
-    auto const beta = to_rad(90) - start_angle;
-    auto seg_offset = start_vec.length() * std::sin(beta);
-    seg_dir.normalize();
-    auto const point = to_location(merc_seg_from + seg_offset * seg_dir);
-    return point;
+  auto const count = std::min(candidates.size(), std::size_t{max_query});
+  std::partial_sort(
+      begin(candidates), begin(candidates) + count, end(candidates),
+      [](auto const& a, auto const& b) { return a.first < b.first; });
+  for (auto i = std::size_t{0}; i < count; ++i) {
+    fn(*candidates[i].second);
   }
 }
 
+struct snapped_edge {
+  edge const* edge_{};
+  double dist_{};
+  segment_match match_;
+};
+
 input_pt nearest_pt_on_edge(routing_graph_data const& rg, edge const* e,
-                            location const& loc) {
-  using loc_segment_t = boost::geometry::model::segment<location>;
+                            location const& loc, segment_match const& match) {
   if (e == nullptr) {
     return {};
   }
   assert(!e->path_.empty());
-  double min_dist = std::numeric_limits<double>::max();
-  auto nearest_segment = 0U;
   auto const& path = e->path_;
-  for (auto i = 0U; i < path.size() - 1; i++) {
-    auto seg = loc_segment_t{path[i], path[i + 1]};
-    auto const dist = bg::comparable_distance(loc, seg);
-    if (dist < min_dist) {
-      min_dist = dist;
-      nearest_segment = i;
-    }
-  }
-  auto const point = nearest_pt_on_segment(loc, path[nearest_segment],
-                                           path[nearest_segment + 1]);
+  auto const nearest_segment = match.segment_;
+  auto const point =
+      path.size() == 1
+          ? path[0]
+          : interpolate(path[nearest_segment], path[nearest_segment + 1],
+                        match.t_);
   data::vector<location> from_path, to_path;
   std::copy(begin(path), begin(path) + nearest_segment + 1,
             std::back_inserter(from_path));
   from_path.push_back(point);
   std::reverse(begin(from_path), end(from_path));
   to_path.push_back(point);
-  std::copy(begin(path) + nearest_segment + 1, end(path),
-            std::back_inserter(to_path));
+  std::copy(begin(path) + std::min(nearest_segment + 1,
+                                   static_cast<std::uint32_t>(path.size())),
+            end(path), std::back_inserter(to_path));
 
   return {rg, loc, point, e, std::move(from_path), std::move(to_path)};
 }
 
-std::vector<std::pair<edge const*, double>> nearest_edges(
+std::vector<snapped_edge> nearest_edges(
     routing_graph const& g, location const& loc,
     std::optional<std::int16_t> const& opt_level, routing_options const& opt,
-    unsigned max_query, unsigned max_count, double max_dist) {
+    unsigned max_query, unsigned max_count, double max_dist,
+    cache_cell const* cell = nullptr) {
   auto const& levels_vec = g.data_->levels_;
 
   auto const level = opt_level.value_or(0);
@@ -107,25 +104,44 @@ std::vector<std::pair<edge const*, double>> nearest_edges(
                    : opt.no_level_penalty_;
   };
 
-  auto edges = std::vector<std::pair<edge const*, double>>{};
-  edges.reserve(max_query);
-  g.edge_rtree_->query(
-      bgi::nearest(loc, max_query),
-      boost::make_function_output_iterator([&](auto const& entry) {
-        auto const* e = entry.second.get(g.data_);
-        auto const dist = distance(loc, e->path_);
-        if (check_level && opt.force_level_match_ &&
-            !matches_level(levels_vec, e->info(g)->levels_, level,
-                           opt.allow_match_with_no_level_)) {
-          return;
-        }
-        if (dist <= max_dist) {
-          edges.emplace_back(e, check_level ? dist + level_penalty(e) : dist);
-        }
-      }));
+  auto candidates = std::vector<edge const*>{};
+  candidates.reserve(max_query);
+  auto segment_count = std::size_t{0};
+  auto const* cached_edges = cell != nullptr ? &cell->edges_ : nullptr;
+  nearest_entries(g.data_->edge_rtree_, cached_edges, loc, max_query, max_dist,
+                  [&](rg_edge const& entry) {
+                    auto const* e = entry.get(g.data_);
+                    if (check_level && opt.force_level_match_ &&
+                        !matches_level(levels_vec, e->info(g)->levels_, level,
+                                       opt.allow_match_with_no_level_)) {
+                      return;
+                    }
+                    candidates.push_back(e);
+                    segment_count += e->path_.size();
+                  });
+
+  // snap to all candidate edges in one batch
+  auto kernel = snapping_kernel{loc};
+  kernel.reserve(segment_count);
+  for (auto const* e : candidates) {
+    kernel.add_path(e->path_);
+  }
+  kernel.compute();
+
+  auto edges = std::vector<snapped_edge>{};
+  edges.reserve(candidates.size());
+  for (auto i = 0U; i < candidates.size(); ++i) {
+    auto const* e = candidates[i];
+    auto const match = kernel.nearest(i);
+    auto const dist = std::sqrt(match.dist_sq_);
+    if (dist <= max_dist) {
+      edges.push_back(
+          {e, check_level ? dist + level_penalty(e) : dist, match});
+    }
+  }
 
   std::sort(begin(edges), end(edges),
-            [&](auto const& a, auto const& b) { return a.second < b.second; });
+            [&](auto const& a, auto const& b) { return a.dist_ < b.dist_; });
   if (edges.size() > max_count) {
     edges.resize(max_count);
   }
@@ -153,13 +169,14 @@ void find_nearest_edges(routing_graph const& g, std::vector<input_pt>& out_pts,
                         location const& loc,
                         std::optional<std::int16_t> const& opt_level,
                         routing_options const& opt, unsigned max_query,
-                        unsigned max_count, double max_dist) {
-  auto const edges =
-      nearest_edges(g, loc, opt_level, opt, max_query, max_count, max_dist);
+                        unsigned max_count, double max_dist,
+                        cache_cell const* cell) {
+  auto const edges = nearest_edges(g, loc, opt_level, opt, max_query,
+                                   max_count, max_dist, cell);
   std::transform(begin(edges), end(edges), std::back_inserter(out_pts),
-                 [&](auto const& edge_with_dist) {
-                   return nearest_pt_on_edge(*g.data_, edge_with_dist.first,
-                                             loc);
+                 [&](snapped_edge const& se) {
+                   return nearest_pt_on_edge(*g.data_, se.edge_, loc,
+                                             se.match_);
                  });
 }
 
@@ -175,62 +192,74 @@ void print_area_info(routing_graph_data const& rg, area const* a) {
 bool find_containing_areas(routing_graph const& g,
                            std::vector<input_pt>& out_pts, location const& loc,
                            std::optional<std::int16_t> const& level,
-                           routing_options const& opt) {
+                           routing_options const& opt,
+                           cache_cell const* cell) {
   auto const& levels_vec = g.data_->levels_;
   auto const force_level = level && opt.force_level_match_;
   auto found_areas = false;
-  g.area_rtree_->query(
-      bgi::contains(loc) &&
-          bgi::satisfies([&](routing_graph::area_rtree_value_type const& val) {
-            auto const& a = g.data_->areas_[val.second];
-            return bg::within(loc, a.polygon_) &&
-                   (!force_level ||
-                    matches_level(levels_vec, a.levels_, *level,
-                                  opt.allow_match_with_no_level_));
-          }),
-      boost::make_function_output_iterator([&](auto const& entry) {
-        found_areas = true;
-        out_pts.emplace_back(input_pt(loc, &g.data_->areas_[entry.second]));
-      }));
+  auto const check_area = [&](std::uint32_t const area_id) {
+    auto const& a = g.data_->areas_[area_id];
+    if (bg::within(loc, a.polygon_) &&
+        (!force_level || matches_level(levels_vec, a.levels_, *level,
+                                       opt.allow_match_with_no_level_))) {
+      found_areas = true;
+      out_pts.emplace_back(input_pt(loc, &a));
+    }
+  };
+  auto const query = make_packed_rtree_box(loc);
+  if (cell != nullptr) {
+    for (auto const& [box, area_id] : cell->areas_) {
+      if (box.intersects(query)) {
+        check_area(area_id);
+      }
+    }
+  } else {
+    g.data_->area_rtree_.search(query, check_area);
+  }
   return found_areas;
 }
 
 void map_to_area_border(area const* a, input_pt& pt) {
-  using loc_segment_t = boost::geometry::model::segment<location>;
+  using ring_t = typename area::polygon_t::ring_type;
 
   auto const& loc = pt.input_;
-  double min_dist = std::numeric_limits<double>::max();
-  location seg_from, seg_to;
-
-  auto const map_to_ring = [&](auto const& ring) {
-    for (auto i = 0U; i < ring.size() - 1; i++) {
-      auto const& from = ring[i].location_;
-      auto const& to = ring[i + 1].location_;
-      auto seg = loc_segment_t{from, to};
-      auto const dist = bg::comparable_distance(loc, seg);
-      if (dist < min_dist) {
-        min_dist = dist;
-        seg_from = from;
-        seg_to = to;
-      }
-    }
-  };
-
-  map_to_ring(a->polygon_.outer());
+  auto rings = std::vector<ring_t const*>{&a->polygon_.outer()};
   for (auto const& inner : a->polygon_.inners()) {
-    map_to_ring(inner);
+    rings.push_back(&inner);
+  }
+
+  auto kernel = snapping_kernel{loc};
+  for (auto const* ring : rings) {
+    kernel.add_ring(*ring);
+  }
+  kernel.compute();
+
+  auto nearest_ring = std::size_t{0};
+  auto nearest = segment_match{};
+  for (auto i = std::size_t{0}; i < rings.size(); ++i) {
+    auto const match = kernel.nearest(i);
+    if (match.dist_sq_ < nearest.dist_sq_) {
+      nearest = match;
+      nearest_ring = i;
+    }
   }
 
   pt.in_area_ = a;
   pt.outside_of_area_ = true;
-  pt.nearest_pt_ = nearest_pt_on_segment(loc, seg_from, seg_to);
+  if (kernel.segment_count() != 0) {
+    auto const& ring = *rings[nearest_ring];
+    pt.nearest_pt_ = interpolate(ring[nearest.segment_].location_,
+                                 ring[nearest.segment_ + 1].location_,
+                                 nearest.t_);
+  }
 }
 
 void find_nearest_areas(routing_graph const& g, std::vector<input_pt>& out_pts,
                         location const& loc,
                         std::optional<std::int16_t> const& opt_level,
                         routing_options const& opt, unsigned max_query,
-                        unsigned max_count, double max_dist) {
+                        unsigned max_count, double max_dist,
+                        cache_cell const* cell) {
   auto const& levels_vec = g.data_->levels_;
 
   auto const level = opt_level.value_or(0);
@@ -243,10 +272,11 @@ void find_nearest_areas(routing_graph const& g, std::vector<input_pt>& out_pts,
   };
 
   auto areas = std::vector<std::pair<area const*, double>>{};
-  g.area_rtree_->query(
-      bgi::nearest(loc, max_query),
-      boost::make_function_output_iterator([&](auto const& entry) {
-        auto const* a = &g.data_->areas_[entry.second];
+  auto const* cached_areas = cell != nullptr ? &cell->areas_ : nullptr;
+  nearest_entries(
+      g.data_->area_rtree_, cached_areas, loc, max_query, max_dist,
+      [&](std::uint32_t const area_id) {
+        auto const* a = &g.data_->areas_[area_id];
 
         if (check_level && opt.force_level_match_ &&
             !matches_level(levels_vec, a->levels_, level,
@@ -264,7 +294,7 @@ void find_nearest_areas(routing_graph const& g, std::vector<input_pt>& out_pts,
         }
 
         areas.emplace_back(a, check_level ? dist + level_penalty(a) : dist);
-      }));
+      });
   std::sort(begin(areas), end(areas),
             [&](auto const& a, auto const& b) { return a.second < b.second; });
   if (areas.size() > max_count) {
@@ -299,7 +329,8 @@ void resolve_input_area(std::vector<input_pt>& out_pts, area const& a,
 std::vector<input_pt> resolve_input_location(routing_graph const& g,
                                              input_location const& il,
                                              routing_options const& opt,
-                                             bool const expanded) {
+                                             bool const expanded,
+                                             routing_statistics& stats) {
   std::vector<input_pt> pts;
 
   if (il.osm_element_) {
@@ -333,7 +364,16 @@ std::vector<input_pt> resolve_input_location(routing_graph const& g,
     auto const& loc = *il.location_;
     auto const& levels_vec = g.data_->levels_;
 
-    find_containing_areas(g, pts, loc, il.level_, opt);
+    auto cached = snapping_cache::lookup_result{};
+    if (g.snapping_cache_ != nullptr &&
+        g.snapping_cache_->covers(il.max_distance(expanded))) {
+      cached = g.snapping_cache_->get(loc);
+      ++(cached.hit_ ? stats.snapping_cache_hits_
+                     : stats.snapping_cache_misses_);
+    }
+    auto const* cell = cached.cell_.get();
+
+    find_containing_areas(g, pts, loc, il.level_, opt, cell);
 
     auto const area_count = static_cast<unsigned>(pts.size());
     auto const max_count = opt.max_pt_count(expanded);
@@ -343,9 +383,9 @@ std::vector<input_pt> resolve_input_location(routing_graph const& g,
       auto const max_dist = il.max_distance(expanded);
       auto const max_pts = area_count < max_count ? max_count - area_count : 1U;
       find_nearest_areas(g, pts, loc, il.level_, opt, max_query, max_pts,
-                         max_dist);
+                         max_dist, cell);
       find_nearest_edges(g, pts, loc, il.level_, opt, max_query, max_pts,
-                         max_dist);
+                         max_dist, cell);
 
       if (pts.size() > max_count) {
         if (il.level_ && !opt.force_level_match_) {
@@ -84,12 +84,13 @@ search_result find_routes_v2(routing_graph const& g, routing_query const& q) {
   search_result result;
   auto const t_start = timing_now();
 
-  auto start = resolve_input_location(g, q.start_, q.opt_, false);
+  auto start =
+      resolve_input_location(g, q.start_, q.opt_, false, result.stats_);
   auto const t_after_start = timing_now();
   result.stats_.d_start_pts_ = ms_between(t_start, t_after_start);
 
   auto destinations = utl::to_vec(q.destinations_, [&](auto const& il) {
-    return resolve_input_location(g, il, q.opt_, false);
+    return resolve_input_location(g, il, q.opt_, false, result.stats_);
   });
   auto const t_after_dest = timing_now();
   result.stats_.d_destination_pts_ = ms_between(t_after_start, t_after_dest);
@@ -107,7 +108,8 @@ search_result find_routes_v2(routing_graph const& g, routing_query const& q) {
     auto expanded_start = std::vector<input_pt>{};
     if (q.start_.allows_expansion()) {
       auto const t_before_expand_start = timing_now();
-      expanded_start = resolve_input_location(g, q.start_, q.opt_, true);
+      expanded_start =
+          resolve_input_location(g, q.start_, q.opt_, true, result.stats_);
       ++result.stats_.start_pts_extended_;
       result.stats_.d_start_pts_extended_ = ms_since(t_before_expand_start);
       search(expanded_start, destinations);
@@ -124,7 +126,8 @@ search_result find_routes_v2(routing_graph const& g, routing_query const& q) {
             if (expand) {
               ++result.stats_.destination_pts_extended_;
             }
-            return resolve_input_location(g, il, q.opt_, expand);
+            return resolve_input_location(g, il, q.opt_, expand,
+                                          result.stats_);
           });
       result.stats_.d_destination_pts_extended_ =
           ms_since(t_before_expand_dest);
@@ -0,0 +1,117 @@
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PPR_SNAPPING_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PPR_SNAPPING_NEON
+#include <arm_neon.h>
+#endif
+
+#include "ppr/routing/snapping.h"
+
+namespace ppr::routing {
+
+// segments shorter than this are treated as points (t = 0)
+constexpr auto const MIN_SEGMENT_LEN_SQ = 1e-12F;
+
+void snapping_kernel::reserve(std::size_t const segment_count) {
+  from_x_.reserve(segment_count);
+  from_y_.reserve(segment_count);
+  dir_x_.reserve(segment_count);
+  dir_y_.reserve(segment_count);
+}
+
+void snapping_kernel::compute() {
+  auto const n = from_x_.size();
+  t_.resize(n);
+  dist_sq_.resize(n);
+
+  // the query location is the origin of the projection, i.e. (0, 0):
+  // t = clamp(-(from . dir) / |dir|^2, 0, 1)
+  // dist_sq = |from + t * dir|^2
+  auto const* fx = from_x_.data();
+  auto const* fy = from_y_.data();
+  auto const* dx = dir_x_.data();
+  auto const* dy = dir_y_.data();
+  auto* t_out = t_.data();
+  auto* d_out = dist_sq_.data();
+  auto i = std::size_t{0};
+
+#if defined(PPR_SNAPPING_SSE2)
+  auto const zero = _mm_setzero_ps();
+  auto const one = _mm_set1_ps(1.0F);
+  auto const min_len_sq = _mm_set1_ps(MIN_SEGMENT_LEN_SQ);
+  for (; i + 4 <= n; i += 4) {
+    auto const vfx = _mm_loadu_ps(fx + i);
+    auto const vfy = _mm_loadu_ps(fy + i);
+    auto const vdx = _mm_loadu_ps(dx + i);
+    auto const vdy = _mm_loadu_ps(dy + i);
+    auto const len_sq =
+        _mm_add_ps(_mm_mul_ps(vdx, vdx), _mm_mul_ps(vdy, vdy));
+    auto const proj = _mm_sub_ps(
+        zero, _mm_add_ps(_mm_mul_ps(vfx, vdx), _mm_mul_ps(vfy, vdy)));
+    auto const t = _mm_min_ps(
+        _mm_max_ps(_mm_div_ps(proj, _mm_max_ps(len_sq, min_len_sq)), zero),
+        one);
+    auto const px = _mm_add_ps(vfx, _mm_mul_ps(t, vdx));
+    auto const py = _mm_add_ps(vfy, _mm_mul_ps(t, vdy));
+    _mm_storeu_ps(t_out + i, t);
+    _mm_storeu_ps(d_out + i,
+                  _mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)));
+  }
+#elif defined(PPR_SNAPPING_NEON)
+  auto const zero = vdupq_n_f32(0.0F);
+  auto const one = vdupq_n_f32(1.0F);
+  auto const min_len_sq = vdupq_n_f32(MIN_SEGMENT_LEN_SQ);
+  for (; i + 4 <= n; i += 4) {
+    auto const vfx = vld1q_f32(fx + i);
+    auto const vfy = vld1q_f32(fy + i);
+    auto const vdx = vld1q_f32(dx + i);
+    auto const vdy = vld1q_f32(dy + i);
+    auto const len_sq = vaddq_f32(vmulq_f32(vdx, vdx), vmulq_f32(vdy, vdy));
+    auto const proj =
+        vnegq_f32(vaddq_f32(vmulq_f32(vfx, vdx), vmulq_f32(vfy, vdy)));
+    auto const t = vminq_f32(
+        vmaxq_f32(vdivq_f32(proj, vmaxq_f32(len_sq, min_len_sq)), zero), one);
+    auto const px = vaddq_f32(vfx, vmulq_f32(t, vdx));
+    auto const py = vaddq_f32(vfy, vmulq_f32(t, vdy));
+    vst1q_f32(t_out + i, t);
+    vst1q_f32(d_out + i, vaddq_f32(vmulq_f32(px, px), vmulq_f32(py, py)));
+  }
+#endif
+
+  for (; i < n; ++i) {
+    auto const len_sq = dx[i] * dx[i] + dy[i] * dy[i];
+    auto const proj = -(fx[i] * dx[i] + fy[i] * dy[i]);
+    auto const t = std::min(
+        std::max(proj / std::max(len_sq, MIN_SEGMENT_LEN_SQ), 0.0F), 1.0F);
+    auto const px = fx[i] + t * dx[i];
+    auto const py = fy[i] + t * dy[i];
+    t_out[i] = t;
+    d_out[i] = px * px + py * py;
+  }
+}
+
+segment_match snapping_kernel::nearest(std::uint32_t const first,
+                                       std::uint32_t const last) const {
+  auto best = segment_match{};
+  for (auto i = first; i < last; ++i) {
+    if (dist_sq_[i] < best.dist_sq_) {
+      best = {i - first, t_[i], dist_sq_[i]};
+    }
+  }
+  return best;
+}
+
+segment_match snapping_kernel::nearest(std::size_t const path_idx) const {
+  return nearest(path_offsets_[path_idx], path_offsets_[path_idx + 1]);
+}
+
+segment_match snapping_kernel::nearest() const {
+  return nearest(0U, static_cast<std::uint32_t>(from_x_.size()));
+}
+
+}  // namespace ppr::routing
@@ -0,0 +1,43 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ppr/preprocessing/arena.h"
+
+using namespace ppr::preprocessing;
+
+TEST(ArenaTest, StableAddresses) {
+  auto a = arena<std::string, 4>{};
+  auto ptrs = std::vector<std::string*>{};
+  for (auto i = 0; i < 100; ++i) {
+    ptrs.push_back(&a.emplace_back(std::to_string(i)));
+  }
+  ASSERT_EQ(100, a.size());
+  for (auto i = 0; i < 100; ++i) {
+    EXPECT_EQ(ptrs[i], &a[i]);
+    EXPECT_EQ(std::to_string(i), *ptrs[i]);
+  }
+  EXPECT_EQ("99", a.back());
+}
+
+TEST(ArenaTest, Iteration) {
+  auto a = arena<int, 3>{};
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(a.begin(), a.end());
+  for (auto i = 0; i < 10; ++i) {
+    a.emplace_back(i);
+  }
+  auto expected = 0;
+  for (auto& x : a) {
+    EXPECT_EQ(expected++, x);
+    x *= 2;
+  }
+  EXPECT_EQ(10, expected);
+  auto const& ca = a;
+  auto sum = 0;
+  for (auto const& x : ca) {
+    sum += x;
+  }
+  EXPECT_EQ(90, sum);
+}
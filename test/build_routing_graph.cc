@@ -0,0 +1,177 @@
+#include <cstdint>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ppr/common/location_geometry.h"
+#include "ppr/common/parallel.h"
+#include "ppr/preprocessing/build_routing_graph.h"
+#include "ppr/preprocessing/int_graph/int_graph.h"
+#include "ppr/preprocessing/osm_graph/osm_graph.h"
+
+using namespace ppr;
+using namespace ppr::preprocessing;
+
+namespace {
+
+struct osm_graph_builder {
+  osm_node* add_node(double const lon, double const lat) {
+    return &og_.nodes_.emplace_back(++last_osm_id_,
+                                    to_merc(make_location(lon, lat)));
+  }
+
+  edge_info_idx_t add_info(edge_type const type, street_type const street) {
+    return make_edge_info(og_.edge_infos_, ++last_osm_id_, type, street,
+                          crossing_type::NONE)
+        .first;
+  }
+
+  void add_edge(osm_node* from, osm_node* to, edge_info_idx_t const info) {
+    auto& e = from->out_edges_.emplace_back(
+        info, from, to,
+        distance(to_location(from->location_), to_location(to->location_)));
+    e.width_ = 6;
+    e.sidewalk_left_ = true;
+    e.sidewalk_right_ = true;
+  }
+
+  osm_graph og_;
+  std::int64_t last_osm_id_{};
+};
+
+// junctions of four streets, a footway with an entrance and a street with a
+// crossing node in each cell of a grid (the cells are not connected). the
+// arms of a junction are added before its center, so that the junctions are
+// spread over several rounds.
+osm_graph make_junctions_graph(unsigned const cells) {
+  constexpr auto const COLS = 100U;
+  constexpr auto const D = 0.0004;
+  auto b = osm_graph_builder{};
+  for (auto cell = 0U; cell < cells; ++cell) {
+    auto const lon = 8.6 + (cell % COLS) * 10 * D;
+    auto const lat = 49.8 + (cell / COLS) * 10 * D;
+    auto* north = b.add_node(lon, lat + D);
+    auto* east = b.add_node(lon + D, lat);
+    auto* south = b.add_node(lon, lat - D);
+    auto* west = b.add_node(lon - D, lat);
+    auto* center = b.add_node(lon, lat);
+    auto* footway = b.add_node(lon + D, lat + D);
+    auto* entrance = b.add_node(lon + 2 * D, lat + 2 * D);
+    auto* building = b.add_node(lon + 3 * D, lat + 2 * D);
+    auto* crossing = b.add_node(lon - 2 * D, lat);
+    auto* end = b.add_node(lon - 3 * D, lat);
+    entrance->entrance_ = true;
+    crossing->crossing_ = crossing_type::MARKED;
+
+    auto const street =
+        b.add_info(edge_type::STREET, street_type::RESIDENTIAL);
+    auto const path = b.add_info(edge_type::FOOTWAY, street_type::FOOTWAY);
+    b.add_edge(center, north, street);
+    b.add_edge(center, east, street);
+    b.add_edge(south, center, street);
+    b.add_edge(west, center, street);
+    b.add_edge(crossing, west, street);
+    b.add_edge(end, crossing, street);
+    b.add_edge(center, footway, path);
+    b.add_edge(footway, entrance, path);
+    b.add_edge(entrance, building, path);
+  }
+  b.og_.create_in_edges();
+  b.og_.count_edges();
+  return std::move(b.og_);
+}
+
+// one line per edge info, node and edge, followed by the log output
+std::vector<std::string> dump(routing_graph const& g,
+                              std::string const& log_output) {
+  auto const& rg = *g.data_;
+  auto out = std::ostringstream{};
+  out << std::hexfloat;
+  for (auto const& info : rg.edge_infos_) {
+    out << "info " << info.osm_way_id_ << " " << info.name_ << " "
+        << static_cast<int>(info.type_) << " "
+        << static_cast<int>(info.street_type_) << " "
+        << static_cast<int>(info.crossing_type_) << " "
+        << info.marked_crossing_detour_ << "\n";
+  }
+  for (auto const& n : rg.nodes_) {
+    out << "node " << n->id_ << " " << n->osm_id_ << " " << n->location_.lon()
+        << " " << n->location_.lat() << "\n";
+    for (auto const& e : n->out_edges_) {
+      out << "  edge " << e->info_ << " " << e->to_->id_ << " "
+          << e->distance_ << " " << static_cast<int>(e->side_) << " "
+          << e->elevation_up_ << " " << e->elevation_down_;
+      for (auto const& loc : e->path_) {
+        out << " " << loc.lon() << "," << loc.lat();
+      }
+      out << "\n";
+    }
+  }
+  out << "log\n" << log_output;
+
+  auto lines = std::vector<std::string>{};
+  auto in = std::istringstream{out.str()};
+  for (auto line = std::string{}; std::getline(in, line);) {
+    lines.emplace_back(std::move(line));
+  }
+  return lines;
+}
+
+std::vector<std::string> build(unsigned const cells,
+                               std::size_t const threads) {
+  set_thread_count(threads);
+  auto og = make_junctions_graph(cells);
+  auto opt = options{};
+  auto log = logging{};
+  auto log_output = std::ostringstream{};
+  log.out_ = &log_output;
+  auto stats = statistics{};
+  auto ig = build_int_graph(og, opt, log, stats);
+  auto const rg = build_routing_graph(ig, opt, log, stats);
+  set_thread_count(0);
+  return dump(rg, log_output.str());
+}
+
+}  // namespace
+
+TEST(BuildRoutingGraphTest, JunctionsCreateNodesAndInfos) {
+  set_thread_count(1);
+  auto og = make_junctions_graph(1);
+  auto opt = options{};
+  auto log = logging{};
+  auto stats = statistics{};
+  auto ig = build_int_graph(og, opt, log, stats);
+  auto const rg = build_routing_graph(ig, opt, log, stats);
+  set_thread_count(0);
+
+  auto n_entrances = 0U;
+  auto n_crossings = 0U;
+  for (auto const& info : rg.data_->edge_infos_) {
+    n_entrances += info.type_ == edge_type::ENTRANCE ? 1U : 0U;
+    n_crossings += info.type_ == edge_type::CROSSING ? 1U : 0U;
+  }
+  EXPECT_EQ(1U, n_entrances);
+  EXPECT_LT(0U, n_crossings);
+  EXPECT_LT(ig.nodes_.size(), rg.data_->nodes_.size());
+  for (auto i = 0U; i < rg.data_->nodes_.size(); ++i) {
+    EXPECT_EQ(i + 1, rg.data_->nodes_[i]->id_);
+  }
+}
+
+// the junctions of each round are split into several chunks (handled by
+// different worker buffers), the result has to match a serial run
+TEST(BuildRoutingGraphTest, ParallelMatchesSerial) {
+  constexpr auto const CELLS = 1500U;
+  auto const serial = build(CELLS, 1);
+  for (auto const threads : {4U, 7U}) {
+    auto const parallel = build(CELLS, threads);
+    ASSERT_EQ(serial.size(), parallel.size()) << threads << " threads";
+    for (auto i = 0U; i < serial.size(); ++i) {
+      ASSERT_EQ(serial[i], parallel[i]) << threads << " threads, line " << i;
+    }
+  }
+}
@@ -0,0 +1,163 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ppr/common/location_geometry.h"
+#include "ppr/common/routing_graph.h"
+#include "ppr/preprocessing/routing_graph/crossing_detour.h"
+
+using namespace ppr;
+using namespace ppr::preprocessing;
+
+namespace {
+
+// Random graph with footways, marked and unmarked crossings in a ~500m box.
+routing_graph make_random_graph(std::uint32_t const seed) {
+  auto rng = std::mt19937{seed};
+  auto coord = std::uniform_real_distribution<double>{0.0, 0.005};
+  auto pick = std::uniform_int_distribution<int>{0, 9};
+  auto const streets = std::vector<street_type>{
+      street_type::RESIDENTIAL, street_type::SECONDARY, street_type::PRIMARY};
+
+  auto g = routing_graph{};
+  auto& rg = *g.data_;
+  auto constexpr const NODES = 40U;
+  for (auto i = 0U; i < NODES; ++i) {
+    rg.nodes_.emplace_back(data::make_unique<node>(make_node(
+        i, i, make_location(8.65 + coord(rng), 49.87 + coord(rng)))));
+  }
+
+  auto node_dist = std::uniform_int_distribution<std::uint32_t>{0, NODES - 1};
+  for (auto i = 0U; i < 3 * NODES; ++i) {
+    auto const from = node_dist(rng);
+    auto const to = node_dist(rng);
+    if (from == to) {
+      continue;
+    }
+    auto const r = pick(rng);
+    auto const street = streets[static_cast<std::size_t>(r) % streets.size()];
+    auto const [info, _] =
+        r < 6 ? make_edge_info(rg.edge_infos_, i, edge_type::FOOTWAY,
+                               street_type::FOOTWAY, crossing_type::NONE)
+              : make_edge_info(
+                    rg.edge_infos_, i, edge_type::CROSSING, street,
+                    r < 8 ? crossing_type::MARKED : crossing_type::UNMARKED);
+    auto* from_node = rg.nodes_[from].get();
+    auto const* to_node = rg.nodes_[to].get();
+    from_node->out_edges_.emplace_back(data::make_unique<edge>(
+        make_edge(info, from_node, to_node,
+                  distance(from_node->location_, to_node->location_))));
+  }
+  g.create_in_edges();
+  return g;
+}
+
+// Plain Dijkstra without any state reuse, same rules as the detour search.
+double reference_detour(routing_graph_data const& rg, edge const& crossing,
+                        double const limit) {
+  using dist_t = std::pair<double, int>;
+  auto const ref_street = crossing.info(rg)->street_type_;
+  auto dists = std::map<node const*, dist_t>{};
+  auto pq = std::priority_queue<std::pair<dist_t, node const*>,
+                                std::vector<std::pair<dist_t, node const*>>,
+                                std::greater<>>{};
+  dists[crossing.from_] = {0.0, 0};
+  pq.emplace(dist_t{0.0, 0}, crossing.from_);
+
+  auto const relax = [&](edge const& e, node const* dest, dist_t const& d) {
+    auto const* info = e.info(rg);
+    auto const total = d.first + e.distance_;
+    if (total > limit || (info->is_unmarked_crossing() &&
+                          info->street_type_ >= ref_street)) {
+      return;
+    }
+    auto const it = dists.find(dest);
+    if (it == end(dists) || total < it->second.first) {
+      auto const nd = dist_t{total,
+                             d.second + (info->is_marked_crossing() ? 1 : 0)};
+      dists[dest] = nd;
+      pq.emplace(nd, dest);
+    }
+  };
+
+  while (!pq.empty()) {
+    auto const [d, n] = pq.top();
+    pq.pop();
+    if (d.first > dists[n].first) {
+      continue;
+    }
+    if (n == crossing.to_) {
+      return d.second > 0 ? d.first : 0;
+    }
+    for (auto const& e : n->out_edges_) {
+      relax(*e, e->to_, d);
+    }
+    for (auto const& e : n->in_edges_) {
+      relax(*e, e->from_, d);
+    }
+  }
+  return 0;
+}
+
+std::vector<edge*> unmarked_crossings(routing_graph_data& rg) {
+  auto crossings = std::vector<edge*>{};
+  for (auto& n : rg.nodes_) {
+    for (auto& e : n->out_edges_) {
+      if (e->info(rg)->is_unmarked_crossing()) {
+        crossings.push_back(e.get());
+      }
+    }
+  }
+  return crossings;
+}
+
+}  // namespace
+
+TEST(CrossingDetourTest, MatchesReferenceDijkstra) {
+  auto opt = options{};
+  opt.crossing_detours_limit_ = 400;
+  auto log = logging{};
+  auto detours = 0;
+  for (auto seed = 1U; seed <= 20U; ++seed) {
+    auto g = make_random_graph(seed);
+    auto& rg = *g.data_;
+    calc_crossing_detours(g, opt, log);
+    for (auto const* e : unmarked_crossings(rg)) {
+      auto const expected = static_cast<std::int32_t>(
+          std::ceil(reference_detour(rg, *e, opt.crossing_detours_limit_)));
+      EXPECT_EQ(expected, e->info(rg)->marked_crossing_detour_)
+          << "seed " << seed;
+      detours += expected != 0 ? 1 : 0;
+    }
+  }
+  EXPECT_GT(detours, 0);
+}
+
+TEST(CrossingDetourTest, WorkspaceReuseAcrossTimestampReset) {
+  constexpr auto const LIMIT = 400.0;
+  // starts right before the wrap-around, the stamp is reset after a few
+  // searches while the table still contains entries of earlier searches
+  auto ws = detour_workspace{std::numeric_limits<std::uint32_t>::max() - 3};
+  auto searches = 0;
+  for (auto seed = 100U; seed < 110U; ++seed) {
+    auto g = make_random_graph(seed);
+    auto& rg = *g.data_;
+    for (auto const* e : unmarked_crossings(rg)) {
+      // every crossing twice, the second search reuses the filled table
+      for (auto i = 0; i < 2; ++i) {
+        EXPECT_DOUBLE_EQ(reference_detour(rg, *e, LIMIT),
+                         distance_with_marked_crossings(rg, *e, LIMIT, ws))
+            << "seed " << seed;
+        ++searches;
+      }
+    }
+  }
+  EXPECT_GT(searches, 10);
+}
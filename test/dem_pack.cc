@@ -0,0 +1,75 @@
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+
+#include "gtest/gtest.h"
+
+#include "ppr/preprocessing/elevation/dem_grid.h"
+#include "ppr/preprocessing/elevation/dem_pack.h"
+#include "ppr/preprocessing/elevation/dem_source.h"
+
+namespace fs = boost::filesystem;
+
+using namespace ppr;
+using namespace ppr::preprocessing::elevation;
+
+TEST(DemPackTest, TileRoundtrip) {
+  auto const width = 7U;
+  auto values = std::vector<elevation_t>{};
+  for (auto i = 0; i < 7 * 5; ++i) {
+    values.push_back(static_cast<elevation_t>(i % 3 == 0 ? NO_ELEVATION_DATA
+                                                         : 100 + i * 37 % 50));
+  }
+  values[3] = 32767;
+  values[4] = -32768;
+
+  auto const encoded = encode_dem_tile(values, width);
+  auto decoded = std::vector<elevation_t>(values.size());
+  decode_dem_tile(encoded.data(), encoded.size(), width, decoded);
+  EXPECT_EQ(values, decoded);
+}
+
+TEST(DemPackTest, PackMatchesGrid) {
+  auto const dir = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(dir);
+
+  // 30 x 20 pixels of 0.1 degrees, upper left pixel centered at (8.05, 50.95)
+  auto const cols = 30;
+  auto const rows = 20;
+  {
+    auto hdr = std::ofstream{(dir / "test.hdr").string()};
+    hdr << "NROWS " << rows << "\nNCOLS " << cols
+        << "\nNBITS 16\nPIXELTYPE SIGNEDINT\nNODATA -9999\n"
+           "ULXMAP 8.0\nULYMAP 51.0\nXDIM 0.1\nYDIM 0.1\n";
+    auto bil = std::ofstream{(dir / "test.bil").string(), std::ios::binary};
+    for (auto y = 0; y < rows; ++y) {
+      for (auto x = 0; x < cols; ++x) {
+        auto const val =
+            static_cast<std::int16_t>(x == y ? -9999 : 200 + x * 3 - y * 2);
+        bil.write(reinterpret_cast<char const*>(&val), sizeof(val));
+      }
+    }
+  }
+
+  auto const pack_file = (dir / "test.pprdem").string();
+  auto log = std::stringstream{};
+  write_dem_pack({(dir / "test.hdr").string()}, pack_file, 8, log);
+
+  auto const grid = dem_grid{(dir / "test.hdr").string()};
+  auto source = dem_source{1024};  // forces tile evictions
+  source.add_file(pack_file);
+  for (auto y = 0; y < rows; ++y) {
+    for (auto x = 0; x < cols; ++x) {
+      auto const loc =
+          make_location(8.0 + 0.1 * x + 0.05, 51.0 - 0.1 * y - 0.05);
+      EXPECT_EQ(grid.get(loc), source.get(loc));
+    }
+  }
+  EXPECT_EQ(NO_ELEVATION_DATA, source.get(make_location(7.5, 50.5)));
+
+  fs::remove_all(dir);
+}
@@ -0,0 +1,95 @@
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+
+#include "gtest/gtest.h"
+
+#include "ppr/preprocessing/elevation/dem_grid.h"
+#include "ppr/preprocessing/elevation/dem_source.h"
+
+namespace fs = boost::filesystem;
+
+using namespace ppr;
+using namespace ppr::preprocessing::elevation;
+
+namespace {
+
+// bil grid with 0.1 degree pixels, value(col, row), -9999 = no data
+std::string write_grid(fs::path const& dir, std::string const& name,
+                       int const cols, int const rows, double const ulx,
+                       double const uly,
+                       std::function<std::int16_t(int, int)> const& value) {
+  auto const hdr_file = (dir / (name + ".hdr")).string();
+  auto hdr = std::ofstream{hdr_file};
+  hdr << "NROWS " << rows << "\nNCOLS " << cols
+      << "\nNBITS 16\nPIXELTYPE SIGNEDINT\nNODATA -9999\nULXMAP " << ulx
+      << "\nULYMAP " << uly << "\nXDIM 0.1\nYDIM 0.1\n";
+  auto bil = std::ofstream{(dir / (name + ".bil")).string(), std::ios::binary};
+  for (auto y = 0; y < rows; ++y) {
+    for (auto x = 0; x < cols; ++x) {
+      auto const val = value(x, y);
+      bil.write(reinterpret_cast<char const*>(&val), sizeof(val));
+    }
+  }
+  return hdr_file;
+}
+
+}  // namespace
+
+TEST(DemSourceTest, BatchedGetMatchesSingleGet) {
+  auto const dir = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(dir);
+
+  // a: [8.0, 9.5] x [50.0, 51.0], no data on one diagonal
+  // b: [9.0, 10.5] x [50.5, 52.0], overlaps a in [9.0, 9.5] x [50.5, 51.0]
+  auto const a_file = write_grid(dir, "a", 15, 10, 8.0, 51.0, [](int x, int y) {
+    return static_cast<std::int16_t>(x + y == 14 ? -9999 : 100 + x + 20 * y);
+  });
+  auto const b_file = write_grid(dir, "b", 15, 15, 9.0, 52.0, [](int x, int y) {
+    return static_cast<std::int16_t>(1000 + x + 20 * y);
+  });
+
+  auto source = dem_source{};
+  source.add_file(a_file);
+  source.add_file(b_file);
+  {
+    auto const a = dem_grid{a_file};
+    auto const b = dem_grid{b_file};
+
+    // overlap: the grid added first wins, unless it has no data
+    auto const a_wins = make_location(9.15, 50.85);
+    EXPECT_EQ(a.get(a_wins), source.get(a_wins));
+    EXPECT_NE(b.get(a_wins), source.get(a_wins));
+    auto const b_fills = make_location(9.25, 50.75);
+    EXPECT_EQ(NO_ELEVATION_DATA, a.get(b_fills));
+    EXPECT_EQ(b.get(b_fills), source.get(b_fills));
+    EXPECT_EQ(NO_ELEVATION_DATA, source.get(make_location(8.5, 51.5)));
+  }
+
+  // unsorted locations in and around both grids (several index cells)
+  auto rng = std::mt19937{42};
+  auto lon = std::uniform_real_distribution<double>{7.5, 11.0};
+  auto lat = std::uniform_real_distribution<double>{49.5, 52.5};
+  auto locs = std::vector<location>{};
+  for (auto i = 0; i < 20000; ++i) {
+    locs.push_back(make_location(lon(rng), lat(rng)));
+  }
+
+  auto const batched = source.get(locs);
+  ASSERT_EQ(locs.size(), batched.size());
+  auto n_with_data = 0U;
+  for (auto i = 0U; i < locs.size(); ++i) {
+    EXPECT_EQ(source.get(locs[i]), batched[i]) << "location " << i;
+    n_with_data += batched[i] != NO_ELEVATION_DATA ? 1U : 0U;
+  }
+  EXPECT_LT(0U, n_with_data);
+  EXPECT_GT(locs.size(), n_with_data);
+  EXPECT_TRUE(source.get(std::vector<location>{}).empty());
+
+  fs::remove_all(dir);
+}
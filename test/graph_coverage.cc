@@ -0,0 +1,31 @@
+#include "gtest/gtest.h"
+
+#include "ppr/backend/graph_coverage.h"
+
+using namespace ppr;
+using namespace ppr::backend;
+
+TEST(GraphCoverageTest, ContainsGrownCells) {
+  auto coverage = graph_coverage{};
+  coverage.add(make_location(8.65, 49.87));
+  coverage.add(make_location(8.66, 49.88));
+  EXPECT_EQ(1, coverage.size());
+  coverage.grow();
+  EXPECT_EQ(9, coverage.size());
+
+  EXPECT_TRUE(coverage.contains(make_location(8.65, 49.87)));
+  EXPECT_TRUE(coverage.contains(make_location(8.51, 49.71)));
+  EXPECT_TRUE(coverage.contains(make_location(8.79, 49.99)));
+  EXPECT_FALSE(coverage.contains(make_location(8.81, 49.87)));
+  EXPECT_FALSE(coverage.contains(make_location(8.65, 49.69)));
+}
+
+TEST(GraphCoverageTest, NegativeCoordinates) {
+  auto coverage = graph_coverage{};
+  coverage.add(make_location(-0.05, -0.05));
+  coverage.grow();
+  EXPECT_TRUE(coverage.contains(make_location(-0.15, -0.15)));
+  EXPECT_TRUE(coverage.contains(make_location(0.05, 0.05)));
+  EXPECT_FALSE(coverage.contains(make_location(0.15, 0.05)));
+  EXPECT_FALSE(coverage.contains(make_location(-0.25, -0.05)));
+}
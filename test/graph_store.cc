@@ -0,0 +1,195 @@
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+
+#include "gtest/gtest.h"
+
+#include "ppr/backend/graph_store.h"
+#include "ppr/common/location_geometry.h"
+#include "ppr/serialization/writer.h"
+
+namespace fs = boost::filesystem;
+
+using namespace ppr;
+using namespace ppr::backend;
+
+namespace {
+
+// size x size nodes starting at (lon, lat) with edges to the right
+// neighbours, osm ids are the node indices
+routing_graph make_grid_graph(unsigned const size, double const lon,
+                              double const lat) {
+  auto g = routing_graph{};
+  auto& rg = *g.data_;
+  rg.names_.emplace_back(std::string_view{});
+  auto const [info, _] =
+      make_edge_info(rg.edge_infos_, 1, edge_type::FOOTWAY,
+                     street_type::FOOTWAY, crossing_type::NONE);
+  for (auto row = 0U; row < size; ++row) {
+    for (auto col = 0U; col < size; ++col) {
+      auto const id = row * size + col;
+      rg.nodes_.emplace_back(data::make_unique<node>(make_node(
+          id + 1, id, make_location(lon + col * 0.004, lat + row * 0.004))));
+    }
+  }
+  for (auto row = 0U; row < size; ++row) {
+    for (auto col = 0U; col + 1 < size; ++col) {
+      auto* from = rg.nodes_[row * size + col].get();
+      auto const* to = rg.nodes_[row * size + col + 1].get();
+      from->out_edges_.emplace_back(data::make_unique<edge>(
+          make_edge(info, from, to, distance(from->location_, to->location_))));
+    }
+  }
+  rg.max_node_id_ = size * size;
+  return g;
+}
+
+// writes the graph next to the graph file and moves it into place
+void replace_graph_file(routing_graph const& g, std::string const& file) {
+  auto const tmp = file + ".tmp";
+  auto stats = preprocessing::statistics{};
+  serialization::write_routing_graph(g, tmp, stats);
+  fs::rename(tmp, file);
+}
+
+void wait_for_reload(graph_store const& store) {
+  while (store.reloading()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+}
+
+struct GraphStoreTest : public ::testing::Test {
+  void SetUp() override {
+    dir_ = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(dir_);
+    opt_.name_ = "test";
+    opt_.graph_file_ = (dir_ / "routing-graph.ppr").string();
+    opt_.coverage_ = true;
+  }
+
+  void TearDown() override { fs::remove_all(dir_); }
+
+  fs::path dir_;
+  graph_options opt_;
+  std::ostringstream log_;
+};
+
+auto const OLD_LOC = make_location(8.601, 49.801);
+auto const NEW_LOC = make_location(9.601, 50.801);
+
+}  // namespace
+
+TEST_F(GraphStoreTest, ReloadSwapsGraph) {
+  replace_graph_file(make_grid_graph(3, 8.6, 49.8), opt_.graph_file_);
+  auto store = graph_store{opt_, log_};
+
+  auto const old_snapshot = store.get_snapshot();
+  auto const old_graph = store.get();
+  EXPECT_EQ(1U, store.version());
+  EXPECT_EQ(1U, old_snapshot.version_);
+  EXPECT_EQ(old_graph, old_snapshot.graph_);
+  ASSERT_NE(nullptr, old_snapshot.coverage_);
+  EXPECT_EQ(store.coverage(), old_snapshot.coverage_);
+  EXPECT_TRUE(old_snapshot.coverage_->contains(OLD_LOC));
+  EXPECT_FALSE(old_snapshot.coverage_->contains(NEW_LOC));
+
+  replace_graph_file(make_grid_graph(4, 9.6, 50.8), opt_.graph_file_);
+
+  // readers always see a graph with its own version and coverage
+  auto stop = std::atomic_bool{false};
+  auto inconsistent = std::atomic<unsigned>{0};
+  auto reader = std::thread{[&]() {
+    while (!stop) {
+      auto const s = store.get_snapshot();
+      auto const is_new = s.graph_->data_->nodes_.size() == 16;
+      if (s.version_ != (is_new ? 2U : 1U) ||
+          s.coverage_->contains(NEW_LOC) != is_new ||
+          s.coverage_->contains(OLD_LOC) == is_new ||
+          store.version() < s.version_) {
+        ++inconsistent;
+      }
+    }
+  }};
+  EXPECT_TRUE(store.reload());
+  wait_for_reload(store);
+  stop = true;
+  reader.join();
+  EXPECT_EQ(0U, inconsistent);
+
+  auto const new_snapshot = store.get_snapshot();
+  EXPECT_EQ(2U, store.version());
+  EXPECT_EQ(2U, new_snapshot.version_);
+  EXPECT_EQ(16U, new_snapshot.graph_->data_->nodes_.size());
+  EXPECT_EQ(store.get(), new_snapshot.graph_);
+  EXPECT_EQ(store.coverage(), new_snapshot.coverage_);
+  EXPECT_TRUE(new_snapshot.coverage_->contains(NEW_LOC));
+  EXPECT_FALSE(new_snapshot.coverage_->contains(OLD_LOC));
+
+  // the old graph (mapped from the replaced file) is still usable
+  EXPECT_EQ(1U, old_snapshot.version_);
+  EXPECT_TRUE(old_snapshot.coverage_->contains(OLD_LOC));
+  EXPECT_NE(old_graph, store.get());
+  ASSERT_EQ(9U, old_graph->data_->nodes_.size());
+  auto osm_ids = std::vector<std::int64_t>{};
+  auto n_edges = 0U;
+  for (auto const& n : old_graph->data_->nodes_) {
+    osm_ids.push_back(n->osm_id_);
+    EXPECT_TRUE(n->location_.valid());
+    for (auto const& e : n->out_edges_) {
+      EXPECT_EQ(n.get(), e->from_);
+      EXPECT_EQ(1, e->info(*old_graph->data_)->osm_way_id_);
+      ++n_edges;
+    }
+  }
+  EXPECT_EQ((std::vector<std::int64_t>{0, 1, 2, 3, 4, 5, 6, 7, 8}), osm_ids);
+  EXPECT_EQ(6U, n_edges);
+}
+
+TEST_F(GraphStoreTest, FailedReloadKeepsGraph) {
+  replace_graph_file(make_grid_graph(3, 8.6, 49.8), opt_.graph_file_);
+  auto store = graph_store{opt_, log_};
+  auto const graph = store.get();
+  auto const coverage = store.coverage();
+
+  auto const expect_unchanged = [&]() {
+    auto const s = store.get_snapshot();
+    EXPECT_EQ(1U, store.version());
+    EXPECT_EQ(1U, s.version_);
+    EXPECT_EQ(graph, s.graph_);
+    EXPECT_EQ(coverage, s.coverage_);
+    EXPECT_EQ(9U, s.graph_->data_->nodes_.size());
+  };
+
+  // invalid file
+  {
+    auto const tmp = opt_.graph_file_ + ".tmp";
+    std::ofstream{tmp, std::ios::binary} << "not a routing graph";
+    fs::rename(tmp, opt_.graph_file_);
+  }
+  ASSERT_TRUE(store.reload());
+  wait_for_reload(store);
+  expect_unchanged();
+  EXPECT_NE(std::string::npos,
+            log_.str().find("Routing graph reload failed"));
+
+  // missing file
+  fs::remove(opt_.graph_file_);
+  ASSERT_TRUE(store.reload());
+  wait_for_reload(store);
+  expect_unchanged();
+
+  // the next valid file is loaded
+  replace_graph_file(make_grid_graph(4, 9.6, 50.8), opt_.graph_file_);
+  ASSERT_TRUE(store.reload());
+  wait_for_reload(store);
+  EXPECT_EQ(2U, store.version());
+  EXPECT_EQ(16U, store.get()->data_->nodes_.size());
+}
@@ -0,0 +1,238 @@
+#include <cstdint>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ppr/common/location_geometry.h"
+#include "ppr/common/parallel.h"
+#include "ppr/preprocessing/int_graph/int_graph.h"
+#include "ppr/preprocessing/int_graph/sidewalks.h"
+#include "ppr/preprocessing/osm_graph/osm_graph.h"
+
+using namespace ppr;
+using namespace ppr::preprocessing;
+
+namespace {
+
+constexpr auto const D = 0.0002;
+
+struct osm_graph_builder {
+  osm_node* add_node(std::int64_t const osm_id, double const lon,
+                     double const lat) {
+    return &og_.nodes_.emplace_back(osm_id, to_merc(make_location(lon, lat)));
+  }
+
+  edge_info_idx_t add_info(std::int64_t const osm_way_id, edge_type const type,
+                           street_type const street) {
+    return make_edge_info(og_.edge_infos_, osm_way_id, type, street,
+                          crossing_type::NONE)
+        .first;
+  }
+
+  osm_edge& add_edge(osm_node* from, osm_node* to,
+                     edge_info_idx_t const info) {
+    auto& e = from->out_edges_.emplace_back(
+        info, from, to,
+        distance(to_location(from->location_), to_location(to->location_)));
+    e.elevation_up_ = 1;
+    return e;
+  }
+
+  osm_graph og_;
+};
+
+// osm ids: base + 1..13, ways: base + 101..103
+//  - plain chain (street): 1 -> 2 -> 3 -> 4, the first edge is wider and on
+//    another layer (both don't split chains, the int edge gets the values of
+//    the first edge)
+//  - chain with another way in the middle (footway): 5 -> 6 -> 7 -> 8 -> 9,
+//    7 -> 8 -> 9 belong to another way
+//  - cycle of chain nodes (footway): 10 -> 11 -> 12 -> 13 -> 10
+void add_chains(osm_graph_builder& b, std::int64_t const base,
+                double const lon, double const lat) {
+  auto const street =
+      b.add_info(base + 101, edge_type::STREET, street_type::RESIDENTIAL);
+  auto const footway =
+      b.add_info(base + 102, edge_type::FOOTWAY, street_type::FOOTWAY);
+  auto const other_footway =
+      b.add_info(base + 103, edge_type::FOOTWAY, street_type::FOOTWAY);
+
+  auto* n1 = b.add_node(base + 1, lon, lat);
+  auto* n2 = b.add_node(base + 2, lon + D, lat);
+  auto* n3 = b.add_node(base + 3, lon + 2 * D, lat + D);
+  auto* n4 = b.add_node(base + 4, lon + 3 * D, lat + D);
+  auto& first = b.add_edge(n1, n2, street);
+  first.width_ = 8;
+  first.layer_ = 1;
+  for (auto const& [from, to] : {std::pair{n2, n3}, std::pair{n3, n4}}) {
+    auto& e = b.add_edge(from, to, street);
+    e.width_ = 6;
+  }
+  for (auto* e : {&first, &n2->out_edges_[0], &n3->out_edges_[0]}) {
+    e->sidewalk_left_ = true;
+    e->sidewalk_right_ = true;
+  }
+
+  auto* n5 = b.add_node(base + 5, lon, lat + 2 * D);
+  auto* n6 = b.add_node(base + 6, lon + D, lat + 2 * D);
+  auto* n7 = b.add_node(base + 7, lon + 2 * D, lat + 2 * D);
+  auto* n8 = b.add_node(base + 8, lon + 3 * D, lat + 2 * D);
+  auto* n9 = b.add_node(base + 9, lon + 4 * D, lat + 2 * D);
+  b.add_edge(n5, n6, footway);
+  b.add_edge(n6, n7, footway);
+  b.add_edge(n7, n8, other_footway);
+  b.add_edge(n8, n9, other_footway);
+
+  auto* n10 = b.add_node(base + 10, lon, lat + 4 * D);
+  auto* n11 = b.add_node(base + 11, lon + D, lat + 4 * D);
+  auto* n12 = b.add_node(base + 12, lon + D, lat + 5 * D);
+  auto* n13 = b.add_node(base + 13, lon, lat + 5 * D);
+  b.add_edge(n10, n11, footway);
+  b.add_edge(n11, n12, footway);
+  b.add_edge(n12, n13, footway);
+  b.add_edge(n13, n10, footway);
+}
+
+int_graph build(osm_graph& og) {
+  og.create_in_edges();
+  auto opt = options{};
+  auto log = logging{};
+  auto stats = statistics{};
+  return build_int_graph(og, opt, log, stats);
+}
+
+int_edge const* find_edge(int_graph const& ig, std::int64_t const from,
+                          std::int64_t const to) {
+  for (auto const& n : ig.nodes_) {
+    for (auto const* e : n.out_edges_) {
+      if (e->from_->osm_id_ == from && e->to_->osm_id_ == to) {
+        return e;
+      }
+    }
+  }
+  return nullptr;
+}
+
+std::vector<merc> osm_path(osm_graph const& og,
+                           std::vector<std::int64_t> const& osm_ids) {
+  auto path = std::vector<merc>{};
+  for (auto const id : osm_ids) {
+    for (auto const& n : og.nodes_) {
+      if (n.osm_id_ == id) {
+        path.push_back(n.location_);
+      }
+    }
+  }
+  return path;
+}
+
+double path_distance(std::vector<merc> const& path) {
+  auto d = 0.0;
+  for (auto i = 1U; i < path.size(); ++i) {
+    d += distance(to_location(path[i - 1]), to_location(path[i]));
+  }
+  return d;
+}
+
+// one line per int node and edge
+std::vector<std::string> dump(int_graph const& ig) {
+  auto lines = std::vector<std::string>{};
+  for (auto const& n : ig.nodes_) {
+    auto out = std::ostringstream{};
+    out << std::hexfloat << "node " << n.osm_id_ << " " << n.location_.x()
+        << " " << n.location_.y();
+    lines.emplace_back(out.str());
+    for (auto const* e : n.out_edges_) {
+      out = std::ostringstream{};
+      out << std::hexfloat << "  edge " << e->info_ << " " << e->to_->osm_id_
+          << " " << e->distance_ << " " << e->sidewalk_left_
+          << e->sidewalk_right_ << " " << static_cast<int>(e->layer_) << " "
+          << e->elevation_up_ << " " << e->from_angle_ << " " << e->to_angle_;
+      for (auto const* path : {&e->path_left_, &e->path_right_}) {
+        out << " |";
+        for (auto const& mc : *path) {
+          out << " " << mc.x() << "," << mc.y();
+        }
+      }
+      lines.emplace_back(out.str());
+    }
+  }
+  return lines;
+}
+
+}  // namespace
+
+TEST(IntGraphTest, CompressChains) {
+  auto b = osm_graph_builder{};
+  add_chains(b, 0, 8.6, 49.8);
+  auto const ig = build(b.og_);
+  auto const& og = b.og_;
+
+  // 1, 4, 5, 7, 9 and one node of the cycle
+  EXPECT_EQ(6U, ig.nodes_.size());
+  EXPECT_EQ(4U, ig.edges_.size());
+
+  // plain chain: sidewalks generated for the whole path with the width of
+  // the first edge
+  auto const* street = find_edge(ig, 1, 4);
+  ASSERT_NE(nullptr, street);
+  auto const street_path = osm_path(og, {1, 2, 3, 4});
+  auto const [left, right] = generate_sidewalk_paths(street_path, 8);
+  EXPECT_EQ(left, street->path_left_);
+  EXPECT_EQ(right, street->path_right_);
+  EXPECT_DOUBLE_EQ(path_distance(street_path), street->distance_);
+  EXPECT_EQ(1, street->layer_);
+  EXPECT_EQ(3, street->elevation_up_);
+  EXPECT_TRUE(street->sidewalk_left_);
+  EXPECT_TRUE(street->sidewalk_right_);
+
+  // the chain is split where the way changes
+  auto const* first_way = find_edge(ig, 5, 7);
+  auto const* second_way = find_edge(ig, 7, 9);
+  ASSERT_NE(nullptr, first_way);
+  ASSERT_NE(nullptr, second_way);
+  EXPECT_EQ(102, first_way->info(ig)->osm_way_id_);
+  EXPECT_EQ(103, second_way->info(ig)->osm_way_id_);
+  EXPECT_EQ(osm_path(og, {5, 6, 7}), first_way->path_left_);
+  EXPECT_EQ(osm_path(og, {7, 8, 9}), second_way->path_left_);
+  EXPECT_TRUE(first_way->path_right_.empty());
+  EXPECT_EQ(2, first_way->elevation_up_);
+  EXPECT_EQ(first_way->to_, second_way->from_);
+
+  // cycle: a single edge from the first node of the cycle back to it
+  auto const* cycle = find_edge(ig, 10, 10);
+  ASSERT_NE(nullptr, cycle);
+  EXPECT_EQ(osm_path(og, {10, 11, 12, 13, 10}), cycle->path_left_);
+  EXPECT_EQ(4, cycle->elevation_up_);
+  EXPECT_DOUBLE_EQ(path_distance(cycle->path_left_), cycle->distance_);
+  EXPECT_EQ(cycle->from_, cycle->to_);
+}
+
+// chains cross the boundaries of the chunks that are handled in parallel
+TEST(IntGraphTest, CompressChainsIndependentOfThreadCount) {
+  auto const build_dump = [](std::size_t const threads) {
+    set_thread_count(threads);
+    auto b = osm_graph_builder{};
+    for (auto i = 0; i < 1000; ++i) {
+      add_chains(b, i * 1000, 8.6 + (i % 50) * 10 * D,
+                 49.8 + (i / 50) * 10 * D);
+    }
+    auto const ig = build(b.og_);
+    set_thread_count(0);
+    return dump(ig);
+  };
+
+  auto const serial = build_dump(1);
+  ASSERT_EQ(6000U + 4000U, serial.size());
+  for (auto const threads : {2U, 5U}) {
+    auto const parallel = build_dump(threads);
+    ASSERT_EQ(serial.size(), parallel.size()) << threads << " threads";
+    for (auto i = 0U; i < serial.size(); ++i) {
+      ASSERT_EQ(serial[i], parallel[i]) << threads << " threads, line " << i;
+    }
+  }
+}
@@ -158,3 +158,23 @@ TEST(LevelParserTest, Invalid1) {
   EXPECT_FALSE(lvl.has_single_level());
   EXPECT_FALSE(lvl.has_multiple_levels());
 }
+
+TEST(LevelParserTest, CopyLevels) {
+  auto from = levels_vector_t{};
+  auto to = levels_vector_t{};
+  auto const other = get_levels("3;4", to);
+  auto const multi = get_levels("0;1", from);
+  auto const single = get_levels("2", from);
+
+  auto const copied_multi = copy_levels(multi, from, to);
+  ASSERT_TRUE(copied_multi.has_multiple_levels());
+  EXPECT_NE(copied_multi.multi_level_index(), other.multi_level_index());
+  EXPECT_THAT(to.at(copied_multi.multi_level_index()),
+              ElementsAre(unchecked_from_human_level(0),
+                          unchecked_from_human_level(1)));
+  EXPECT_EQ(copy_levels(multi, from, to), copied_multi);
+  EXPECT_EQ(to.size(), 2U);
+
+  EXPECT_EQ(copy_levels(single, from, to), single);
+  EXPECT_EQ(copy_levels(levels{}, from, to), levels{});
+}
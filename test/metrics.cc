@@ -0,0 +1,66 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ppr/backend/metrics.h"
+
+using namespace ppr::backend;
+
+TEST(MetricsTest, HistogramBuckets) {
+  auto h = latency_histogram{};
+  h.observe(0.2);
+  h.observe(1.0);  // upper bounds are inclusive
+  h.observe(7.0);
+  h.observe(20'000.0);
+
+  auto const s = h.read();
+  EXPECT_EQ(4, s.count_);
+  EXPECT_NEAR(20'008.2, s.sum_, 0.01);
+  EXPECT_EQ(1, s.buckets_[0]);  // <= 0.5
+  EXPECT_EQ(1, s.buckets_[1]);  // <= 1
+  EXPECT_EQ(1, s.buckets_[4]);  // <= 10
+  EXPECT_EQ(1, s.buckets_.back());  // +Inf
+}
+
+TEST(MetricsTest, CounterFromThreads) {
+  auto c = sharded_counter{};
+  auto threads = std::vector<std::thread>{};
+  for (auto t = 0; t < 4; ++t) {
+    threads.emplace_back([&]() {
+      for (auto i = 0; i < 1000; ++i) {
+        c.add();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(4000, c.read());
+}
+
+TEST(MetricsTest, PrometheusFormat) {
+  auto h = latency_histogram{};
+  h.observe(3.0);
+
+  auto w = prometheus_writer{};
+  w.family("test_seconds", "histogram", "Test");
+  w.histogram("test_seconds", prometheus_writer::label("phase", "a"),
+              h.read());
+  w.sample("test_total", {}, std::uint64_t{42});
+
+  auto const& out = w.str();
+  auto const contains = [&](char const* line) {
+    return out.find(line) != std::string::npos;
+  };
+  EXPECT_TRUE(contains("# TYPE test_seconds histogram\n"));
+  EXPECT_TRUE(contains("test_seconds_bucket{phase=\"a\",le=\"0.0025\"} 0\n"));
+  EXPECT_TRUE(contains("test_seconds_bucket{phase=\"a\",le=\"0.005\"} 1\n"));
+  EXPECT_TRUE(contains("test_seconds_bucket{phase=\"a\",le=\"+Inf\"} 1\n"));
+  EXPECT_TRUE(contains("test_seconds_count{phase=\"a\"} 1\n"));
+  EXPECT_TRUE(contains("test_total 42\n"));
+
+  EXPECT_EQ(R"(graph="a\"b\\c")",
+            prometheus_writer::label("graph", "a\"b\\c"));
+}
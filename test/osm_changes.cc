@@ -0,0 +1,153 @@
+#include <cstdint>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+
+#include "osmium/builder/attr.hpp"
+#include "osmium/io/pbf_output.hpp"
+#include "osmium/memory/buffer.hpp"
+
+#include "gtest/gtest.h"
+
+#include "ppr/preprocessing/update/osm_changes.h"
+
+namespace fs = boost::filesystem;
+
+using namespace ppr;
+using namespace ppr::preprocessing;
+
+namespace {
+
+template <typename Set>
+std::vector<std::int64_t> sorted(Set const& set) {
+  auto v = std::vector<std::int64_t>(begin(set), end(set));
+  std::sort(begin(v), end(v));
+  return v;
+}
+
+template <typename Fn>
+void write_pbf(std::string const& filename, Fn&& fn) {
+  auto buffer = osmium::memory::Buffer{
+      1024, osmium::memory::Buffer::auto_grow::yes};
+  fn(buffer);
+  auto writer = osmium::io::Writer{filename};
+  writer(std::move(buffer));
+  writer.close();
+}
+
+}  // namespace
+
+TEST(OsmChangesTest, ReadOsc) {
+  auto const dir = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(dir);
+  auto const file = (dir / "changes.osc").string();
+  {
+    auto out = std::ofstream{file};
+    out << R"(<?xml version="1.0" encoding="UTF-8"?>
+<osmChange version="0.6" generator="test">
+  <!-- <node id="99"/> -->
+  <create>
+    <node id="1" version="1" lat="49.8728" lon="8.6512"/>
+    <way id="10" version="1">
+      <nd ref="1"/>
+      <nd ref="2"/>
+      <tag k="highway" v="footway"/>
+    </way>
+  </create>
+  <modify>
+    <node id='2' version='2' lon='8.6520' lat='49.8730'>
+      <tag k="highway" v="crossing"/>
+    </node>
+    <relation id="20" version="3">
+      <member type="way" ref="11" role="outer"/>
+      <member type="node" ref="3" role=""/>
+      <tag k="type" v="multipolygon"/>
+    </relation>
+    <relation id="21" version="1"/>
+    <member type="way" ref="12" role="outer"/>
+  </modify>
+  <delete>
+    <node id="4" version="5"/>
+    <way id="13" version="2"/>
+  </delete>
+</osmChange>
+)";
+  }
+
+  auto const changes = read_osm_changes(file, "");
+  EXPECT_EQ((std::vector<std::int64_t>{1, 2, 4}), sorted(changes.nodes_));
+  // way members of changed relations are included, members outside of a
+  // relation element are not
+  EXPECT_EQ((std::vector<std::int64_t>{10, 11, 13}), sorted(changes.ways_));
+  EXPECT_EQ((std::vector<std::int64_t>{20, 21}), sorted(changes.relations_));
+  ASSERT_EQ(2, changes.node_locations_.size());
+  EXPECT_EQ(make_location(8.6512, 49.8728), changes.node_locations_[0]);
+  EXPECT_EQ(make_location(8.6520, 49.8730), changes.node_locations_[1]);
+
+  EXPECT_THROW(read_osm_changes((dir / "missing.osc").string(), ""),
+               std::runtime_error);
+  fs::remove_all(dir);
+}
+
+TEST(OsmChangesTest, DiffPbf) {
+  using namespace osmium::builder::attr;  // NOLINT
+
+  auto const dir = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(dir);
+  auto const old_file = (dir / "old.osm.pbf").string();
+  auto const new_file = (dir / "new.osm.pbf").string();
+
+  write_pbf(old_file, [](osmium::memory::Buffer& b) {
+    osmium::builder::add_node(b, _id(1), _location(8.6500, 49.8700));
+    osmium::builder::add_node(b, _id(2), _location(8.6510, 49.8700));
+    osmium::builder::add_node(b, _id(3), _location(8.6520, 49.8700));
+    osmium::builder::add_way(b, _id(10), _nodes({1, 2}),
+                             _tag("highway", "footway"));
+    osmium::builder::add_way(b, _id(11), _nodes({2, 3}),
+                             _tag("highway", "path"));
+    osmium::builder::add_relation(b, _id(20),
+                                  _member(osmium::item_type::way, 11, "outer"),
+                                  _tag("type", "multipolygon"));
+  });
+  write_pbf(new_file, [](osmium::memory::Buffer& b) {
+    osmium::builder::add_node(b, _id(1), _location(8.6500, 49.8700));
+    osmium::builder::add_node(b, _id(2), _location(8.6510, 49.8710));
+    osmium::builder::add_node(b, _id(4), _location(8.6530, 49.8700));
+    osmium::builder::add_way(b, _id(10), _nodes({1, 2}),
+                             _tag("highway", "steps"));
+    osmium::builder::add_way(b, _id(11), _nodes({2, 3}),
+                             _tag("highway", "path"));
+    osmium::builder::add_way(b, _id(12), _nodes({1, 4}),
+                             _tag("highway", "path"));
+    osmium::builder::add_relation(b, _id(20),
+                                  _member(osmium::item_type::way, 11, "outer"),
+                                  _member(osmium::item_type::way, 12, "outer"),
+                                  _tag("type", "multipolygon"));
+  });
+
+  // node 2 moved, node 3 deleted, node 4 created, way 10 retagged, way 12
+  // created, relation 20 got a new member
+  auto const changes = read_osm_changes(old_file, new_file);
+  EXPECT_EQ((std::vector<std::int64_t>{2, 3, 4}), sorted(changes.nodes_));
+  EXPECT_EQ((std::vector<std::int64_t>{10, 11, 12}), sorted(changes.ways_));
+  EXPECT_EQ((std::vector<std::int64_t>{20}), sorted(changes.relations_));
+
+  auto const has_location = [&](location const& loc) {
+    return std::find(begin(changes.node_locations_),
+                     end(changes.node_locations_),
+                     loc) != end(changes.node_locations_);
+  };
+  EXPECT_EQ(4, changes.node_locations_.size());
+  EXPECT_TRUE(has_location(make_location(8.6510, 49.8700)));
+  EXPECT_TRUE(has_location(make_location(8.6510, 49.8710)));
+  EXPECT_TRUE(has_location(make_location(8.6520, 49.8700)));
+  EXPECT_TRUE(has_location(make_location(8.6530, 49.8700)));
+  EXPECT_FALSE(has_location(make_location(8.6500, 49.8700)));
+
+  fs::remove_all(dir);
+}
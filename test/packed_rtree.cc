@@ -0,0 +1,116 @@
+#include <cstdint>
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ppr/common/packed_rtree.h"
+
+using namespace ppr;
+
+namespace {
+
+std::vector<std::pair<packed_rtree_box, std::uint32_t>> random_entries(
+    std::size_t const count) {
+  auto gen = std::mt19937{42};
+  auto lon = std::uniform_real_distribution<double>{8.5, 8.8};
+  auto lat = std::uniform_real_distribution<double>{49.8, 50.0};
+  auto ext = std::uniform_real_distribution<double>{0.0, 0.002};
+  auto entries = std::vector<std::pair<packed_rtree_box, std::uint32_t>>{};
+  for (auto i = 0U; i < count; ++i) {
+    auto const a = make_location(lon(gen), lat(gen));
+    auto const b = make_location(a.lon() + ext(gen), a.lat() + ext(gen));
+    entries.emplace_back(make_packed_rtree_box(std::vector{a, b}), i);
+  }
+  return entries;
+}
+
+}  // namespace
+
+TEST(PackedRtreeTest, Empty) {
+  auto const rtree = build_packed_rtree<std::uint32_t>({});
+  EXPECT_TRUE(rtree.empty());
+  auto found = 0U;
+  rtree.search(make_packed_rtree_box(make_location(8.6, 49.9)),
+               [&](std::uint32_t) { ++found; });
+  rtree.nearest(make_location(8.6, 49.9), 10, [&](std::uint32_t) { ++found; });
+  EXPECT_EQ(found, 0U);
+}
+
+TEST(PackedRtreeTest, SearchMatchesBruteForce) {
+  for (auto const count : {1U, 15U, 16U, 17U, 1000U, 5000U}) {
+    auto const entries = random_entries(count);
+    auto const rtree = build_packed_rtree(entries);
+    EXPECT_EQ(rtree.size(), count);
+
+    auto const query = make_packed_rtree_box(std::vector{
+        make_location(8.60, 49.85), make_location(8.65, 49.90)});
+    auto expected = std::vector<std::uint32_t>{};
+    for (auto const& [box, value] : entries) {
+      if (box.intersects(query)) {
+        expected.push_back(value);
+      }
+    }
+    auto found = std::vector<std::uint32_t>{};
+    rtree.search(query, [&](std::uint32_t const v) { found.push_back(v); });
+
+    std::sort(begin(expected), end(expected));
+    std::sort(begin(found), end(found));
+    EXPECT_EQ(found, expected);
+  }
+}
+
+TEST(PackedRtreeTest, NearestIsOrdered) {
+  auto const entries = random_entries(5000);
+  auto const rtree = build_packed_rtree(entries);
+  auto const loc = make_location(8.65, 49.9);
+
+  auto found = std::vector<std::uint32_t>{};
+  rtree.nearest(loc, 20, [&](std::uint32_t const v) { found.push_back(v); });
+  ASSERT_EQ(found.size(), 20U);
+
+  auto const dist = [&](packed_rtree_box const& b) {
+    auto const scale_x = std::cos(to_rad(loc.lat()));
+    auto const dx = std::max({static_cast<double>(b.min_x_) - loc.x(), 0.0,
+                              static_cast<double>(loc.x()) - b.max_x_});
+    auto const dy = std::max({static_cast<double>(b.min_y_) - loc.y(), 0.0,
+                              static_cast<double>(loc.y()) - b.max_y_});
+    return dx * dx * scale_x * scale_x + dy * dy;
+  };
+
+  auto all = std::vector<double>{};
+  for (auto const& e : entries) {
+    all.push_back(dist(e.first));
+  }
+  std::sort(begin(all), end(all));
+
+  for (auto i = 0U; i < found.size(); ++i) {
+    EXPECT_DOUBLE_EQ(dist(entries[found[i]].first), all[i]);
+  }
+}
+
+TEST(PackedRtreeTest, LargeParallelBuild) {
+  auto const entries = random_entries(300000);
+  auto const rtree = build_packed_rtree(entries);
+  EXPECT_EQ(rtree.size(), entries.size());
+
+  auto seen = std::vector<bool>(entries.size());
+  for (auto const v : rtree.values_) {
+    EXPECT_FALSE(seen[v]);
+    seen[v] = true;
+  }
+
+  auto const query = make_packed_rtree_box(
+      std::vector{make_location(8.70, 49.95), make_location(8.71, 49.96)});
+  auto expected = std::size_t{0};
+  for (auto const& e : entries) {
+    if (e.first.intersects(query)) {
+      ++expected;
+    }
+  }
+  auto found = std::size_t{0};
+  rtree.search(query, [&](std::uint32_t) { ++found; });
+  EXPECT_EQ(found, expected);
+}
@@ -0,0 +1,201 @@
+#include <cstdint>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+
+#include "gtest/gtest.h"
+
+#include "ppr/common/location_geometry.h"
+#include "ppr/preprocessing/partition/partitions.h"
+#include "ppr/serialization/writer.h"
+
+namespace fs = boost::filesystem;
+
+using namespace ppr;
+using namespace ppr::preprocessing;
+
+TEST(PartitionsTest, Cells) {
+  auto opt = options{};
+  opt.partition_size_ = 0.5;
+  opt.graph_file_ = "out/routing-graph.ppr";
+
+  auto const p = get_partition(opt, make_location(8.6512, 49.8728));
+  EXPECT_EQ((partition{17, 99}), p);
+  EXPECT_EQ((partition{-1, -1}),
+            get_partition(opt, make_location(-0.0001, -0.4999)));
+  EXPECT_EQ((partition{-2, 0}),
+            get_partition(opt, make_location(-0.5001, 0.4999)));
+
+  auto const file = get_partition_file(opt, partition{-3, 12});
+  EXPECT_EQ("out/routing-graph.ppr.-3_12.part", file);
+  EXPECT_EQ((partition{-3, 12}), get_partition_from_file(file));
+  EXPECT_THROW(get_partition_from_file("routing-graph.ppr"),
+               std::runtime_error);
+  EXPECT_THROW(parse_partition("12"), std::runtime_error);
+}
+
+TEST(PartitionsTest, RegionCoversCellAndHalo) {
+  auto opt = options{};
+  opt.partition_size_ = 0.1;
+  opt.partition_halo_ = 500;
+  opt.crossing_detours_limit_ = 600;
+
+  auto const region = get_partition_region(opt, partition{86, 498});
+  EXPECT_EQ(100, region->core_size());
+  EXPECT_TRUE(region->in_core(make_location(8.6001, 49.8001)));
+  EXPECT_TRUE(region->in_core(make_location(8.6999, 49.8999)));
+  EXPECT_FALSE(region->in_core(make_location(8.7001, 49.85)));
+  EXPECT_TRUE(region->in_region(make_location(8.7001, 49.85)));
+  EXPECT_TRUE(region->in_region(make_location(8.65, 49.7999)));
+  EXPECT_FALSE(region->in_region(make_location(8.65, 49.7801)));
+}
+
+namespace {
+
+using edge_key = std::tuple<std::int64_t, std::int64_t, std::int64_t, double>;
+
+// 20 x 20 nodes with edges to the right and upper neighbours (in both
+// directions), osm ids are the node indices
+routing_graph make_grid_graph() {
+  auto constexpr const SIZE = 20U;
+  auto g = routing_graph{};
+  auto& rg = *g.data_;
+  // names[0] = empty string, edge_infos[0] = additional edges
+  rg.names_.emplace_back(std::string_view{});
+  make_edge_info(rg.edge_infos_, 0, edge_type::FOOTWAY, street_type::NONE,
+                 crossing_type::NONE);
+  for (auto row = 0U; row < SIZE; ++row) {
+    for (auto col = 0U; col < SIZE; ++col) {
+      auto const id = row * SIZE + col;
+      rg.nodes_.emplace_back(data::make_unique<node>(
+          make_node(id, id, make_location(8.561 + col * 0.004,
+                                          49.761 + row * 0.004))));
+    }
+  }
+  auto const connect = [&](std::uint32_t const a, std::uint32_t const b) {
+    for (auto const& [from, to] : {std::pair{a, b}, std::pair{b, a}}) {
+      auto* from_node = rg.nodes_[from].get();
+      auto const* to_node = rg.nodes_[to].get();
+      auto const [info, _] = make_edge_info(
+          rg.edge_infos_, static_cast<std::int64_t>(rg.edge_infos_.size()),
+          edge_type::FOOTWAY, street_type::FOOTWAY, crossing_type::NONE);
+      from_node->out_edges_.emplace_back(data::make_unique<edge>(
+          make_edge(info, from_node, to_node,
+                    distance(from_node->location_, to_node->location_))));
+    }
+  };
+  for (auto row = 0U; row < SIZE; ++row) {
+    for (auto col = 0U; col < SIZE; ++col) {
+      auto const id = row * SIZE + col;
+      if (col + 1 < SIZE) {
+        connect(id, id + 1);
+      }
+      if (row + 1 < SIZE) {
+        connect(id, id + SIZE);
+      }
+    }
+  }
+  return g;
+}
+
+// what a build restricted to the partition region extracts from the input:
+// all nodes in the region and the edges between them
+routing_graph make_partition_graph(routing_graph_data const& full,
+                                   update_region const& region) {
+  auto g = routing_graph{};
+  auto& rg = *g.data_;
+  rg.names_.emplace_back(std::string_view{});
+  make_edge_info(rg.edge_infos_, 0, edge_type::FOOTWAY, street_type::NONE,
+                 crossing_type::NONE);
+  auto nodes = std::map<node const*, node*>{};
+  for (auto const& n : full.nodes_) {
+    if (region.in_region(n->location_)) {
+      nodes[n.get()] = rg.nodes_
+                           .emplace_back(data::make_unique<node>(
+                               make_node(n->id_, n->osm_id_, n->location_)))
+                           .get();
+    }
+  }
+  rg.max_node_id_ = full.max_node_id_;
+  for (auto const& [full_node, n] : nodes) {
+    for (auto const& e : full_node->out_edges_) {
+      if (auto const it = nodes.find(e->to_); it != end(nodes)) {
+        auto const* full_info = e->info(full);
+        auto const [info, _] = make_edge_info(
+            rg.edge_infos_, full_info->osm_way_id_, full_info->type_,
+            full_info->street_type_, full_info->crossing_type_);
+        n->out_edges_.emplace_back(data::make_unique<edge>(
+            make_edge(info, n, it->second, e->distance_)));
+      }
+    }
+  }
+  return g;
+}
+
+std::vector<edge_key> get_edges(routing_graph_data const& rg) {
+  auto edges = std::vector<edge_key>{};
+  for (auto const& n : rg.nodes_) {
+    for (auto const& e : n->out_edges_) {
+      edges.emplace_back(e->from_->osm_id_, e->to_->osm_id_,
+                         e->info(rg)->osm_way_id_, e->distance_);
+    }
+  }
+  std::sort(begin(edges), end(edges));
+  return edges;
+}
+
+std::vector<std::int64_t> get_nodes(routing_graph_data const& rg) {
+  auto nodes = std::vector<std::int64_t>{};
+  for (auto const& n : rg.nodes_) {
+    nodes.push_back(n->osm_id_);
+  }
+  std::sort(begin(nodes), end(nodes));
+  return nodes;
+}
+
+}  // namespace
+
+TEST(PartitionsTest, MergeMatchesSinglePassBuild) {
+  auto const dir = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directories(dir);
+
+  auto opt = options{};
+  opt.partition_size_ = 0.02;
+  opt.partition_halo_ = 100;
+  opt.crossing_detours_limit_ = 100;
+  opt.graph_file_ = (dir / "routing-graph.ppr").string();
+
+  auto const full = make_grid_graph();
+  auto partitions = std::vector<partition>{};
+  for (auto const& n : full.data_->nodes_) {
+    partitions.push_back(get_partition(opt, n->location_));
+  }
+  std::sort(begin(partitions), end(partitions));
+  partitions.erase(std::unique(begin(partitions), end(partitions)),
+                   end(partitions));
+  ASSERT_EQ(16, partitions.size());
+
+  auto stats = statistics{};
+  auto files = std::vector<std::string>{};
+  for (auto const& p : partitions) {
+    auto const region = get_partition_region(opt, p);
+    auto const part = make_partition_graph(*full.data_, *region);
+    EXPECT_LT(part.data_->nodes_.size(), full.data_->nodes_.size());
+    files.push_back(get_partition_file(opt, p));
+    serialization::write_routing_graph(part, files.back(), stats);
+  }
+
+  auto log = logging{};
+  auto const merged = merge_partitions(opt, files, log, stats);
+  EXPECT_EQ(0, stats.partition_.n_unmatched_edges_);
+  EXPECT_EQ(get_nodes(*full.data_), get_nodes(*merged.data_));
+  EXPECT_EQ(get_edges(*full.data_), get_edges(*merged.data_));
+
+  fs::remove_all(dir);
+}
@@ -0,0 +1,39 @@
+#include "gtest/gtest.h"
+
+#include "rapidjson/document.h"
+
+#include "ppr/backend/profile_registry.h"
+
+using namespace ppr::backend;
+using namespace ppr::routing;
+
+TEST(ProfileRegistryTest, NamedProfiles) {
+  auto registry = profile_registry{};
+  auto profile = search_profile{};
+  profile.wheelchair_ = true;
+  registry.add("wheelchair", profile);
+
+  auto const p = registry.get("wheelchair");
+  ASSERT_NE(nullptr, p);
+  EXPECT_TRUE(p->wheelchair_);
+  EXPECT_EQ(p, registry.get("wheelchair"));
+  EXPECT_EQ(nullptr, registry.get("unknown"));
+  EXPECT_FALSE(registry.default_profile()->wheelchair_);
+}
+
+TEST(ProfileRegistryTest, CachesAdHocProfiles) {
+  auto registry = profile_registry{};
+  rapidjson::Document a, b, c;
+  a.Parse(R"({"walking_speed": 1.0, "wheelchair": true})");
+  b.Parse(R"({"walking_speed":1.0,"wheelchair":true})");
+  c.Parse(R"({"walking_speed": 1.2})");
+
+  auto const pa = registry.get(a);
+  EXPECT_DOUBLE_EQ(1.0, pa->walking_speed_);
+  EXPECT_TRUE(pa->wheelchair_);
+  EXPECT_EQ(pa, registry.get(b));
+
+  auto const pc = registry.get(c);
+  EXPECT_NE(pa, pc);
+  EXPECT_DOUBLE_EQ(1.2, pc->walking_speed_);
+}
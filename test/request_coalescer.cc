@@ -0,0 +1,32 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ppr/backend/request_coalescer.h"
+
+using namespace ppr::backend;
+
+TEST(RequestCoalescerTest, AttachesToRunningRequest) {
+  auto coalescer = request_coalescer<std::string>{};
+  auto results = std::vector<std::string>{};
+  auto const collect = [&](std::string const& r) { results.push_back(r); };
+
+  EXPECT_TRUE(coalescer.join("a", collect));
+  EXPECT_FALSE(coalescer.join("a", collect));
+  EXPECT_TRUE(coalescer.join("b", collect));
+  EXPECT_EQ(2, coalescer.in_flight());
+
+  coalescer.finish("a", "route a");
+  EXPECT_EQ((std::vector<std::string>{"route a", "route a"}), results);
+  EXPECT_EQ(1, coalescer.in_flight());
+
+  // finished requests are not reused
+  EXPECT_TRUE(coalescer.join("a", collect));
+  coalescer.finish("a", "route a2");
+  coalescer.finish("b", "route b");
+  EXPECT_EQ(4, results.size());
+  EXPECT_EQ("route a2", results[2]);
+  EXPECT_EQ("route b", results[3]);
+  EXPECT_EQ(0, coalescer.in_flight());
+}
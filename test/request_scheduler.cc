@@ -0,0 +1,103 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "boost/asio/io_context.hpp"
+
+#include "ppr/backend/request_scheduler.h"
+
+using namespace ppr::backend;
+
+TEST(RequestSchedulerTest, PriorityAndQueueLimit) {
+  auto pool = boost::asio::io_context{};
+  auto scheduler = request_scheduler{pool, 3, std::chrono::milliseconds{0}};
+  auto order = std::vector<int>{};
+  auto const task = [&](int const id) {
+    return [&order, id](request_scheduler::clock::duration,
+                        bool const expired) {
+      EXPECT_FALSE(expired);
+      order.push_back(id);
+    };
+  };
+
+  EXPECT_TRUE(scheduler.post(request_priority::NORMAL, task(1)));
+  EXPECT_TRUE(scheduler.post(request_priority::NORMAL, task(2)));
+  EXPECT_TRUE(scheduler.post(request_priority::HIGH, task(3)));
+  EXPECT_FALSE(scheduler.post(request_priority::HIGH, task(4)));
+  EXPECT_EQ(3, scheduler.stats().queued_);
+  EXPECT_EQ(1, scheduler.stats().rejected_);
+
+  pool.run();
+  EXPECT_EQ((std::vector<int>{3, 1, 2}), order);
+  EXPECT_EQ(0, scheduler.stats().queued_);
+}
+
+TEST(RequestSchedulerTest, HighPriorityOvertakesBatch) {
+  auto pool = boost::asio::io_context{};
+  auto scheduler = request_scheduler{pool, 0, std::chrono::milliseconds{0}};
+  auto order = std::vector<int>{};
+
+  // route batch items are queued individually with normal priority
+  for (auto i = 0; i < 5; ++i) {
+    scheduler.post(request_priority::NORMAL,
+                   [&order, i](request_scheduler::clock::duration, bool) {
+                     order.push_back(i);
+                   });
+  }
+  scheduler.post(request_priority::HIGH,
+                 [&order](request_scheduler::clock::duration, bool) {
+                   order.push_back(-1);
+                 });
+  EXPECT_EQ(6, scheduler.stats().queued_);
+
+  pool.run();
+  EXPECT_EQ((std::vector<int>{-1, 0, 1, 2, 3, 4}), order);
+}
+
+TEST(RequestSchedulerTest, ExpiredRequests) {
+  auto pool = boost::asio::io_context{};
+  auto scheduler = request_scheduler{pool, 0, std::chrono::milliseconds{1}};
+  auto expired_count = 0;
+  for (auto i = 0; i < 3; ++i) {
+    scheduler.post(request_priority::NORMAL,
+                   [&](request_scheduler::clock::duration const wait,
+                       bool const expired) {
+                     EXPECT_EQ(expired, wait > std::chrono::milliseconds{1});
+                     expired_count += expired ? 1 : 0;
+                   });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds{5});
+  pool.run();
+  EXPECT_EQ(3, expired_count);
+  EXPECT_EQ(3, scheduler.stats().expired_);
+}
+
+TEST(RequestSchedulerTest, AdmittedTasksBypassQueueLimit) {
+  auto pool = boost::asio::io_context{};
+  auto scheduler = request_scheduler{pool, 2, std::chrono::milliseconds{0}};
+  auto order = std::vector<int>{};
+  auto const task = [&](int const id) {
+    return [&order, id](request_scheduler::clock::duration, bool) {
+      order.push_back(id);
+    };
+  };
+
+  // items of an admitted batch neither fail at nor fill the limit
+  for (auto i = 0; i < 5; ++i) {
+    EXPECT_TRUE(scheduler.post(request_priority::NORMAL, task(i), true));
+  }
+  EXPECT_TRUE(scheduler.post(request_priority::NORMAL, task(5)));
+  EXPECT_TRUE(scheduler.post(request_priority::NORMAL, task(6)));
+  EXPECT_FALSE(scheduler.post(request_priority::NORMAL, task(7)));
+  EXPECT_TRUE(scheduler.post(request_priority::NORMAL, task(8), true));
+  EXPECT_EQ(8, scheduler.stats().queued_);
+  EXPECT_EQ(1, scheduler.stats().rejected_);
+
+  pool.run();
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6, 8}), order);
+  EXPECT_EQ(0, scheduler.stats().queued_);
+  EXPECT_TRUE(scheduler.post(request_priority::NORMAL, task(9)));
+  EXPECT_TRUE(scheduler.post(request_priority::NORMAL, task(10)));
+}
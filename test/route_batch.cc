@@ -0,0 +1,115 @@
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rapidjson/document.h"
+
+#include "ppr/backend/route_batch.h"
+
+using namespace ppr::backend;
+
+namespace {
+
+// requests are identified by their graph, items with "fail" can't be parsed
+route_request parse(rapidjson::Value const& item) {
+  if (item.HasMember("fail")) {
+    throw std::runtime_error{"Unknown profile"};
+  }
+  auto r = route_request{};
+  r.graph_ = item["graph"].GetString();
+  return r;
+}
+
+rapidjson::Document parse_json(std::string const& json) {
+  auto doc = rapidjson::Document{};
+  doc.Parse(json.c_str());
+  EXPECT_FALSE(doc.HasParseError());
+  return doc;
+}
+
+}  // namespace
+
+TEST(RouteBatchTest, ResultsInRequestOrder) {
+  auto const doc = parse_json(R"([{"graph": "a"}, {"fail": true}, 42,)"
+                              R"( {"graph": "b"}, {"graph": "c"}])");
+  auto batch = route_batch{doc, parse};
+  ASSERT_EQ(5U, batch.size());
+  EXPECT_FALSE(batch.done());
+
+  // requests are handed out in request order, invalid ones are skipped
+  auto const a = batch.next();
+  auto const b = batch.next();
+  auto const c = batch.next();
+  EXPECT_EQ(0U, a);
+  EXPECT_EQ(3U, b);
+  EXPECT_EQ(4U, c);
+  EXPECT_EQ(batch.size(), batch.next());
+  EXPECT_EQ(batch.size(), batch.next());
+  EXPECT_EQ("a", batch.request(a).graph_);
+  EXPECT_EQ("b", batch.request(b).graph_);
+  EXPECT_EQ("c", batch.request(c).graph_);
+
+  // results arrive in any order
+  EXPECT_FALSE(batch.set_result(c, R"({"route": "c"})"));
+  EXPECT_FALSE(batch.set_result(a, R"({"route": "a"})"));
+  EXPECT_FALSE(batch.done());
+  EXPECT_TRUE(batch.set_result(b, R"({"route": "b"})"));
+  EXPECT_TRUE(batch.done());
+  EXPECT_EQ(
+      R"([{"route": "a"},{"error":"Unknown profile"},)"
+      R"({"error": "Invalid route request"},{"route": "b"},{"route": "c"}])",
+      batch.response());
+}
+
+TEST(RouteBatchTest, EmptyAndInvalidBatches) {
+  auto const empty = parse_json("[]");
+  auto empty_batch = route_batch{empty, parse};
+  EXPECT_EQ(0U, empty_batch.size());
+  EXPECT_TRUE(empty_batch.done());
+  EXPECT_EQ(0U, empty_batch.next());
+  EXPECT_EQ("[]", empty_batch.response());
+
+  // nothing to compute, the response is ready right away
+  auto const invalid = parse_json(R"([null, {"fail": 1}])");
+  auto invalid_batch = route_batch{invalid, parse};
+  EXPECT_EQ(2U, invalid_batch.size());
+  EXPECT_TRUE(invalid_batch.done());
+  EXPECT_EQ(invalid_batch.size(), invalid_batch.next());
+  EXPECT_EQ(
+      R"([{"error": "Invalid route request"},{"error":"Unknown profile"}])",
+      invalid_batch.response());
+}
+
+TEST(RouteBatchTest, ConcurrentResults) {
+  constexpr auto const N = 1000U;
+  auto json = std::string{"["};
+  auto expected = std::string{"["};
+  for (auto i = 0U; i < N; ++i) {
+    json += (i == 0 ? "" : ",") + std::string{R"({"graph": "g"})"};
+    expected += (i == 0 ? "" : ",") + std::to_string(i);
+  }
+  json += "]";
+  expected += "]";
+  auto const doc = parse_json(json);
+  auto batch = route_batch{doc, parse};
+
+  auto n_last = std::atomic<unsigned>{0};
+  auto workers = std::vector<std::thread>{};
+  for (auto t = 0; t < 4; ++t) {
+    workers.emplace_back([&]() {
+      for (auto i = batch.next(); i != batch.size(); i = batch.next()) {
+        n_last += batch.set_result(i, std::to_string(i)) ? 1U : 0U;
+      }
+    });
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  EXPECT_EQ(1U, n_last);
+  EXPECT_TRUE(batch.done());
+  EXPECT_EQ(expected, batch.response());
+}
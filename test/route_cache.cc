@@ -0,0 +1,62 @@
+#include "gtest/gtest.h"
+
+#include "ppr/backend/route_cache.h"
+#include "ppr/backend/route_key.h"
+
+using namespace ppr;
+using namespace ppr::backend;
+using namespace ppr::routing;
+
+namespace {
+
+route_request make_request(double const lng) {
+  auto r = route_request{};
+  r.start_ = make_input_location(make_location(lng, 49.87));
+  r.destination_ = make_input_location(make_location(8.66, 49.88));
+  r.profile_ = std::make_shared<search_profile const>();
+  return r;
+}
+
+}  // namespace
+
+TEST(RouteCacheTest, KeysDistinguishRequests) {
+  auto const a = make_request(8.65);
+  auto b = a;
+  EXPECT_EQ(make_route_key("g", 1, a), make_route_key("g", 1, b));
+  EXPECT_NE(make_route_key("g", 1, a), make_route_key("g", 2, a));
+  EXPECT_NE(make_route_key("g", 1, a), make_route_key("h", 1, a));
+  b.include_steps_ = true;
+  EXPECT_NE(make_route_key("g", 1, a), make_route_key("g", 1, b));
+  b = a;
+  b.profile_ = std::make_shared<search_profile const>();
+  EXPECT_NE(make_route_key("g", 1, a), make_route_key("g", 1, b));
+  EXPECT_NE(make_route_key("g", 1, a),
+            make_route_key("g", 1, make_request(8.6501)));
+}
+
+TEST(RouteCacheTest, EvictsLeastRecentlyUsed) {
+  auto cache = route_cache{2000};
+  auto const r1 = make_request(8.1);
+  auto const r2 = make_request(8.2);
+  auto const r3 = make_request(8.3);
+  auto const k1 = make_route_key("g", 1, r1);
+  auto const k2 = make_route_key("g", 1, r2);
+  auto const k3 = make_route_key("g", 1, r3);
+
+  EXPECT_FALSE(cache.get(k1).has_value());
+  cache.put(k1, std::string(400, '1'), r1.profile_);
+  cache.put(k2, std::string(400, '2'), r2.profile_);
+  EXPECT_EQ(std::string(400, '1'), cache.get(k1));  // k2 is now the oldest
+  cache.put(k3, std::string(400, '3'), r3.profile_);
+
+  EXPECT_TRUE(cache.get(k1).has_value());
+  EXPECT_FALSE(cache.get(k2).has_value());
+  EXPECT_TRUE(cache.get(k3).has_value());
+
+  auto const stats = cache.stats();
+  EXPECT_EQ(3, stats.hits_);
+  EXPECT_EQ(2, stats.misses_);
+  EXPECT_EQ(1, stats.evictions_);
+  EXPECT_EQ(2, stats.entries_);
+  EXPECT_LE(stats.memory_, 2000);
+}
@@ -0,0 +1,89 @@
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ppr/common/location_geometry.h"
+#include "ppr/routing/snapping.h"
+
+using namespace ppr;
+using namespace ppr::routing;
+
+TEST(SnappingTest, NearestSegment) {
+  auto const loc = make_location(8.6500, 49.8700);
+  auto const path = std::vector<location>{make_location(8.6490, 49.8710),
+                                          make_location(8.6510, 49.8710),
+                                          make_location(8.6510, 49.8690)};
+  auto kernel = snapping_kernel{loc};
+  auto const path_idx = kernel.add_path(path);
+  kernel.compute();
+
+  auto const match = kernel.nearest(path_idx);
+  EXPECT_EQ(match.segment_, 1U);
+  EXPECT_NEAR(match.t_, 0.5, 0.001);
+
+  auto const pt = interpolate(path[1], path[2], match.t_);
+  EXPECT_NEAR(std::sqrt(match.dist_sq_), distance(loc, pt), 0.1);
+  EXPECT_NEAR(pt.lon(), 8.6510, 0.0000001);
+  EXPECT_NEAR(pt.lat(), 49.8700, 0.0000001);
+}
+
+TEST(SnappingTest, ClampToEndpoint) {
+  auto const loc = make_location(8.6480, 49.8700);
+  auto const path = std::vector<location>{make_location(8.6490, 49.8700),
+                                          make_location(8.6510, 49.8700)};
+  auto kernel = snapping_kernel{loc};
+  auto const path_idx = kernel.add_path(path);
+  kernel.compute();
+
+  auto const match = kernel.nearest(path_idx);
+  EXPECT_EQ(match.segment_, 0U);
+  EXPECT_DOUBLE_EQ(match.t_, 0.0);
+  EXPECT_NEAR(std::sqrt(match.dist_sq_), distance(loc, path[0]), 0.1);
+}
+
+TEST(SnappingTest, MultiplePaths) {
+  auto const loc = make_location(8.6500, 49.8700);
+  auto const far = std::vector<location>{make_location(8.6400, 49.8800),
+                                         make_location(8.6410, 49.8800)};
+  auto const near = std::vector<location>{make_location(8.6500, 49.8701),
+                                          make_location(8.6501, 49.8701)};
+  auto kernel = snapping_kernel{loc};
+  auto const far_idx = kernel.add_path(far);
+  auto const near_idx = kernel.add_path(near);
+  kernel.compute();
+
+  EXPECT_EQ(kernel.path_count(), 2U);
+  EXPECT_LT(kernel.nearest(near_idx).dist_sq_,
+            kernel.nearest(far_idx).dist_sq_);
+}
+
+TEST(SnappingTest, BatchMatchesSingleSegments) {
+  auto const loc = make_location(8.6500, 49.8700);
+  auto path = std::vector<location>{};
+  for (auto i = 0; i < 11; ++i) {
+    path.push_back(make_location(8.6450 + i * 0.0010,
+                                 49.8705 + (i % 2 == 0 ? 0.0 : 0.0010)));
+  }
+  auto kernel = snapping_kernel{loc};
+  kernel.add_path(path);
+  kernel.compute();
+  EXPECT_EQ(kernel.segment_count(), 10U);
+
+  auto best = segment_match{};
+  for (auto i = 0U; i < path.size() - 1; ++i) {
+    auto single = snapping_kernel{loc};
+    single.add_path(std::vector<location>{path[i], path[i + 1]});
+    single.compute();
+    auto const match = single.nearest(0);
+    if (match.dist_sq_ < best.dist_sq_) {
+      best = {i, match.t_, match.dist_sq_};
+    }
+  }
+
+  auto const match = kernel.nearest(0);
+  EXPECT_EQ(match.segment_, best.segment_);
+  EXPECT_FLOAT_EQ(static_cast<float>(match.t_), static_cast<float>(best.t_));
+  EXPECT_FLOAT_EQ(static_cast<float>(match.dist_sq_),
+                  static_cast<float>(best.dist_sq_));
+}
@@ -0,0 +1,125 @@
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ppr/common/snapping_cache.h"
+
+using namespace ppr;
+
+namespace {
+
+routing_graph_data random_graph_data(std::size_t const count) {
+  auto gen = std::mt19937{7};
+  auto lon = std::uniform_real_distribution<double>{8.60, 8.70};
+  auto lat = std::uniform_real_distribution<double>{49.85, 49.90};
+  auto ext = std::uniform_real_distribution<double>{0.0, 0.001};
+  auto edges = std::vector<std::pair<packed_rtree_box, rg_edge>>{};
+  auto areas = std::vector<std::pair<packed_rtree_box, std::uint32_t>>{};
+  for (auto i = 0U; i < count; ++i) {
+    auto const a = make_location(lon(gen), lat(gen));
+    auto const b = make_location(a.lon() + ext(gen), a.lat() + ext(gen));
+    auto const box = make_packed_rtree_box(std::vector{a, b});
+    edges.emplace_back(box, rg_edge{i, 0});
+    if (i % 10 == 0) {
+      areas.emplace_back(box, i);
+    }
+  }
+  auto rg = routing_graph_data{};
+  rg.edge_rtree_ = build_packed_rtree(edges);
+  rg.area_rtree_ = build_packed_rtree(areas);
+  return rg;
+}
+
+// all entries within max_dist meters of loc (bounding box distance)
+template <typename T, typename Fn>
+std::vector<std::uint32_t> within(packed_rtree<T> const& rtree,
+                                  location const& loc, double const max_dist,
+                                  Fn&& get_id) {
+  auto const scale_x = std::cos(to_rad(loc.lat()));
+  auto const max_dist_fixed = max_dist / snapping_cache::meters_per_unit();
+  auto ids = std::vector<std::uint32_t>{};
+  for (auto i = 0U; i < rtree.size(); ++i) {
+    if (box_dist_sq(loc, rtree.boxes_[i], scale_x) <=
+        max_dist_fixed * max_dist_fixed) {
+      ids.push_back(get_id(rtree.values_[i]));
+    }
+  }
+  std::sort(begin(ids), end(ids));
+  return ids;
+}
+
+template <typename T, typename Fn>
+std::vector<std::uint32_t> within(
+    std::vector<std::pair<packed_rtree_box, T>> const& entries,
+    location const& loc, double const max_dist, Fn&& get_id) {
+  auto const scale_x = std::cos(to_rad(loc.lat()));
+  auto const max_dist_fixed = max_dist / snapping_cache::meters_per_unit();
+  auto ids = std::vector<std::uint32_t>{};
+  for (auto const& [box, value] : entries) {
+    if (box_dist_sq(loc, box, scale_x) <= max_dist_fixed * max_dist_fixed) {
+      ids.push_back(get_id(value));
+    }
+  }
+  std::sort(begin(ids), end(ids));
+  return ids;
+}
+
+}  // namespace
+
+TEST(SnappingCacheTest, CellsContainAllNearbyEntries) {
+  auto const rg = random_graph_data(20000);
+  auto cache = snapping_cache{rg, snapping_cache_config{}};
+  auto const edge_id = [](rg_edge const& e) { return e.node_index_; };
+  auto const area_id = [](std::uint32_t const id) { return id; };
+
+  auto gen = std::mt19937{11};
+  auto lon = std::uniform_real_distribution<double>{8.60, 8.70};
+  auto lat = std::uniform_real_distribution<double>{49.85, 49.90};
+  for (auto i = 0U; i < 200; ++i) {
+    auto const loc = make_location(lon(gen), lat(gen));
+    auto const result = cache.get(loc);
+    ASSERT_NE(result.cell_, nullptr);
+    for (auto const max_dist : {50.0, 200.0, 280.0}) {
+      ASSERT_TRUE(cache.covers(max_dist));
+      EXPECT_EQ(within(rg.edge_rtree_, loc, max_dist, edge_id),
+                within(result.cell_->edges_, loc, max_dist, edge_id));
+      EXPECT_EQ(within(rg.area_rtree_, loc, max_dist, area_id),
+                within(result.cell_->areas_, loc, max_dist, area_id));
+    }
+  }
+  EXPECT_EQ(cache.hits() + cache.misses(), 200U);
+}
+
+TEST(SnappingCacheTest, RepeatedLookupsHit) {
+  auto const rg = random_graph_data(1000);
+  auto cache = snapping_cache{rg, snapping_cache_config{}};
+  auto const loc = make_location(8.65, 49.87);
+  EXPECT_FALSE(cache.get(loc).hit_);
+  EXPECT_TRUE(cache.get(loc).hit_);
+  EXPECT_TRUE(cache.get(make_location(8.6500001, 49.8700001)).hit_);
+  EXPECT_EQ(cache.hits(), 2U);
+  EXPECT_EQ(cache.misses(), 1U);
+  EXPECT_EQ(cache.cell_count(), 1U);
+}
+
+TEST(SnappingCacheTest, MemoryIsBounded) {
+  auto const rg = random_graph_data(20000);
+  auto config = snapping_cache_config{};
+  config.max_memory_ = 256 * 1024;
+  auto cache = snapping_cache{rg, config};
+
+  auto gen = std::mt19937{3};
+  auto lon = std::uniform_real_distribution<double>{8.60, 8.70};
+  auto lat = std::uniform_real_distribution<double>{49.85, 49.90};
+  for (auto i = 0U; i < 2000; ++i) {
+    auto const result = cache.get(make_location(lon(gen), lat(gen)));
+    EXPECT_NE(result.cell_, nullptr);
+    EXPECT_LE(cache.memory_size(), config.max_memory_);
+  }
+  EXPECT_FALSE(cache.covers(config.max_distance_ + 1));
+}
@@ -0,0 +1,172 @@
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ppr/common/location_geometry.h"
+#include "ppr/preprocessing/update/splice.h"
+
+using namespace ppr;
+using namespace ppr::preprocessing;
+
+namespace {
+
+constexpr auto const BOUNDARY_LON = 8.6;
+
+struct graph_builder {
+  graph_builder() {
+    // names[0] = empty string, edge_infos[0] = additional edges
+    g_.data_->names_.emplace_back(std::string_view{});
+    make_edge_info(g_.data_->edge_infos_, 0, edge_type::FOOTWAY,
+                   street_type::NONE, crossing_type::NONE);
+  }
+
+  node* add_node(std::int64_t const osm_id, double const lon) {
+    auto& rg = *g_.data_;
+    return rg.nodes_
+        .emplace_back(data::make_unique<node>(
+            make_node(++rg.max_node_id_, osm_id, make_location(lon, 49.87))))
+        .get();
+  }
+
+  // osm way id = 100 + osm id of from by default
+  void add_edge(node* from, node const* to, std::int64_t osm_way_id = 0) {
+    auto& rg = *g_.data_;
+    auto const [info, _] = make_edge_info(
+        rg.edge_infos_, osm_way_id != 0 ? osm_way_id : 100 + from->osm_id_,
+        edge_type::FOOTWAY, street_type::FOOTWAY, crossing_type::NONE);
+    from->out_edges_.emplace_back(data::make_unique<edge>(
+        make_edge(info, from, to, distance(from->location_, to->location_))));
+  }
+
+  routing_graph g_;
+};
+
+splice_input make_input(routing_graph const& g, bool const west) {
+  return splice_input{
+      .rg_ = g.data_.get(),
+      .take_node_ =
+          [=](node const& n) {
+            return (n.location_.lon() < BOUNDARY_LON) == west;
+          },
+      .take_area_ = [](area const&) { return false; }};
+}
+
+node const* find_node(routing_graph_data const& rg, std::int64_t const osm_id) {
+  for (auto const& n : rg.nodes_) {
+    if (n->osm_id_ == osm_id) {
+      return n.get();
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+// west: 1 <-> 2 -> (3), east: (2) <- 3 <-> 4, where (n) is the copy of a node
+// of the other graph
+TEST(SpliceTest, SharedBoundaryEdge) {
+  auto west = graph_builder{};
+  auto* w1 = west.add_node(1, 8.598);
+  auto* w2 = west.add_node(2, 8.599);
+  auto* w3 = west.add_node(3, 8.601);
+  west.add_edge(w1, w2);
+  west.add_edge(w2, w1);
+  west.add_edge(w2, w3);
+
+  auto east = graph_builder{};
+  auto* e2 = east.add_node(2, 8.599);
+  auto* e3 = east.add_node(3, 8.601);
+  auto* e4 = east.add_node(4, 8.602);
+  east.add_edge(e3, e2);
+  east.add_edge(e3, e4);
+  east.add_edge(e4, e3);
+
+  // the edge to the east graph is added before the east graph
+  auto inputs = std::vector<splice_input>{make_input(west.g_, true),
+                                          make_input(east.g_, false)};
+  auto const result = splice_routing_graphs(inputs);
+  auto const& rg = *result.rg_.data_;
+
+  EXPECT_EQ(0, result.n_unmatched_edges_);
+  EXPECT_EQ(0, result.n_ambiguous_nodes_);
+  EXPECT_EQ(2, inputs[0].n_nodes_);
+  EXPECT_EQ(2, inputs[1].n_nodes_);
+  ASSERT_EQ(4, rg.nodes_.size());
+
+  auto const* n2 = find_node(rg, 2);
+  auto const* n3 = find_node(rg, 3);
+  ASSERT_NE(nullptr, n2);
+  ASSERT_NE(nullptr, n3);
+  ASSERT_EQ(2, n2->out_edges_.size());
+  ASSERT_EQ(2, n3->out_edges_.size());
+  EXPECT_EQ(n3, n2->out_edges_[1]->to_);
+  EXPECT_EQ(n2, n3->out_edges_[0]->to_);
+  EXPECT_EQ(103, n3->out_edges_[0]->info(rg)->osm_way_id_);
+}
+
+// edges to nodes that are missing or exist twice in the output are dropped
+TEST(SpliceTest, UnmatchedAndAmbiguousNodes) {
+  auto west = graph_builder{};
+  auto* w1 = west.add_node(1, 8.598);
+  auto* w3 = west.add_node(3, 8.601);
+  auto* w5 = west.add_node(5, 8.605);
+  west.add_edge(w1, w3);
+  west.add_edge(w1, w5);
+
+  auto east = graph_builder{};
+  east.add_node(3, 8.601);
+  auto east_copy = graph_builder{};
+  east_copy.add_node(3, 8.601);
+
+  auto inputs = std::vector<splice_input>{make_input(west.g_, true),
+                                          make_input(east.g_, false),
+                                          make_input(east_copy.g_, false)};
+  auto const result = splice_routing_graphs(inputs);
+  auto const& rg = *result.rg_.data_;
+
+  EXPECT_EQ(2, result.n_unmatched_edges_);
+  EXPECT_EQ(1, result.n_ambiguous_nodes_);
+  ASSERT_EQ(3, rg.nodes_.size());
+  EXPECT_TRUE(find_node(rg, 1)->out_edges_.empty());
+}
+
+// an entrance (osm node 50) east of the boundary has one foot node per
+// footway, all with the same location and osm id: west 1 -> (50) is way 201,
+// east (2) <- 50 is way 202, the foot nodes are connected by way -50
+TEST(SpliceTest, FootNodesAtSpecialNode) {
+  auto const make_graph = []() {
+    auto b = graph_builder{};
+    auto* n1 = b.add_node(1, 8.598);
+    auto* n2 = b.add_node(2, 8.599);
+    auto* foot1 = b.add_node(50, 8.601);
+    auto* foot2 = b.add_node(50, 8.601);
+    b.add_edge(n1, foot1, 201);
+    b.add_edge(foot2, n2, 202);
+    b.add_edge(foot1, foot2, -50);
+    b.g_.create_in_edges();
+    return b;
+  };
+  auto const west = make_graph();
+  auto const east = make_graph();
+
+  auto inputs = std::vector<splice_input>{make_input(west.g_, true),
+                                          make_input(east.g_, false)};
+  auto const result = splice_routing_graphs(inputs);
+  auto const& rg = *result.rg_.data_;
+
+  EXPECT_EQ(0, result.n_unmatched_edges_);
+  EXPECT_EQ(0, result.n_ambiguous_nodes_);
+  ASSERT_EQ(4, rg.nodes_.size());
+
+  auto const* n1 = find_node(rg, 1);
+  ASSERT_EQ(1, n1->out_edges_.size());
+  node const* foot1 = n1->out_edges_[0]->to_;
+  ASSERT_EQ(1, foot1->out_edges_.size());
+  node const* foot2 = foot1->out_edges_[0]->to_;
+  EXPECT_NE(foot1, foot2);
+  ASSERT_EQ(1, foot2->out_edges_.size());
+  EXPECT_EQ(find_node(rg, 2), foot2->out_edges_[0]->to_);
+  EXPECT_EQ(202, foot2->out_edges_[0]->info(rg)->osm_way_id_);
+}
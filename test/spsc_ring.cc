@@ -0,0 +1,53 @@
+#include <cstddef>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "ppr/backend/spsc_ring.h"
+
+using namespace ppr::backend;
+
+TEST(SpscRingTest, BoundedFifo) {
+  auto ring = spsc_ring<int>{3};
+  EXPECT_EQ(4, ring.capacity());
+  EXPECT_FALSE(ring.pop().has_value());
+
+  for (auto i = 0; i < 4; ++i) {
+    EXPECT_TRUE(ring.push(int{i}));
+  }
+  EXPECT_FALSE(ring.push(4));
+
+  EXPECT_EQ(0, ring.pop());
+  EXPECT_TRUE(ring.push(4));
+  for (auto i = 1; i < 5; ++i) {
+    EXPECT_EQ(i, ring.pop());
+  }
+  EXPECT_FALSE(ring.pop().has_value());
+}
+
+TEST(SpscRingTest, ProducerConsumerThreads) {
+  constexpr auto const COUNT = std::size_t{10'000};
+  auto ring = spsc_ring<std::size_t>{64};
+
+  auto producer = std::thread{[&]() {
+    for (auto i = std::size_t{0}; i < COUNT;) {
+      if (ring.push(std::size_t{i})) {
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }};
+
+  auto expected = std::size_t{0};
+  while (expected < COUNT) {
+    if (auto const val = ring.pop(); val.has_value()) {
+      EXPECT_EQ(expected, *val);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_FALSE(ring.pop().has_value());
+}
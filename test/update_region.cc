@@ -0,0 +1,46 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "ppr/preprocessing/update/update_region.h"
+
+using namespace ppr;
+using namespace ppr::preprocessing;
+
+TEST(UpdateRegionTest, CoreAndHalo) {
+  auto region = update_region{};
+  EXPECT_TRUE(region.empty());
+
+  region.add(make_location(8.6512, 49.8728));
+  region.expand(1500);
+
+  EXPECT_FALSE(region.empty());
+  EXPECT_EQ(1, region.core_size());
+  EXPECT_TRUE(region.in_core(make_location(8.6599, 49.8701)));
+  EXPECT_FALSE(region.in_core(make_location(8.6601, 49.8701)));
+
+  // one tile is ~1.1 km high and ~0.7 km wide at this latitude
+  EXPECT_TRUE(region.in_region(make_location(8.6750, 49.8850)));
+  EXPECT_FALSE(region.in_region(make_location(8.7100, 49.8701)));
+  EXPECT_FALSE(region.in_region(make_location(8.6550, 49.9200)));
+}
+
+TEST(UpdateRegionTest, BoxIntersection) {
+  auto region = update_region{};
+  region.add(make_packed_rtree_box(std::vector<location>{
+      make_location(-0.015, -0.005), make_location(-0.005, 0.005)}));
+  region.expand(0);
+
+  // negative coordinates are floored to the tile below
+  EXPECT_EQ(4, region.core_size());
+  EXPECT_TRUE(region.in_core(make_location(-0.0199, -0.0099)));
+  EXPECT_FALSE(region.in_core(make_location(-0.0201, 0.0)));
+
+  EXPECT_TRUE(region.intersects_core(make_packed_rtree_box(
+      std::vector<location>{make_location(-0.5, -0.5),
+                            make_location(0.5, 0.5)})));
+  EXPECT_FALSE(region.intersects_core(make_packed_rtree_box(
+      std::vector<location>{make_location(0.011, 0.0),
+                            make_location(0.5, 0.5)})));
+  EXPECT_FALSE(region.intersects_core(packed_rtree_box{}));
+}